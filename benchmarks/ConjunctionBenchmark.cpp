@@ -0,0 +1,111 @@
+// Conjunction screening of one hour at 10 s steps for fleets of 1k to 100k
+// satellites on 1 thread up to all cores, against the all-pairs check of
+// every step for the smallest fleet.
+
+#include "ConjunctionScreening.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const int kFleetSizes[] = {1000, 10000, 100000};
+const double kDuration = 3600.0;
+const double kStep = 10.0;
+const double kThreshold = 5.0;
+
+// Same spread of orbits as PropagationBenchmark.
+OrbitalElements createFleet(int satellite_count) {
+    std::mt19937 random(42);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    OrbitalElements elements;
+    for (int i = 0; i < satellite_count; ++i) {
+        double perigee = 200.0 + 2000.0 * unit(random);
+        double apogee = perigee + 30000.0 * unit(random) * unit(random);
+        double a = OrbitPropagator::kEarthRadius + 0.5 * (apogee + perigee);
+        elements.push_back(apogee, perigee, (apogee - perigee) / (2.0 * a), 180.0 * unit(random),
+                           360.0 * unit(random), 360.0 * unit(random));
+    }
+    return elements;
+}
+
+template<typename Function>
+double seconds(Function&& function) {
+    auto start = std::chrono::steady_clock::now();
+    function();
+    auto finish = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(finish - start).count();
+}
+
+// Every pair at every sample, the check the grid replaces.
+int countAllPairs(const OrbitalElements& elements) {
+    std::vector<double> times;
+    for (double t = 0.0; t <= kDuration; t += kStep) {
+        times.push_back(t);
+    }
+    PositionGrid grid;
+    OrbitPropagator(elements).Propagate(times, grid);
+
+    const size_t count = elements.size();
+    int close = 0;
+    for (size_t epoch = 0; epoch < times.size(); ++epoch) {
+        const double* x = grid.x.data() + epoch * count;
+        const double* y = grid.y.data() + epoch * count;
+        const double* z = grid.z.data() + epoch * count;
+        for (size_t i = 0; i < count; ++i) {
+            for (size_t j = i + 1; j < count; ++j) {
+                const double dx = x[j] - x[i];
+                const double dy = y[j] - y[i];
+                const double dz = z[j] - z[i];
+                close += dx * dx + dy * dy + dz * dz < kThreshold * kThreshold;
+            }
+        }
+    }
+    return close;
+}
+
+}  // namespace
+
+int main() {
+    const int cores = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<int> thread_counts;
+    for (int threads = 1; threads < cores; threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(cores);
+
+    std::printf("window: %.0f s, step: %.0f s, threshold: %.0f km\n", kDuration, kStep, kThreshold);
+
+    const OrbitalElements smallest = createFleet(kFleetSizes[0]);
+    int close = 0;
+    const double all_pairs_s = seconds([&]() { close = countAllPairs(smallest); });
+    std::printf("%6d satellites, all pairs:     %8.3f s (%d close samples)\n", kFleetSizes[0], all_pairs_s, close);
+
+    for (int satellite_count : kFleetSizes) {
+        const OrbitalElements elements = createFleet(satellite_count);
+        double single_s = 0.0;
+        for (int threads : thread_counts) {
+            ScreeningOptions options;
+            options.threshold = kThreshold;
+            options.duration = kDuration;
+            options.step = kStep;
+            options.thread_count = threads;
+
+            std::vector<CloseApproach> approaches;
+            const double s = seconds([&]() { approaches = screenConjunctions(elements, options); });
+            if (threads == 1) {
+                single_s = s;
+            }
+            std::printf("%6d satellites, %2d threads: %8.3f s (%.2fx), %zu approaches\n", satellite_count, threads, s,
+                        single_s / s, approaches.size());
+        }
+    }
+
+    return 0;
+}
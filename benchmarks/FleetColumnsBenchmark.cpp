@@ -0,0 +1,156 @@
+// Export and import of 1M satellites as chunked columns, on one thread and on
+// one per core, against writing the same number of bytes straight to the same
+// directory, which bounds the export. Pass a directory to measure a given
+// disk (default: a temporary directory).
+
+#include "DefaultParameters.h"
+#include "FleetColumns.h"
+
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <thread>
+
+namespace {
+
+const int kSatellites = 1000000;
+const int kRepeats = 3;
+const int kWriteSize = 8 * 1024 * 1024;
+
+template<typename Function>
+double bestOfMs(Function&& function) {
+    double best = 1e300;
+    for (int i = 0; i < kRepeats; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        auto finish = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(finish - start).count());
+    }
+    return best;
+}
+
+// Unique names, a few country codes and models, the default description,
+// and random orbits.
+void fill(Fleet& fleet) {
+    const ParameterStore& schema = fleet.GetSchema();
+    const QString countries[] = {"RU", "US", "CN", "FR", "JP", "IN", "GB", "DE"};
+    const QString models[] = {"Model A", "Model B", "Model C", "Model D"};
+    std::mt19937 random(42);
+    std::uniform_real_distribution<double> angle(0.0, 360.0);
+    std::uniform_real_distribution<double> height(600.0, 1200.0);
+
+    fleet.Resize(kSatellites);
+    std::vector<QString>& names = fleet.GetTexts(schema.Find("satelliteName"));
+    std::vector<QString>& codes = fleet.GetTexts(schema.Find("countryCode"));
+    std::vector<QString>& model_names = fleet.GetTexts(schema.Find("satelliteModel"));
+    std::vector<int>& norad_ids = fleet.GetInts(schema.Find("noradId"));
+    std::vector<char>& statuses = fleet.GetBools(schema.Find("status"));
+    for (int i = 0; i < kSatellites; ++i) {
+        names[i] = QString("Sat%1").arg(i);
+        codes[i] = countries[i % 8];
+        model_names[i] = models[(i / 1000) % 4];
+        norad_ids[i] = 10000 + i % 90000;
+        statuses[i] = i % 3 != 0;
+    }
+    for (const char* name : {"altitude", "apogee", "perigee"}) {
+        for (double& value : fleet.GetDoubles(schema.Find(name))) {
+            value = height(random);
+        }
+    }
+    for (const char* name : {"inclination", "argPerigee", "meanAnomaly"}) {
+        for (double& value : fleet.GetDoubles(schema.Find(name))) {
+            value = angle(random);
+        }
+    }
+}
+
+bool sameFleets(const Fleet& a, const Fleet& b) {
+    if (a.GetSatelliteCount() != b.GetSatelliteCount()) {
+        return false;
+    }
+    for (int column = 0; column < a.GetParameterCount(); ++column) {
+        for (int satellite = 0; satellite < a.GetSatelliteCount(); ++satellite) {
+            if (a.GetValue(satellite, column) != b.GetValue(satellite, column)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Writes size bytes the way the exporter does: large writes, then commit.
+bool writeRaw(const QString& file_name, qint64 size) {
+    const QByteArray block(kWriteSize, 'x');
+    QSaveFile file(file_name);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    for (qint64 written = 0; written < size; written += block.size()) {
+        const int count = static_cast<int>(std::min<qint64>(block.size(), size - written));
+        if (file.write(block.constData(), count) != count) {
+            return false;
+        }
+    }
+    return file.commit();
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    QTemporaryDir temporary;
+    const QString directory = argc > 1 ? QString::fromLocal8Bit(argv[1]) : temporary.path();
+    const QString columns_file = directory + "/FleetColumnsBenchmark.columns";
+    const QString raw_file = directory + "/FleetColumnsBenchmark.raw";
+
+    Fleet fleet(createDefaultParameters());
+    fill(fleet);
+
+    QString message;
+    const int cores = std::max(1u, std::thread::hardware_concurrency());
+    std::printf("%d satellites, %d parameters, chunks of %d\n", kSatellites, fleet.GetParameterCount(),
+                FleetColumnWriter::kChunkRows);
+    for (int threads : {1, cores}) {
+        bool ok = true;
+        const double ms = bestOfMs([&]() {
+            ok = ok && exportFleetColumns(fleet, columns_file, &message, threads);
+        });
+        if (!ok) {
+            std::printf("Export failed: %s\n", qPrintable(message));
+            return 1;
+        }
+        const double megabytes = QFileInfo(columns_file).size() / 1e6;
+        std::printf("  export, %2d threads:  %8.1f ms, %7.1f MB, %7.0f MB/s\n", threads, ms, megabytes,
+                    megabytes * 1000.0 / ms);
+    }
+
+    const qint64 size = QFileInfo(columns_file).size();
+    bool raw_ok = true;
+    const double raw_ms = bestOfMs([&]() {
+        raw_ok = raw_ok && writeRaw(raw_file, size);
+    });
+    QFile::remove(raw_file);
+    if (!raw_ok) {
+        std::printf("Could not write %s\n", qPrintable(raw_file));
+        return 1;
+    }
+    std::printf("  raw write:           %8.1f ms, %7.1f MB, %7.0f MB/s\n", raw_ms, size / 1e6,
+                size / 1e3 / raw_ms);
+
+    Fleet imported(createDefaultParameters());
+    bool import_ok = true;
+    const double import_ms = bestOfMs([&]() {
+        import_ok = import_ok && importFleetColumns(columns_file, imported, &message);
+    });
+    if (!import_ok) {
+        std::printf("Import failed: %s\n", qPrintable(message));
+        return 1;
+    }
+    std::printf("  import:              %8.1f ms, %7.0f MB/s, %s\n", import_ms, size / 1e3 / import_ms,
+                sameFleets(fleet, imported) ? "same fleet" : "DIFFERENT FLEET");
+    QFile::remove(columns_file);
+    return 0;
+}
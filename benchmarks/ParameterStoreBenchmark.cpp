@@ -0,0 +1,114 @@
+// Scan/diff cost of the old std::vector<Parameter*> layout against the
+// column-per-kind ParameterStore at 1M parameters.
+
+#include "ParameterStore.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+const int kParameterCount = 1000000;
+const int kChangedEvery = 100;
+const int kRepeats = 20;
+
+template<typename Function>
+double bestOfMs(Function&& function) {
+    double best = 1e300;
+    for (int i = 0; i < kRepeats; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        auto finish = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(finish - start).count());
+    }
+    return best;
+}
+
+// The dispatch MainWindow::saveConfig() used before ParameterStore.
+int countChangedLegacy(const std::vector<Parameter*>& parameters) {
+    int count = 0;
+    for (auto& parameter : parameters) {
+        switch (parameter->GetType()) {
+            case TYPE_PARAMETER::LineEdit:
+                count += dynamic_cast<LineEditParameter*>(parameter)->isChanged();
+                break;
+            case TYPE_PARAMETER::CheckBox:
+                count += dynamic_cast<CheckBoxParameter*>(parameter)->isChanged();
+                break;
+            case TYPE_PARAMETER::SpinBox:
+                count += dynamic_cast<SpinBoxParameter<int>*>(parameter)->isChanged();
+                break;
+            case TYPE_PARAMETER::DoubleSpinBox:
+                count += dynamic_cast<SpinBoxParameter<double>*>(parameter)->isChanged();
+                break;
+        }
+    }
+    return count;
+}
+
+}  // namespace
+
+int main() {
+    std::vector<Parameter*> legacy;
+    legacy.reserve(kParameterCount);
+    ParameterStore store;
+
+    // Same mix as a satellite: 4 text, 1 int, 7 double and 1 bool per 13.
+    for (int i = 0; i < kParameterCount; ++i) {
+        QString name = QString("p%1").arg(i);
+        bool changed = i % kChangedEvery == 0;
+        int kind = i % 13;
+
+        if (kind < 4) {
+            LineEditParameter parameter(name, "", "value", "Label:");
+            legacy.push_back(new LineEditParameter(parameter));
+            int slot = store.Add(parameter);
+            if (changed) {
+                static_cast<LineEditParameter*>(legacy.back())->SetModifiedValue("changed");
+                store.SetModifiedValue(slot, "changed");
+            }
+        } else if (kind < 5) {
+            SpinBoxParameter<int> parameter(TYPE_PARAMETER::SpinBox, name, "Label:", 0, 100000, 10, 1);
+            legacy.push_back(new SpinBoxParameter<int>(parameter));
+            int slot = store.Add(parameter);
+            if (changed) {
+                static_cast<SpinBoxParameter<int>*>(legacy.back())->SetModifiedValue(11);
+                store.SetModifiedValue(slot, 11);
+            }
+        } else if (kind < 12) {
+            SpinBoxParameter<double> parameter(TYPE_PARAMETER::DoubleSpinBox, name, "Label:", 0.0, 1e9, 1.5, 0.01);
+            legacy.push_back(new SpinBoxParameter<double>(parameter));
+            int slot = store.Add(parameter);
+            if (changed) {
+                static_cast<SpinBoxParameter<double>*>(legacy.back())->SetModifiedValue(2.5);
+                store.SetModifiedValue(slot, 2.5);
+            }
+        } else {
+            CheckBoxParameter parameter(name, "Label:", false);
+            legacy.push_back(new CheckBoxParameter(parameter));
+            int slot = store.Add(parameter);
+            if (changed) {
+                static_cast<CheckBoxParameter*>(legacy.back())->SetModifiedValue(true);
+                store.SetModifiedValue(slot, true);
+            }
+        }
+    }
+
+    int legacy_count = 0;
+    int store_count = 0;
+    double legacy_ms = bestOfMs([&]() { legacy_count = countChangedLegacy(legacy); });
+    double store_ms = bestOfMs([&]() { store_count = store.CountChanged(); });
+
+    std::printf("parameters: %d, changed: %d/%d\n", kParameterCount, legacy_count, store_count);
+    std::printf("vector<Parameter*> + dynamic_cast: %.3f ms\n", legacy_ms);
+    std::printf("ParameterStore columns:            %.3f ms\n", store_ms);
+    std::printf("speedup: %.1fx\n", legacy_ms / store_ms);
+
+    for (auto& parameter : legacy) {
+        delete parameter;
+    }
+
+    return legacy_count == store_count ? 0 : 1;
+}
@@ -0,0 +1,115 @@
+// Throughput of OrbitPropagator in satellite-epochs per second against a
+// scalar std::sin/std::cos Kepler solver, on one thread and on all cores.
+
+#include "OrbitPropagator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const int kSatelliteCount = 100000;
+const int kEpochCount = 100;
+const double kStepSeconds = 60.0;
+const int kRepeats = 5;
+
+template<typename Function>
+double bestOfSeconds(Function&& function) {
+    double best = 1e300;
+    for (int i = 0; i < kRepeats; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        auto finish = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(finish - start).count());
+    }
+    return best;
+}
+
+// One satellite at a time, Newton iterations until convergence.
+void propagateScalar(const OrbitalElements& elements, const std::vector<double>& times, PositionGrid& grid) {
+    const double kPi = 3.14159265358979323846;
+    const double kDegToRad = kPi / 180.0;
+    const size_t count = elements.size();
+
+    grid.x.resize(count * times.size());
+    grid.y.resize(count * times.size());
+    grid.z.resize(count * times.size());
+
+    for (size_t i = 0; i < count; ++i) {
+        const double a = OrbitPropagator::kEarthRadius + 0.5 * (elements.apogees[i] + elements.perigees[i]);
+        const double e = elements.eccentricities[i];
+        const double n = std::sqrt(OrbitPropagator::kEarthMu / (a * a * a));
+        const double w = elements.arg_perigees[i] * kDegToRad;
+        const double inclination = elements.inclinations[i] * kDegToRad;
+
+        for (size_t epoch = 0; epoch < times.size(); ++epoch) {
+            const double m = std::fmod(elements.mean_anomalies[i] * kDegToRad + n * times[epoch], 2.0 * kPi);
+            double anomaly = m;
+            for (int k = 0; k < 50; ++k) {
+                double step = (anomaly - e * std::sin(anomaly) - m) / (1.0 - e * std::cos(anomaly));
+                anomaly -= step;
+                if (std::abs(step) < 1e-12) {
+                    break;
+                }
+            }
+
+            const double px = a * (std::cos(anomaly) - e);
+            const double py = a * std::sqrt(1.0 - e * e) * std::sin(anomaly);
+            const double in_plane = std::sin(w) * px + std::cos(w) * py;
+            const size_t j = epoch * count + i;
+            grid.x[j] = std::cos(w) * px - std::sin(w) * py;
+            grid.y[j] = std::cos(inclination) * in_plane;
+            grid.z[j] = std::sin(inclination) * in_plane;
+        }
+    }
+}
+
+}  // namespace
+
+int main() {
+    std::mt19937 random(42);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    OrbitalElements elements;
+    for (int i = 0; i < kSatelliteCount; ++i) {
+        double perigee = 200.0 + 2000.0 * unit(random);
+        double apogee = perigee + 30000.0 * unit(random) * unit(random);
+        double a = OrbitPropagator::kEarthRadius + 0.5 * (apogee + perigee);
+        elements.push_back(apogee, perigee, (apogee - perigee) / (2.0 * a), 180.0 * unit(random),
+                           360.0 * unit(random), 360.0 * unit(random));
+    }
+
+    std::vector<double> times;
+    for (int i = 0; i < kEpochCount; ++i) {
+        times.push_back(i * kStepSeconds);
+    }
+
+    OrbitPropagator propagator(elements);
+    PositionGrid scalar;
+    PositionGrid single;
+    PositionGrid parallel;
+    const int threads = std::max(1u, std::thread::hardware_concurrency());
+
+    double scalar_s = bestOfSeconds([&]() { propagateScalar(elements, times, scalar); });
+    double single_s = bestOfSeconds([&]() { propagator.Propagate(times, single, 1); });
+    double parallel_s = bestOfSeconds([&]() { propagator.Propagate(times, parallel, threads); });
+
+    double worst = 0.0;
+    for (size_t i = 0; i < scalar.x.size(); ++i) {
+        worst = std::max(worst, std::abs(scalar.x[i] - parallel.x[i]) + std::abs(scalar.y[i] - parallel.y[i]) +
+                                std::abs(scalar.z[i] - parallel.z[i]));
+    }
+
+    const double epochs = static_cast<double>(kSatelliteCount) * kEpochCount;
+    std::printf("satellites: %d, epochs: %d, worst deviation: %.3g km\n", kSatelliteCount, kEpochCount, worst);
+    std::printf("scalar std::sin solver:       %.3g satellite-epochs/s\n", epochs / scalar_s);
+    std::printf("OrbitPropagator, 1 thread:    %.3g satellite-epochs/s\n", epochs / single_s);
+    std::printf("OrbitPropagator, %2d threads:  %.3g satellite-epochs/s\n", threads, epochs / parallel_s);
+
+    return worst < 1e-3 ? 0 : 1;
+}
@@ -0,0 +1,367 @@
+// Load, save, queries and window creation at scale: synthetic configs of 10 to 1M
+// parameters and fleets of 1 to 100k satellites. Results are printed by
+// Qt Test, so any of its output formats can be tracked between releases:
+//
+//     ./benchmarks/ScaleBenchmark -o scale.xml,xml
+//     ./benchmarks/ScaleBenchmark -csv
+
+#include "Application.h"
+#include "ConfigDocument.h"
+#include "ConfigJournal.h"
+#include "DefaultParameters.h"
+#include "Fleet.h"
+#include "FleetIndex.h"
+#include "FleetWindow.h"
+
+#include <QApplication>
+#include <QHash>
+#include <QTemporaryDir>
+#include <QtTest>
+
+namespace {
+
+const int kSectionSize = 1000;
+const int kChangedEvery = 100;
+// Every input of an eager window is a real widget; past this the window
+// does not fit in memory.
+const int kMaxEagerWidgets = 10000;
+
+const char* const kFormatNames[] = {"json", "cbor"};
+
+// Same mix as a satellite: 4 text, 1 int, 7 double and 1 bool per 13.
+ParameterStore createSchema(int count) {
+    ParameterStore schema;
+    for (int i = 0; i < count; ++i) {
+        if (i % kSectionSize == 0) {
+            schema.BeginSection(QString("Section %1").arg(i / kSectionSize + 1));
+        }
+
+        QString name = QString("p%1").arg(i);
+        QString label = QString("Parameter %1:").arg(i);
+        switch (i % 13) {
+            case 0:
+            case 1:
+            case 2:
+            case 3:
+                schema.AddLineEdit(name, "Write a value...", "text", label);
+                break;
+            case 4:
+                schema.AddSpinBox(name, label, 0, 1000000, i, 1);
+                break;
+            case 12:
+                schema.AddCheckBox(name, label, i % 2 == 0);
+                break;
+            default:
+                schema.AddSpinBox(name, label, 0.0, 1e9, i * 0.5, 0.01);
+                break;
+        }
+    }
+    return schema;
+}
+
+// Spreads the indexed columns over realistic ranges, deterministically.
+void fillFleet(Fleet& fleet, int satellite_count) {
+    const char* const kCountries[] = {"US", "RU", "CN", "FR", "JP", "IN", "GB", "DE"};
+    const ParameterStore& schema = fleet.GetSchema();
+    fleet.Resize(satellite_count);
+    for (int i = 0; i < satellite_count; ++i) {
+        const int hash = (i * 7919) % 10007;
+        fleet.SetValue(i, schema.Find("noradId"), 10000 + i % 90000);
+        fleet.SetValue(i, schema.Find("altitude"), 300.0 + hash * 0.17);
+        fleet.SetValue(i, schema.Find("inclination"), hash % 18000 * 0.01);
+        fleet.SetValue(i, schema.Find("eccentricity"), hash * 1e-5);
+        fleet.SetValue(i, schema.Find("status"), hash % 3 != 0);
+        fleet.SetValue(i, schema.Find("countryCode"), kCountries[hash % 8]);
+    }
+}
+
+void modifyValue(LineEditColumn& column, int index, int round) {
+    column.SetModifiedValue(index, QString("text %1").arg(round));
+}
+
+void modifyValue(CheckBoxColumn& column, int index, int round) {
+    column.SetModifiedValue(index, round % 2 == 0);
+}
+
+void modifyValue(IntSpinBoxColumn& column, int index, int round) {
+    column.SetModifiedValue(index, round);
+}
+
+void modifyValue(DoubleSpinBoxColumn& column, int index, int round) {
+    column.SetModifiedValue(index, round * 0.25);
+}
+
+// Changes every kChangedEvery-th parameter to a value that depends on the
+// round, so each round has changes to report.
+void modifyParameters(ParameterStore& parameters, int round) {
+    for (int slot = 0; slot < parameters.size(); slot += kChangedEvery) {
+        parameters.Visit(slot, [&](auto& column, int index) {
+            modifyValue(column, index, round);
+        });
+    }
+}
+
+void addCountRows(const std::vector<int>& counts) {
+    for (int count : counts) {
+        QTest::newRow(qPrintable(QString::number(count))) << count;
+    }
+}
+
+}  // namespace
+
+class ScaleBenchmark : public QObject {
+    Q_OBJECT
+
+    QTemporaryDir directory_;
+    QHash<QString, QString> files_;
+
+    // Writes the default values of a synthetic schema once per size and format.
+    QString configFile(int count, const QString& format) {
+        const QString key = QString("config-%1.%2").arg(count).arg(format);
+        if (!files_.contains(key)) {
+            ConfigDocument document(directory_.filePath(key), createSchema(count));
+            QString message;
+            if (!document.Save(&message)) {
+                qWarning("Could not write %s: %s", qPrintable(key), qPrintable(message));
+            }
+            files_.insert(key, document.GetFileName());
+        }
+        return files_.value(key);
+    }
+
+    QString fleetFile(int satellite_count) {
+        const QString key = QString("fleet-%1.json").arg(satellite_count);
+        if (!files_.contains(key)) {
+            Fleet fleet(createDefaultParameters());
+            fleet.Resize(satellite_count);
+            if (!fleet.Save(directory_.filePath(key))) {
+                qWarning("Could not write %s", qPrintable(key));
+            }
+            files_.insert(key, directory_.filePath(key));
+        }
+        return files_.value(key);
+    }
+
+    static void addConfigRows() {
+        QTest::addColumn<int>("count");
+        QTest::addColumn<QString>("format");
+        for (int count : {10, 1000, 100000, 1000000}) {
+            for (const char* format : kFormatNames) {
+                QTest::newRow(qPrintable(QString("%1 %2").arg(format).arg(count))) << count << QString(format);
+            }
+        }
+    }
+
+private slots:
+    void setDefaultValues_data() {
+        QTest::addColumn<int>("count");
+        addCountRows({10, 1000, 100000, 1000000});
+    }
+
+    void setDefaultValues() {
+        QFETCH(int, count);
+        ConfigDocument document(directory_.filePath("defaults.json"), createSchema(count));
+
+        QBENCHMARK {
+            document.SetDefaultValues();
+        }
+    }
+
+    void loadConfig_data() {
+        addConfigRows();
+    }
+
+    void loadConfig() {
+        QFETCH(int, count);
+        QFETCH(QString, format);
+        ConfigDocument document(configFile(count, format), createSchema(count));
+
+        QBENCHMARK {
+            ConfigError error;
+            QVERIFY(document.Load(&error));
+        }
+    }
+
+    // The change report built by the Save button, for 1% changed parameters.
+    void saveConfigReport_data() {
+        QTest::addColumn<int>("count");
+        addCountRows({10, 1000, 100000, 1000000});
+    }
+
+    void saveConfigReport() {
+        QFETCH(int, count);
+        ConfigDocument document(directory_.filePath("report.json"), createSchema(count));
+
+        int round = 0;
+        QBENCHMARK {
+            modifyParameters(document.GetParameters(), ++round);
+            std::string report;
+            document.CommitChanges(&report);
+        }
+    }
+
+    // What ConfigSaver writes for 1% changed parameters: one journal record.
+    // The journal is removed in every round so it does not grow.
+    void saveConfigJournal_data() {
+        QTest::addColumn<int>("count");
+        addCountRows({10, 1000, 100000, 1000000});
+    }
+
+    void saveConfigJournal() {
+        QFETCH(int, count);
+        ConfigDocument document(directory_.filePath("journal.json"), createSchema(count));
+        modifyParameters(document.GetParameters(), 1);
+        ConfigSnapshot changes = document.CommitChanges();
+        ConfigJournal journal(ConfigJournal::journalFileFor(document.GetFileName()));
+
+        QBENCHMARK {
+            QVERIFY(journal.Append(changes));
+            journal.Clear();
+        }
+    }
+
+    // Full rewrite of the config, as when the journal is compacted.
+    void saveConfigFile_data() {
+        addConfigRows();
+    }
+
+    void saveConfigFile() {
+        QFETCH(int, count);
+        QFETCH(QString, format);
+        ConfigDocument document(directory_.filePath(QString("write.%1").arg(format)), createSchema(count));
+
+        QBENCHMARK {
+            QString message;
+            QVERIFY2(document.Save(&message), qPrintable(message));
+        }
+    }
+
+    // Opening the window: skeleton, background load and the inputs of the
+    // first page (lazy) or of every page (eager).
+    void createWidgets_data() {
+        QTest::addColumn<int>("count");
+        QTest::addColumn<bool>("lazy");
+        for (int count : {10, 1000, 100000, 1000000}) {
+            QTest::newRow(qPrintable(QString("lazy %1").arg(count))) << count << true;
+            if (count <= kMaxEagerWidgets) {
+                QTest::newRow(qPrintable(QString("eager %1").arg(count))) << count << false;
+            }
+        }
+    }
+
+    void createWidgets() {
+        QFETCH(int, count);
+        QFETCH(bool, lazy);
+        const QString file = configFile(count, "json");
+        ParameterStore schema = createSchema(count);
+
+        QBENCHMARK {
+            MainWindow window(nullptr, file, schema, CONFIG_FORMAT::Auto, lazy);
+            // Waits for the load and creates the inputs.
+            window.getValue("p0");
+        }
+    }
+
+    void loadFleet_data() {
+        QTest::addColumn<int>("count");
+        addCountRows({1, 100, 10000, 100000});
+    }
+
+    void loadFleet() {
+        QFETCH(int, count);
+        const QString file = fleetFile(count);
+
+        QBENCHMARK {
+            Fleet fleet(createDefaultParameters());
+            QVERIFY(fleet.Load(file));
+        }
+    }
+
+    void saveFleet_data() {
+        QTest::addColumn<int>("count");
+        addCountRows({1, 100, 10000, 100000});
+    }
+
+    void saveFleet() {
+        QFETCH(int, count);
+        Fleet fleet(createDefaultParameters());
+        fleet.Resize(count);
+        const QString file = directory_.filePath("fleet-write.json");
+
+        QBENCHMARK {
+            QVERIFY(fleet.Save(file));
+        }
+    }
+
+    void queryFleet_data() {
+        QTest::addColumn<int>("count");
+        addCountRows({100, 10000, 100000});
+    }
+
+    // The example of the filter bar on indexed columns.
+    void queryFleet() {
+        QFETCH(int, count);
+        Fleet fleet(createDefaultParameters());
+        fillFleet(fleet, count);
+        FleetIndex index(&fleet, defaultIndexedColumns());
+        FleetQuery query;
+        QVERIFY(parseFleetQuery("status=true inclination=97..99 altitude<600", fleet.GetSchema(), query));
+
+        QBENCHMARK {
+            index.Query(query);
+        }
+    }
+
+    void updateFleetIndex_data() {
+        QTest::addColumn<int>("count");
+        addCountRows({100, 10000, 100000});
+    }
+
+    // One edit of an indexed double and one of an indexed text.
+    void updateFleetIndex() {
+        QFETCH(int, count);
+        Fleet fleet(createDefaultParameters());
+        fillFleet(fleet, count);
+        FleetIndex index(&fleet, defaultIndexedColumns());
+        const int altitude = fleet.GetSchema().Find("altitude");
+        const int country = fleet.GetSchema().Find("countryCode");
+        int edit = 0;
+
+        QBENCHMARK {
+            const int satellite = edit++ % count;
+            fleet.SetValue(satellite, altitude, 400.0 + edit % 1000);
+            index.Update(satellite, altitude);
+            fleet.SetValue(satellite, country, edit % 2 == 0 ? "US" : "FR");
+            index.Update(satellite, country);
+        }
+    }
+
+    // Load, validation and the table of a fleet window; closing it saves
+    // the fleet again.
+    void createFleetWindow_data() {
+        QTest::addColumn<int>("count");
+        addCountRows({1, 100, 10000, 100000});
+    }
+
+    void createFleetWindow() {
+        QFETCH(int, count);
+        const QString file = fleetFile(count);
+
+        QBENCHMARK {
+            FleetWindow window(nullptr, file);
+        }
+    }
+};
+
+int main(int argc, char* argv[]) {
+    // The windows are created without a display.
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+
+    ScaleBenchmark benchmark;
+    return QTest::qExec(&benchmark, argc, argv);
+}
+
+#include "ScaleBenchmark.moc"
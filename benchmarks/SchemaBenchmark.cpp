@@ -0,0 +1,117 @@
+// Cost of the satellite parameters from the tables compiled out of
+// schemas/satellite.json against the same schema loaded at runtime: building
+// a store, and reading orbit values through the typed fields against lookups
+// by slot and by name.
+
+#include "DefaultParameters.h"
+#include "SatelliteSchema.h"
+
+#include <QFile>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+namespace {
+
+const int kBuilds = 10000;
+const int kReads = 10000000;
+const int kRepeats = 5;
+
+template<typename Function>
+double bestOfMs(Function&& function) {
+    double best = 1e300;
+    for (int i = 0; i < kRepeats; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        auto finish = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::milli>(finish - start).count());
+    }
+    return best;
+}
+
+// Keeps the reads from being optimized away.
+volatile double sink;
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    QFile file(argc > 1 ? argv[1] : SATELLITE_SCHEMA_FILE);
+    if (!file.open(QIODevice::ReadOnly)) {
+        std::printf("Could not open %s\n", qPrintable(file.fileName()));
+        return 1;
+    }
+    const QByteArray json = file.readAll();
+    ParameterSchema schema;
+    QString message;
+    if (!parseParameterSchema(json, schema, &message)) {
+        std::printf("%s\n", qPrintable(message));
+        return 1;
+    }
+    const ParameterStore loaded = createParameterStore(schema);
+    if (!SatelliteSchema::Matches(loaded)) {
+        std::printf("%s is not the schema SatelliteSchema was generated from\n", qPrintable(file.fileName()));
+        return 1;
+    }
+
+    std::printf("%d builds of %d parameters\n", kBuilds, SatelliteSchema::kParameterCount);
+    const double compiled_ms = bestOfMs([&]() {
+        for (int i = 0; i < kBuilds; ++i) {
+            sink = SatelliteSchema::Create().size();
+        }
+    });
+    const double definitions_ms = bestOfMs([&]() {
+        for (int i = 0; i < kBuilds; ++i) {
+            sink = createParameterStore(schema).size();
+        }
+    });
+    const double parsed_ms = bestOfMs([&]() {
+        for (int i = 0; i < kBuilds; ++i) {
+            ParameterSchema parsed;
+            parseParameterSchema(json, parsed);
+            sink = createParameterStore(parsed).size();
+        }
+    });
+    std::printf("  constexpr tables:          %8.2f ms (%.2f us per store)\n", compiled_ms,
+                compiled_ms * 1000.0 / kBuilds);
+    std::printf("  loaded schema:             %8.2f ms (%.2f us per store)\n", definitions_ms,
+                definitions_ms * 1000.0 / kBuilds);
+    std::printf("  parse and build:           %8.2f ms (%.2f us per store)\n", parsed_ms,
+                parsed_ms * 1000.0 / kBuilds);
+
+    // The same store either way; read apogee and perigee from it.
+    const ParameterStore& parameters = loaded;
+    const int apogee = parameters.Find("apogee");
+    const int perigee = parameters.Find("perigee");
+    std::printf("%d reads of apogee and perigee\n", kReads);
+    const double typed_ms = bestOfMs([&]() {
+        double sum = 0.0;
+        for (int i = 0; i < kReads; ++i) {
+            sum += getParameterValue<SatelliteSchema::Apogee>(parameters) -
+                   getParameterValue<SatelliteSchema::Perigee>(parameters);
+        }
+        sink = sum;
+    });
+    const double slot_ms = bestOfMs([&]() {
+        double sum = 0.0;
+        for (int i = 0; i < kReads; ++i) {
+            sum += parameters.GetValue(apogee).toDouble() - parameters.GetValue(perigee).toDouble();
+        }
+        sink = sum;
+    });
+    const QString apogee_name = "apogee";
+    const QString perigee_name = "perigee";
+    const double name_ms = bestOfMs([&]() {
+        double sum = 0.0;
+        for (int i = 0; i < kReads; ++i) {
+            sum += parameters.GetValue(apogee_name).toDouble() - parameters.GetValue(perigee_name).toDouble();
+        }
+        sink = sum;
+    });
+    std::printf("  typed fields:              %8.2f ms (%.2f ns per read)\n", typed_ms,
+                typed_ms * 1e6 / (2.0 * kReads));
+    std::printf("  GetValue(slot):            %8.2f ms (%.2f ns per read)\n", slot_ms,
+                slot_ms * 1e6 / (2.0 * kReads));
+    std::printf("  GetValue(name):            %8.2f ms (%.2f ns per read)\n", name_ms,
+                name_ms * 1e6 / (2.0 * kReads));
+    return 0;
+}
@@ -0,0 +1,169 @@
+// Reads per second of the shared parameter snapshot from 1 reader thread up
+// to one per core, with the writer idle and with a writer publishing every
+// parameter flat out, against readers that take the segment's lock instead
+// of retrying. Every read copies all entries and checks that they come from
+// one update.
+
+#include "ParameterStore.h"
+#include "SharedSnapshotReader.h"
+#include "SharedSnapshotWriter.h"
+
+#include <QCoreApplication>
+#include <QSharedMemory>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const int kParameterCount = 1000;
+const double kSeconds = 1.0;
+
+struct ReadCounts {
+    long long reads = 0;
+    long long failed = 0;
+    // Reads whose entries come from different updates; must stay 0.
+    long long torn = 0;
+};
+
+bool isConsistent(const std::vector<SharedSnapshotEntry>& entries) {
+    for (const SharedSnapshotEntry& entry : entries) {
+        if (entry.number != entries.front().number) {
+            return false;
+        }
+    }
+    return true;
+}
+
+ReadCounts readRetrying(const QString& key, const std::atomic<bool>& stop) {
+    ReadCounts counts;
+    SharedSnapshotReader reader(key);
+    if (!reader.Attach()) {
+        return counts;
+    }
+    std::vector<SharedSnapshotEntry> entries;
+    while (!stop.load(std::memory_order_relaxed)) {
+        if (!reader.ReadAll(entries)) {
+            ++counts.failed;
+            continue;
+        }
+        ++counts.reads;
+        counts.torn += !isConsistent(entries);
+    }
+    return counts;
+}
+
+// What a reader without the sequence would have to do.
+ReadCounts readLocked(const QString& key, const std::atomic<bool>& stop) {
+    ReadCounts counts;
+    QSharedMemory memory(key);
+    if (!memory.attach(QSharedMemory::ReadOnly)) {
+        return counts;
+    }
+    const auto* source = reinterpret_cast<const SharedSnapshotEntry*>(
+        static_cast<const char*>(memory.constData()) + kEntriesOffset);
+    std::vector<SharedSnapshotEntry> entries(kParameterCount);
+    while (!stop.load(std::memory_order_relaxed)) {
+        memory.lock();
+        std::memcpy(entries.data(), source, kParameterCount * sizeof(SharedSnapshotEntry));
+        memory.unlock();
+        ++counts.reads;
+        counts.torn += !isConsistent(entries);
+    }
+    return counts;
+}
+
+// Sets every parameter to the same new value and publishes it, until stop.
+long long writeAll(ParameterStore& parameters, SharedSnapshotWriter& writer, const std::atomic<bool>& stop) {
+    std::vector<int> all(kParameterCount);
+    for (int slot = 0; slot < kParameterCount; ++slot) {
+        all[slot] = slot;
+    }
+    long long updates = 0;
+    while (!stop.load(std::memory_order_relaxed)) {
+        ++updates;
+        for (int slot = 0; slot < kParameterCount; ++slot) {
+            parameters.Apply(slot, static_cast<double>(updates));
+        }
+        writer.Update(parameters, all);
+    }
+    return updates;
+}
+
+template<typename Read>
+void run(const char* name, Read read, int reader_count, bool busy_writer, ParameterStore& parameters,
+         SharedSnapshotWriter& writer) {
+    std::atomic<bool> stop(false);
+    std::vector<ReadCounts> counts(reader_count);
+    std::vector<std::thread> readers;
+    for (int i = 0; i < reader_count; ++i) {
+        readers.emplace_back([&, i]() {
+            counts[i] = read(writer.GetKey(), stop);
+        });
+    }
+    long long updates = 0;
+    std::thread writer_thread;
+    if (busy_writer) {
+        writer_thread = std::thread([&]() {
+            updates = writeAll(parameters, writer, stop);
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::duration<double>(kSeconds));
+    stop = true;
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+    if (writer_thread.joinable()) {
+        writer_thread.join();
+    }
+
+    ReadCounts total;
+    for (const ReadCounts& count : counts) {
+        total.reads += count.reads;
+        total.failed += count.failed;
+        total.torn += count.torn;
+    }
+    std::printf("%-8s %2d readers, writer %s: %10.0f reads/s (%.0f per reader), %8.0f updates/s, "
+                "%lld failed, %lld torn\n", name, reader_count, busy_writer ? "busy" : "idle", total.reads / kSeconds,
+                total.reads / kSeconds / reader_count, updates / kSeconds, total.failed, total.torn);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    QCoreApplication application(argc, argv);
+
+    ParameterStore parameters;
+    for (int i = 0; i < kParameterCount; ++i) {
+        parameters.AddSpinBox(QString("parameter_%1").arg(i), QString("Parameter %1").arg(i), -1e300, 1e300, 0.0,
+                              1.0);
+    }
+    SharedSnapshotWriter writer(QString("SnapshotBenchmark:%1").arg(QCoreApplication::applicationPid()));
+    QString message;
+    if (!writer.Publish(parameters, &message)) {
+        std::printf("Could not publish the snapshot: %s\n", qPrintable(message));
+        return 1;
+    }
+
+    const int cores = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<int> reader_counts;
+    for (int readers = 1; readers < cores; readers *= 2) {
+        reader_counts.push_back(readers);
+    }
+    reader_counts.push_back(cores);
+
+    std::printf("%d parameters, %zu bytes per read\n", kParameterCount,
+                kParameterCount * sizeof(SharedSnapshotEntry));
+    for (bool busy_writer : {false, true}) {
+        for (int readers : reader_counts) {
+            run("seqlock", readRetrying, readers, busy_writer, parameters, writer);
+            run("locked", readLocked, readers, busy_writer, parameters, writer);
+        }
+    }
+    return 0;
+}
@@ -1,383 +1,879 @@
 #include "Application.h"
+#include "DefaultParameters.h"
+#include "FleetOrbits.h"
+#include "Trace.h"
 
-std::string doubleToString(double value) {
-    std::ostringstream ss;
-    ss << value;
-    return ss.str();
+#include <QSignalBlocker>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace {
+
+QWidget* createInputWidget(LineEditColumn& column, int index, const std::function<void()>& on_edited) {
+    auto* line_edit_widget = new QLineEdit(column.GetModifiedValue(index));
+
+    line_edit_widget->setPlaceholderText(column.original_texts[index]);
+
+    QObject::connect(line_edit_widget, &QLineEdit::editingFinished, [=, &column]() {
+        QString text = line_edit_widget->text();
+
+        if (!text.isEmpty()) {
+            column.SetModifiedValue(index, text);
+            on_edited();
+        } else {
+            line_edit_widget->setText(column.GetModifiedValue(index));
+        }
+    });
+    return line_edit_widget;
+}
+
+QWidget* createInputWidget(CheckBoxColumn& column, int index, const std::function<void()>& on_edited) {
+    auto* checkbox_widget = new QCheckBox();
+
+    checkbox_widget->setChecked(column.GetModifiedValue(index));
+
+    QObject::connect(checkbox_widget, &QCheckBox::stateChanged, [=, &column]() {
+        bool status = checkbox_widget->checkState();
+        column.SetModifiedValue(index, status);
+        on_edited();
+    });
+    return checkbox_widget;
+}
+
+QWidget* createInputWidget(IntSpinBoxColumn& column, int index, const std::function<void()>& on_edited) {
+    auto* spin_box_widget = new QSpinBox();
+
+    spin_box_widget->setMinimum(column.mins[index]);
+    spin_box_widget->setMaximum(column.maxs[index]);
+    spin_box_widget->setValue(column.GetModifiedValue(index));
+    spin_box_widget->setSingleStep(column.steps[index]);
+
+    QObject::connect(spin_box_widget, QOverload<>::of(&QSpinBox::editingFinished), [=, &column]() {
+        column.SetModifiedValue(index, spin_box_widget->value());
+        on_edited();
+    });
+    return spin_box_widget;
+}
+
+QWidget* createInputWidget(DoubleSpinBoxColumn& column, int index, const std::function<void()>& on_edited) {
+    auto* double_spin_box_widget = new QDoubleSpinBox();
+
+    double_spin_box_widget->setMinimum(column.mins[index]);
+    double_spin_box_widget->setMaximum(column.maxs[index]);
+    double_spin_box_widget->setValue(column.GetModifiedValue(index));
+    double_spin_box_widget->setSingleStep(column.steps[index]);
+
+    QObject::connect(double_spin_box_widget, QOverload<>::of(&QDoubleSpinBox::editingFinished), [=, &column]() {
+        column.SetModifiedValue(index, double_spin_box_widget->value());
+        on_edited();
+    });
+    return double_spin_box_widget;
+}
+
+void setInputWidgetValue(QWidget* widget, const LineEditColumn& column, int index) {
+    static_cast<QLineEdit*>(widget)->setText(column.GetModifiedValue(index));
+}
+
+void setInputWidgetValue(QWidget* widget, const CheckBoxColumn& column, int index) {
+    static_cast<QCheckBox*>(widget)->setChecked(column.GetModifiedValue(index));
+}
+
+void setInputWidgetValue(QWidget* widget, const IntSpinBoxColumn& column, int index) {
+    static_cast<QSpinBox*>(widget)->setValue(column.GetModifiedValue(index));
+}
+
+void setInputWidgetValue(QWidget* widget, const DoubleSpinBoxColumn& column, int index) {
+    static_cast<QDoubleSpinBox*>(widget)->setValue(column.GetModifiedValue(index));
+}
+
+void setInputWidgetValue(QWidget* widget, TYPE_PARAMETER type, const QVariant& value) {
+    // Setting a check box emits its edit signal.
+    const QSignalBlocker blocker(widget);
+    switch (type) {
+        case TYPE_PARAMETER::LineEdit:
+            static_cast<QLineEdit*>(widget)->setText(value.toString());
+            break;
+        case TYPE_PARAMETER::CheckBox:
+            static_cast<QCheckBox*>(widget)->setChecked(value.toBool());
+            break;
+        case TYPE_PARAMETER::SpinBox:
+            static_cast<QSpinBox*>(widget)->setValue(value.toInt());
+            break;
+        case TYPE_PARAMETER::DoubleSpinBox:
+            static_cast<QDoubleSpinBox*>(widget)->setValue(value.toDouble());
+            break;
+    }
+}
+
+// A received update as a value of its slot: rounded for ints and true for
+// any non-zero bool. Invalid for NaN. The spin boxes clamp it to the bounds.
+QVariant liveValue(const ParameterStore& parameters, int slot, const TelemetryUpdate& update) {
+    switch (parameters.GetType(slot)) {
+        case TYPE_PARAMETER::LineEdit:
+            return update.text;
+        case TYPE_PARAMETER::CheckBox:
+            return std::isnan(update.number) ? QVariant() : QVariant(update.number != 0.0);
+        case TYPE_PARAMETER::SpinBox: {
+            const IntSpinBoxColumn& column = parameters.GetColumn<IntSpinBoxColumn>();
+            const int index = parameters.GetSlot(slot).index;
+            if (std::isnan(update.number)) {
+                return QVariant();
+            }
+            const double clamped = std::min(std::max(update.number, double(column.mins[index])),
+                                            double(column.maxs[index]));
+            return static_cast<int>(std::lround(clamped));
+        }
+        case TYPE_PARAMETER::DoubleSpinBox:
+            return std::isnan(update.number) ? QVariant() : QVariant(update.number);
+    }
+    return QVariant();
+}
+
+}  // namespace
+
+MainWindow::MainWindow(QWidget* parent, QString config_file, CONFIG_FORMAT format, bool lazy_widgets)
+    : MainWindow(parent, std::move(config_file), createDefaultParameters(), format, lazy_widgets) {
 }
 
-MainWindow::MainWindow(QWidget* parent, QString config_file) : config_file_(std::move(
-    config_file)) {
+MainWindow::MainWindow(QWidget* parent, QString config_file, ParameterStore defaults, CONFIG_FORMAT format,
+                       bool lazy_widgets)
+    : document_(std::move(config_file), std::move(defaults), format), parameters(document_.GetParameters()),
+      lazy_widgets_(lazy_widgets) {
+    saver_ = new ConfigSaver();
+
     main_window_ = new QWidget(parent);
     main_layout_ = new QVBoxLayout();
     save_button_ = new QPushButton("Save");
+    undo_button_ = new QPushButton("Undo");
+    redo_button_ = new QPushButton("Redo");
+    checkpoint_button_ = new QPushButton("Checkpoint...");
+    restore_button_ = new QPushButton("Restore...");
+    orbit_preview_ = new QLabel();
+    rules_status_ = new QLabel();
 
     main_window_->resize(kWeightMainWindow, kHeightMainWindow);
     main_window_->setWindowTitle(kNameMainWindow);
 
     setDefaultValues();
-
-    loadConfig();
+    startup_timer_.Mark("default values");
 
     createWidgets();
+    startup_timer_.Mark("window skeleton");
+
+    QObject::connect(saver_, &ConfigSaver::saveFinished, main_window_,
+                     [this](quint64 generation, bool ok, const QString& message) {
+                         onSaveFinished(generation, ok, message);
+                     }, Qt::QueuedConnection);
+
+    watcher_ = new QFileSystemWatcher(main_window_);
+    reload_timer_ = new QTimer(main_window_);
+    reload_timer_->setSingleShot(true);
+    reload_timer_->setInterval(kReloadDelayMs);
+
+    QObject::connect(watcher_, &QFileSystemWatcher::fileChanged, main_window_, [this]() {
+        reload_timer_->start();
+    });
+    QObject::connect(watcher_, &QFileSystemWatcher::directoryChanged, main_window_, [this]() {
+        reload_timer_->start();
+    });
+    QObject::connect(reload_timer_, &QTimer::timeout, main_window_, [this]() {
+        reloadConfig();
+    });
 
+    // The skeleton is shown while the config is read.
+    startLoading();
 }
 
 MainWindow::~MainWindow() {
+    for (auto& source : telemetry_sources_) {
+        source->Stop();
+    }
+    reportTelemetry();
+    finishLoading();
     saveConfig();
 
-    for (auto& parameter : parameters) {
-        delete parameter;
-    }
+    // Waits for the last write to finish.
+    delete saver_;
 
     delete save_button_;
     delete main_window_;
 }
 
 void MainWindow::setDefaultValues() {
-    const int kNoradIdMin = 10000;
-    const int kNoradIdMax = 99999;
-    const int kNoradIdStep = 1;
-    const int kNoradIdDefault = 10000;
-
-    const double kAltitudeMin = 160.0;
-    const double kAltitudeMax = std::numeric_limits<double>::max();
-    const double kAltitudeStep = 0.01;
-    const double kAltitudeDefault = 160.0;
-
-    const double kInclinationMin = 0.0;
-    const double kInclinationMax = 360.0;
-    const double kInclinationStep = 0.01;
-    const double kInclinationDefault = 0.0;
-
-    const double kApogeeMin = 1000.0;
-    const double kApogeeMax = std::numeric_limits<double>::max();
-    const double kApogeeStep = 0.01;
-    const double kApogeeDefault = 1000.0;
-
-    const double kPerigeeMin = 600.0;
-    const double kPerigeeMax = std::numeric_limits<double>::max();
-    const double kPerigeeStep = 0.01;
-    const double kPerigeeDefault = 600.0;
-
-    const double kEccentricityMin = 0.0;
-    const double kEccentricityMax = std::numeric_limits<double>::max();
-    const double kEccentricityStep = 0.01;
-    const double kEccentricityDefault = 0.0;
-
-    const double kArgPerigeeMin = 0.0;
-    const double kArgPerigeeMax = 360.0;
-    const double kArgPerigeeStep = 0.01;
-    const double kArgPerigeeDefault = 0.0;
-
-    const double kMeanAnomalyMin = 0.0;
-    const double kMeanAnomalyMax = 360.0;
-    const double kMeanAnomalyStep = 0.01;
-    const double kMeanAnomalyDefault = 0.0;
-
-    std::vector<LineEditParameter> lineEditParameters = {
-        {"satelliteName", "Write a satellite name...", "Sat1", "Satellite Name:"},
-        {"satelliteModel", "Write a satellite model...", "Model A", "Model:"},
-        {"countryCode", "Write a country code...", "RU", "Country Code:"},
-        {"description", "Write a satellite description...", "Satellite for Earth observation", "Description:"},
-    };
-
-    std::vector<SpinBoxParameter<int>> IntSpinBoxParameters = {
-        {TYPE_PARAMETER::SpinBox, "noradId", "NORAD ID:", kNoradIdMin, kNoradIdMax, kNoradIdDefault, kNoradIdStep}
-    };
-
-    std::vector<SpinBoxParameter<double>> DoubleSpinBoxParameters = {
-        {TYPE_PARAMETER::DoubleSpinBox, "altitude", "Altitude (km):",
-            kAltitudeMin, kAltitudeMax, kAltitudeDefault, kAltitudeStep},
-        {TYPE_PARAMETER::DoubleSpinBox, "inclination", "Inclination (deg):",
-            kInclinationMin, kInclinationMax, kInclinationDefault, kInclinationStep},
-        {TYPE_PARAMETER::DoubleSpinBox, "apogee", "Apogee (km):",
-            kApogeeMin, kApogeeMax, kApogeeDefault, kApogeeStep},
-        {TYPE_PARAMETER::DoubleSpinBox, "perigee", "Perigee (km):",
-            kPerigeeMin, kPerigeeMax, kPerigeeDefault, kPerigeeStep},
-        {TYPE_PARAMETER::DoubleSpinBox, "eccentricity", "Eccentricity:",
-            kEccentricityMin, kEccentricityMax, kEccentricityDefault, kEccentricityStep},
-        {TYPE_PARAMETER::DoubleSpinBox, "argPerigee", "Argument of Perigee (deg):",
-            kArgPerigeeMin, kArgPerigeeMax, kArgPerigeeDefault, kArgPerigeeStep},
-        {TYPE_PARAMETER::DoubleSpinBox, "meanAnomaly", "Mean Anomaly (deg):",
-            kMeanAnomalyMin, kMeanAnomalyMax, kMeanAnomalyDefault, kMeanAnomalyStep}
-    };
-
-    std::vector<std::vector<QString>> CheckBoxParams = {
-        {"status", "Status (on/off)"}
-    };
-
-    std::vector<CheckBoxParameter> CheckBoxParameters = {
-        {"status", "Status (on/off)", false}
-    };
-
-    for (const auto& parameter : lineEditParameters) {
-        parameters.push_back(new LineEditParameter(parameter));
-    }
-
-    for (const auto& parameter : IntSpinBoxParameters) {
-        parameters.push_back(new SpinBoxParameter<int>(parameter));
-    }
-
-    for (const auto& parameter : DoubleSpinBoxParameters) {
-        parameters.push_back(new SpinBoxParameter<double>(parameter));
-    }
-
-    for (const auto& parameter : CheckBoxParameters) {
-        parameters.push_back(new CheckBoxParameter(parameter));
-    }
+    document_.SetDefaultValues();
 }
 
 void MainWindow::saveConfig(bool is_save_button) {
-    std::string text_to_save;
+    finishLoading();
+    TraceSpan span("MainWindow::saveConfig");
+
+    std::vector<RuleViolation> violations = document_.GetViolations();
+    if (!violations.empty()) {
+        QString text = "The config has not been saved:\n";
+        for (const RuleViolation& violation : violations) {
+            text += violation.message + "\n";
+        }
+        if (is_save_button) {
+            showSaveReport(text);
+            return;
+        }
 
-    QJsonObject jsonObj;
+        // Closing the window must not lose the edits.
+        QString message;
+        if (document_.SaveUnsaved(&message)) {
+            text += "The edited values are kept in " + ConfigDocument::unsavedFileFor(document_.GetFileName());
+        } else {
+            text += "Could not keep the edited values: " + message;
+        }
+        qWarning("%s", qPrintable(text));
+        return;
+    }
 
-    for (auto& parameter : parameters) {
-        QString name = parameter->GetName();
-        switch (parameter->GetType()) {
-            case TYPE_PARAMETER::LineEdit: {
-                auto* line_edit_parameter = dynamic_cast<LineEditParameter*>(parameter);
+    std::string text_to_save;
+    ConfigSnapshot changes = document_.CommitChanges(&text_to_save);
 
-                QString value = line_edit_parameter->GetModifiedValue();
-                QString default_value = line_edit_parameter->GetValue();
+    if (text_to_save.empty()) {
+        if (is_save_button) {
+            showSaveReport("No parameters have been changed.\n");
+        }
+        return;
+    }
 
-                jsonObj[name] = value;
-                if (line_edit_parameter->isChanged()) {
-                    line_edit_parameter->SetValue(value);
-                    text_to_save += name.toStdString() + " has been changed from " + default_value.toStdString() +
-                                    " to " + value.toStdString() + "\n";
-                }
-                break;
-            }
-            case TYPE_PARAMETER::CheckBox: {
-                auto* checkbox_parameter = dynamic_cast<CheckBoxParameter*>(parameter);
-                bool status = checkbox_parameter->GetModifiedValue();
-                bool default_status = checkbox_parameter->GetValue();
-
-                jsonObj[name] = status;
-
-                if (checkbox_parameter->isChanged()) {
-                    checkbox_parameter->SetValue(status);
-                    text_to_save += name.toStdString() + " has been changed from " +
-                                    (default_status ? "true" : "false") +
-                                    " to " +
-                                    (status ? "true" : "false")
-                                    + "\n";
-                }
-                break;
-            }
-            case TYPE_PARAMETER::SpinBox: {
-                auto* int_spinbox_parameter = dynamic_cast<SpinBoxParameter<int>*>(parameter);
-                int value = int_spinbox_parameter->GetModifiedValue();
-                int default_value = int_spinbox_parameter->GetValue();
-
-                jsonObj[name] = value;
-
-                if (int_spinbox_parameter->isChanged()) {
-                    int_spinbox_parameter->SetValue(value);
-                    text_to_save += name.toStdString() + " has been changed from " +
-                                    std::to_string(default_value) + " to " +
-                                    std::to_string(value) + "\n";
-                }
-                break;
-            }
-            case TYPE_PARAMETER::DoubleSpinBox: {
-                auto* double_spinbox_parameter = dynamic_cast<SpinBoxParameter<double>*>(parameter);
-                double value = double_spinbox_parameter->GetModifiedValue();
-                double default_value = double_spinbox_parameter->GetValue();
-
-                jsonObj[name] = value;
-
-                if (double_spinbox_parameter->isChanged()) {
-                    double_spinbox_parameter->SetValue(value);
-                    text_to_save += name.toStdString() + " has been changed from " +
-                                doubleToString(default_value) + " to " +
-                                doubleToString(value) + "\n";
-                }
-                break;
-            }
+    if (snapshot_) {
+        std::vector<int> saved;
+        for (const ConfigValue& change : changes) {
+            saved.push_back(parameters.Find(change.name));
         }
+        snapshot_->Update(parameters, saved);
     }
 
-    if (text_to_save.empty()) {
-        text_to_save = "No parameters have been changed.\n";
-    } else {
+    quint64 generation = saver_->Save(std::move(changes));
+
+    if (is_save_button) {
+        save_report_ += QString::fromStdString(text_to_save);
+        save_report_generation_ = generation;
+    }
+}
+
+void MainWindow::onSaveFinished(quint64 generation, bool ok, const QString& message) {
+    if (!ok) {
+        qWarning("Could not write %s: %s", qPrintable(document_.GetFileName()), qPrintable(message));
+    }
+    if (save_report_.isEmpty() || generation < save_report_generation_) {
+        return;
+    }
 
-        QJsonDocument jsonDoc(jsonObj);
+    showSaveReport(ok ? save_report_ : "Could not save the config: " + message);
+    save_report_.clear();
+}
 
-        QFile file(config_file_);
-        if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-            qWarning("Could not open file for writing.");
-            return;
+void MainWindow::showSaveReport(const QString& text) {
+    showReport("Saving...", text);
+}
+
+void MainWindow::showReport(const QString& title, const QString& text) {
+    auto* message_box = new QMessageBox(QMessageBox::Information, title, text, QMessageBox::Ok, main_window_);
+    message_box->setAttribute(Qt::WA_DeleteOnClose);
+    message_box->open();
+}
+
+QVariant MainWindow::getValue(const QString& name) {
+    finishLoading();
+    return parameters.GetModifiedValue(name);
+}
+
+bool MainWindow::setValue(const QString& name, const QVariant& value, QString* message) {
+    finishLoading();
+
+    std::vector<int> changed;
+    if (!document_.SetValue(name, value, &changed, message)) {
+        return false;
+    }
+    const int slot = parameters.Find(name);
+    updateWidget(slot);
+    finishEdit(slot, changed);
+    return true;
+}
+
+void MainWindow::updateWidget(int slot) {
+    // Pages not created yet pick the value up when they are.
+    if (slot >= static_cast<int>(widgets_.size()) || !widgets_[slot]) {
+        return;
+    }
+    if (slot < static_cast<int>(telemetry_values_.size()) && telemetry_values_[slot].isValid()) {
+        setInputWidgetValue(widgets_[slot], parameters.GetType(slot), telemetry_values_[slot]);
+        return;
+    }
+    parameters.Visit(slot, [&](const auto& column, int index) {
+        setInputWidgetValue(widgets_[slot], column, index);
+    });
+}
+
+void MainWindow::onParameterEdited(int slot) {
+    TraceSpan span("MainWindow::onParameterEdited");
+    std::vector<int> changed;
+    document_.Derive(slot, &changed);
+    finishEdit(slot, changed);
+}
+
+void MainWindow::finishEdit(int slot, std::vector<int>& changed) {
+    for (int changed_slot : changed) {
+        updateWidget(changed_slot);
+    }
+
+    changed.push_back(slot);
+    recordEdit(changed);
+
+    updateRulesStatus();
+    updateOrbitPreview();
+}
+
+EditHistory::State MainWindow::takeHistoryState() const {
+    std::vector<QVariant> values;
+    values.reserve(parameters.size());
+    for (int slot = 0; slot < parameters.size(); ++slot) {
+        values.push_back(parameters.GetModifiedValue(slot));
+    }
+    return {PersistentVector<QVariant>::FromVector(values), 1};
+}
+
+void MainWindow::recordEdit(const std::vector<int>& edited) {
+    if (!history_.IsStarted()) {
+        return;
+    }
+
+    EditHistory::State state = history_.GetCurrent();
+    bool changed = false;
+    for (int slot : edited) {
+        QVariant value = parameters.GetModifiedValue(slot);
+        if (value != state.values.Get(slot)) {
+            state.values = state.values.Set(slot, std::move(value));
+            changed = true;
         }
+    }
 
-        file.write(jsonDoc.toJson());
-        file.close();
+    if (changed) {
+        history_.Push(std::move(state));
+        updateHistoryButtons();
     }
+}
 
-    if (is_save_button) {
-        QMessageBox::information(nullptr, "Saving...", QString::fromStdString(text_to_save));
+void MainWindow::applyState(const EditHistory::State& from, const EditHistory::State& to) {
+    TraceSpan span("MainWindow::applyState");
+    std::vector<std::pair<int, QVariant>> values;
+    PersistentVector<QVariant>::ForEachDifference(from.values, to.values, [&](int slot) {
+        values.emplace_back(slot, to.values.Get(slot));
+    });
+
+    // Through the document, so the violations follow the restored values.
+    std::vector<int> changed;
+    document_.SetValues(values, &changed);
+    for (const auto& value : values) {
+        updateWidget(value.first);
+    }
+    for (int slot : changed) {
+        updateWidget(slot);
     }
 
+    updateRulesStatus();
+    updateOrbitPreview();
+    updateHistoryButtons();
+}
+
+void MainWindow::updateHistoryButtons() {
+    undo_button_->setEnabled(history_.CanUndo());
+    redo_button_->setEnabled(history_.CanRedo());
+}
+
+void MainWindow::undo() {
+    finishLoading();
+    if (!history_.CanUndo()) {
+        return;
+    }
+    EditHistory::State from = history_.GetCurrent();
+    applyState(from, history_.Undo());
+}
+
+void MainWindow::redo() {
+    finishLoading();
+    if (!history_.CanRedo()) {
+        return;
+    }
+    EditHistory::State from = history_.GetCurrent();
+    applyState(from, history_.Redo());
+}
+
+void MainWindow::setCheckpoint(const QString& name) {
+    finishLoading();
+    history_.SetCheckpoint(name);
+}
+
+bool MainWindow::restoreCheckpoint(const QString& name) {
+    finishLoading();
+    const EditHistory::State* checkpoint = history_.GetCheckpoint(name);
+    if (!checkpoint) {
+        return false;
+    }
+
+    EditHistory::State from = history_.GetCurrent();
+    history_.Push(*checkpoint);
+    applyState(from, history_.GetCurrent());
+    return true;
+}
+
+void MainWindow::updateRulesStatus() {
+    QString text;
+    for (const RuleViolation& violation : document_.GetViolations()) {
+        text += violation.message + "\n";
+    }
+    rules_status_->setText(text.trimmed());
+}
+
+void MainWindow::updateOrbitPreview() {
+    const int kPreviewPoints = 4;
+
+    OrbitPropagator propagator(orbitalElements(parameters));
+    const double period = propagator.GetPeriod(0);
+
+    std::vector<double> times;
+    for (int i = 0; i < kPreviewPoints; ++i) {
+        times.push_back(period * i / kPreviewPoints);
+    }
+
+    PositionGrid grid;
+    propagator.Propagate(times, grid, 1);
+
+    QString text = QString("Period: %1 min\n").arg(period / 60.0, 0, 'f', 2);
+    for (int i = 0; i < kPreviewPoints; ++i) {
+        text += QString("t = %1 min: x = %2, y = %3, z = %4 km\n")
+                .arg(times[i] / 60.0, 0, 'f', 2)
+                .arg(grid.x[i], 0, 'f', 1)
+                .arg(grid.y[i], 0, 'f', 1)
+                .arg(grid.z[i], 0, 'f', 1);
+    }
+    orbit_preview_->setText(text);
 }
 
 void MainWindow::show() {
     main_window_->show();
+    startup_timer_.Mark("show");
+
+    // Runs once the events queued by show(), painting included, are handled.
+    QTimer::singleShot(0, main_window_, [this]() {
+        if (!first_frame_shown_) {
+            first_frame_shown_ = true;
+            startup_timer_.Mark("first frame");
+            reportStartup();
+        }
+    });
 }
 
-void MainWindow::loadConfig() {
-    QFile file(config_file_);
+void MainWindow::setStartupReport(bool enabled) {
+    report_startup_ = enabled;
+}
+
+void MainWindow::setHistoryDirectory(const QString& directory) {
+    saver_->SetHistory(directory, parameters.GetSections());
+}
+
+bool MainWindow::addTelemetrySource(const QString& file_name, QString* message) {
+    if (!telemetry_queue_) {
+        telemetry_queue_.reset(new TelemetryQueue(kTelemetryCapacity));
+        telemetry_latest_.resize(parameters.size());
+        telemetry_values_.resize(parameters.size());
+        telemetry_timer_ = new QTimer(main_window_);
+        telemetry_timer_->setInterval(kTelemetryFrameMs);
+        QObject::connect(telemetry_timer_, &QTimer::timeout, main_window_, [this]() {
+            drainTelemetry();
+        });
+        telemetry_timer_->start();
+    }
 
-    if (!file.open(QIODevice::ReadOnly)) {
-        // Файл не найден, используем значения по умолчанию
+    std::unique_ptr<TelemetryIngest> source(new TelemetryIngest(file_name, parameters, *telemetry_queue_));
+    if (!source->Start(message)) {
+        return false;
+    }
+    telemetry_sources_.push_back(std::move(source));
+    return true;
+}
+
+void MainWindow::drainTelemetry() {
+    // Updates wait in the queue until the loader released the parameters.
+    if (!loaded_) {
+        return;
+    }
+    const int depth = telemetry_queue_->GetDepth();
+    telemetry_max_depth_ = std::max(telemetry_max_depth_, depth);
+    Trace::Count("telemetry queue depth", depth);
+
+    // At most one queue's worth per frame, so fast producers cannot keep
+    // the GUI thread here.
+    TelemetryUpdate update;
+    int popped = 0;
+    while (popped < telemetry_queue_->GetCapacity() && telemetry_queue_->Pop(update)) {
+        ++popped;
+        TelemetryUpdate& latest = telemetry_latest_[update.slot];
+        if (latest.slot < 0) {
+            telemetry_pending_.push_back(update.slot);
+        }
+        latest = std::move(update);
+    }
+    if (telemetry_pending_.empty()) {
         return;
     }
+    TraceSpan span("MainWindow::drainTelemetry");
+
+    int applied = 0;
+    for (int slot : telemetry_pending_) {
+        TelemetryUpdate& latest = telemetry_latest_[slot];
+        latest.slot = -1;
+        QVariant value = liveValue(parameters, slot, latest);
+        if (!value.isValid()) {
+            ++telemetry_ignored_;
+            continue;
+        }
+        telemetry_values_[slot] = std::move(value);
+        if (slot < static_cast<int>(widgets_.size()) && widgets_[slot]) {
+            widgets_[slot]->setEnabled(false);
+        }
+        updateWidget(slot);
+        ++applied;
+    }
 
-    // Читаем содержимое файла и сохраняем его в QByteArray
-    QByteArray data = file.readAll();
-    file.close();
+    telemetry_popped_ += popped;
+    telemetry_applied_ += applied;
+    Trace::Count("telemetry coalesced", static_cast<double>(popped - static_cast<int>(telemetry_pending_.size())));
+    telemetry_pending_.clear();
+}
 
-    // Распарсиваем JSON-строку в объект QVariant
-    QJsonParseError error{};
-    QJsonDocument doc = QJsonDocument::fromJson(data, &error);
-    if (doc.isNull()) {
-        // Ошибка при парсинге JSON-строки, используем значения по умолчанию
+void MainWindow::reportTelemetry() {
+    if (!telemetry_queue_) {
         return;
     }
+    qInfo("Telemetry: %llu updates queued, %llu dropped (queue full), %llu applied, %llu ignored, "
+          "%llu coalesced, queue depth up to %d of %d",
+          static_cast<unsigned long long>(telemetry_queue_->GetPushed()),
+          static_cast<unsigned long long>(telemetry_queue_->GetDropped()),
+          static_cast<unsigned long long>(telemetry_applied_),
+          static_cast<unsigned long long>(telemetry_ignored_),
+          static_cast<unsigned long long>(telemetry_popped_ - telemetry_applied_ - telemetry_ignored_),
+          telemetry_max_depth_, telemetry_queue_->GetCapacity());
+    for (const auto& source : telemetry_sources_) {
+        qInfo("Telemetry from %s: %llu lines, %llu rejected", qPrintable(source->GetFileName()),
+              static_cast<unsigned long long>(source->GetReceived()),
+              static_cast<unsigned long long>(source->GetRejected()));
+    }
+}
 
-    QJsonObject root = doc.object();
-    for (auto& parameter : parameters) {
-        switch (parameter->GetType()) {
-            case TYPE_PARAMETER::LineEdit: {
-                if (root.contains(parameter->GetName())) {
-                    auto* line_edit_parameter = dynamic_cast<LineEditParameter*>(parameter);
-                    QVariant value = root.value(parameter->GetName());
+void MainWindow::publishSnapshot(const QString& key) {
+    snapshot_.reset(new SharedSnapshotWriter(key));
+    if (loaded_) {
+        writeSnapshot();
+    }
+}
 
-                    line_edit_parameter->SetValue(value.toString());
-                    line_edit_parameter->SetModifiedValue(value.toString());
-                }
-                break;
-            }
-            case TYPE_PARAMETER::CheckBox: {
-                if (root.contains(parameter->GetName())) {
-                    auto* checkbox_parameter = dynamic_cast<CheckBoxParameter*>(parameter);
-                    QVariant value = root.value(parameter->GetName());
-
-                    checkbox_parameter->SetValue(value.toBool());
-                    checkbox_parameter->SetModifiedValue(value.toBool());
-                }
-                break;
-            }
-            case TYPE_PARAMETER::SpinBox: {
-                if (root.contains(parameter->GetName())) {
-                    auto* spin_box_parameter = dynamic_cast<SpinBoxParameter<int>*>(parameter);
-                    QVariant value = root.value(parameter->GetName());
-
-                    spin_box_parameter->SetValue(value.toInt());
-                    spin_box_parameter->SetModifiedValue(value.toInt());
-                }
-                break;
-            }
-            case TYPE_PARAMETER::DoubleSpinBox: {
-                if (root.contains(parameter->GetName())) {
-                    auto* spin_box_parameter = dynamic_cast<SpinBoxParameter<double>*>(parameter);
-                    QVariant value = root.value(parameter->GetName());
-
-                    spin_box_parameter->SetValue(value.toDouble());
-                    spin_box_parameter->SetModifiedValue(value.toDouble());
-                }
-                break;
-            }
+void MainWindow::writeSnapshot() {
+    if (!snapshot_) {
+        return;
+    }
+    QString message;
+    if (!snapshot_->Publish(parameters, &message)) {
+        qWarning("Could not publish %s: %s", qPrintable(snapshot_->GetKey()), qPrintable(message));
+        snapshot_.reset();
+    }
+}
+
+void MainWindow::reportStartup() {
+    if (!report_startup_ || !loaded_ || !first_frame_shown_) {
+        return;
+    }
+    report_startup_ = false;
+    qInfo("Startup of %s:\n%s", qPrintable(document_.GetFileName()), qPrintable(startup_timer_.ToString()));
+}
+
+void MainWindow::startLoading() {
+    loader_ = std::thread([this]() {
+        Trace::SetThreadName("config loader");
+        auto start = std::chrono::steady_clock::now();
+        load_ok_ = document_.Load(&load_error_);
+        load_ms_ = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        QMetaObject::invokeMethod(main_window_, [this]() {
+            finishLoading();
+        }, Qt::QueuedConnection);
+    });
+}
+
+void MainWindow::finishLoading() {
+    if (loaded_) {
+        return;
+    }
+    loader_.join();
+    loaded_ = true;
+    TraceSpan span("MainWindow::finishLoading");
+
+    auto start = std::chrono::steady_clock::now();
+    startup_timer_.Add("config load (background)", load_ms_);
+    if (!load_ok_) {
+        qWarning("Could not load %s: %s", qPrintable(document_.GetFileName()), qPrintable(load_error_.toString()));
+    }
+
+    keepStaleJournal();
+    saver_->SetBase(document_.GetFileName(), document_.GetFormat(), takeSnapshot(parameters));
+    writeSnapshot();
+    updateRulesStatus();
+    history_.Reset(takeHistoryState());
+
+    // Reloads must not run while the loader still owns the parameters.
+    watchConfig();
+
+    if (lazy_widgets_) {
+        createPage(pages_widget_->currentIndex());
+    } else {
+        for (int page = 0; page < static_cast<int>(pages_.size()); ++page) {
+            createPage(page);
         }
     }
+    updateOrbitPreview();
+    save_button_->setEnabled(true);
+    checkpoint_button_->setEnabled(true);
+    restore_button_->setEnabled(true);
+
+    startup_timer_.Add("widgets", std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - start).count());
+    reportStartup();
 }
 
-void MainWindow::createWidgets() {
+void MainWindow::loadConfig() {
+    finishLoading();
+    TraceSpan span("MainWindow::loadConfig");
+
+    ConfigError error;
+
+    if (!document_.Load(&error)) {
+        qWarning("Could not load %s: %s", qPrintable(document_.GetFileName()), qPrintable(error.toString()));
+    }
+
+    keepStaleJournal();
+    saver_->SetBase(document_.GetFileName(), document_.GetFormat(), takeSnapshot(parameters));
+    writeSnapshot();
+
+    // Any value may have changed, and edits made before cannot be undone
+    // onto the loaded ones.
+    for (int slot = 0; slot < parameters.size(); ++slot) {
+        updateWidget(slot);
+    }
+    history_.Reset(takeHistoryState());
+    updateHistoryButtons();
+
+    updateRulesStatus();
+    updateOrbitPreview();
+}
+
+void MainWindow::watchConfig() {
+    const QString& file = document_.GetFileName();
+    const QString directory = QFileInfo(file).absolutePath();
+
+    if (!watcher_->directories().contains(directory)) {
+        watcher_->addPath(directory);
+    }
+    if (QFile::exists(file) && !watcher_->files().contains(file)) {
+        watcher_->addPath(file);
+    }
+}
+
+void MainWindow::reloadConfig() {
+    watchConfig();
+
+    // Our own queued writes must reach the disk first, or the reload would
+    // see them as missing and roll the values back.
+    saver_->Flush(ConfigSaver::kFlushTimeoutMs);
+
+    std::vector<int> changed;
+    std::vector<int> conflicts;
+    ConfigError error;
+    if (!document_.Reload(&changed, &conflicts, &error)) {
+        qWarning("Could not reload %s: %s", qPrintable(document_.GetFileName()), qPrintable(error.toString()));
+        return;
+    }
+    keepStaleJournal();
+    if (changed.empty() && conflicts.empty()) {
+        return;
+    }
+
+    // Only the widgets whose value changed are touched; the layout stays.
+    for (int slot : changed) {
+        updateWidget(slot);
+    }
+    recordEdit(changed);
+
+    saver_->SetBase(document_.GetFileName(), document_.GetFormat(), takeSnapshot(parameters));
+    if (snapshot_) {
+        // Conflicting slots keep their edit but take the stored value from disk.
+        std::vector<int> stored = changed;
+        stored.insert(stored.end(), conflicts.begin(), conflicts.end());
+        snapshot_->Update(parameters, stored);
+    }
+    updateRulesStatus();
+    updateOrbitPreview();
+
+    if (!conflicts.empty()) {
+        QString text = "The config has been changed by another program. Your unsaved values are kept:\n";
+        for (int slot : conflicts) {
+            text += QString("%1: %2 on disk, %3 here\n")
+                    .arg(parameters.GetName(slot))
+                    .arg(parameters.GetValue(slot).toString())
+                    .arg(parameters.GetModifiedValue(slot).toString());
+        }
+        showReport("Reloading...", text);
+    }
+}
+
+void MainWindow::keepStaleJournal() {
+    if (!document_.HasStaleJournal()) {
+        return;
+    }
+    QString kept_file;
+    QString message;
+    if (!document_.KeepStaleJournal(&kept_file, &message)) {
+        qWarning("%s", qPrintable(message));
+        return;
+    }
+    if (!kept_file.isEmpty()) {
+        showReport("Loading...", QString("The config has been rewritten by another program since the last saves "
+                                         "here. They were not applied and are kept in %1.").arg(kept_file));
+    }
+}
+
+void MainWindow::createPage(int page) {
     const int kWidthParameter = 700;
     const int kHeightParameter = 25;
 
-    for (auto& parameter : parameters) {
-        auto* label = new QLabel(parameter->GetLabel());
-        QWidget* widget;
-        TYPE_PARAMETER type = parameter->GetType();
-        switch (type) {
-            case TYPE_PARAMETER::LineEdit: {
-                auto* line_edit_parameter = dynamic_cast<LineEditParameter*>(parameter);
-                auto* line_edit_widget = new QLineEdit(line_edit_parameter->GetValue());
-                widget = line_edit_widget;
-
-                label->setObjectName(parameter->GetName());
-                line_edit_widget->setPlaceholderText(line_edit_parameter->GetOriginalText());
-
-                QObject::connect(line_edit_widget, &QLineEdit::editingFinished, [=]() {
-                    QString text = line_edit_widget->text();
-
-                    if (!text.isEmpty()) {
-                        line_edit_parameter->SetModifiedValue(text);
-                    } else {
-                        line_edit_widget->setText(line_edit_parameter->GetValue());
-                    }
-                });
-                break;
-            }
-            case TYPE_PARAMETER::CheckBox: {
-                auto* checkbox_widget = new QCheckBox();
-                auto* checkbox_parameter = dynamic_cast<CheckBoxParameter*>(parameter);
-                widget = checkbox_widget;
-
-                checkbox_widget->setChecked(checkbox_parameter->GetValue());
-
-                QObject::connect(checkbox_widget, &QCheckBox::stateChanged, [=]() {
-                    bool status = checkbox_widget->checkState();
-                    checkbox_parameter->SetModifiedValue(status);
-                });
-                break;
-            }
-            case TYPE_PARAMETER::SpinBox: {
-                auto* spin_box_widget = new QSpinBox();
-                auto* int_spin_box_parameter = dynamic_cast<SpinBoxParameter<int>*>(parameter);
-                widget = spin_box_widget;
-
-                spin_box_widget->setMinimum(int_spin_box_parameter->GetMin());
-                spin_box_widget->setMaximum(int_spin_box_parameter->GetMax());
-                spin_box_widget->setValue(int_spin_box_parameter->GetValue());
-                spin_box_widget->setSingleStep(int_spin_box_parameter->GetStep());
-
-                QObject::connect(spin_box_widget, QOverload<>::of(&QSpinBox::editingFinished), [=]() {
-                    int_spin_box_parameter->SetModifiedValue(spin_box_widget->value());
-                });
-                break;
+    if (page < 0 || pages_[page].created) {
+        return;
+    }
+    TraceSpan span("MainWindow::createPage");
+    WidgetPage& target = pages_[page];
+    target.created = true;
+
+    for (int slot = target.begin; slot < target.end; ++slot) {
+        parameters.Visit(slot, [&](auto& column, int index) {
+            auto* label = new QLabel(column.labels[index]);
+            QWidget* widget = createInputWidget(column, index, [this, slot]() {
+                onParameterEdited(slot);
+            });
+
+            // Derived parameters are computed, not typed in, and live values
+            // are shown, not edited.
+            const bool is_live = slot < static_cast<int>(telemetry_values_.size()) &&
+                                 telemetry_values_[slot].isValid();
+            widget->setEnabled(!document_.GetRules().IsDerived(slot) && !is_live);
+
+            label->setObjectName(column.names[index]);
+            widgets_[slot] = widget;
+            if (is_live) {
+                updateWidget(slot);
             }
-            case TYPE_PARAMETER::DoubleSpinBox: {
-                auto* double_spin_box_widget = new QDoubleSpinBox();
-                auto* double_spin_box_parameter = dynamic_cast<SpinBoxParameter<double>*>(parameter);
-                widget = double_spin_box_widget;
-
-                double_spin_box_widget->setMinimum(double_spin_box_parameter->GetMin());
-                double_spin_box_widget->setMaximum(double_spin_box_parameter->GetMax());
-                double_spin_box_widget->setValue(double_spin_box_parameter->GetValue());
-                double_spin_box_widget->setSingleStep(double_spin_box_parameter->GetStep());
-
-                QObject::connect(double_spin_box_widget, QOverload<>::of(&QDoubleSpinBox::editingFinished), [=]() {
-                    double_spin_box_parameter->SetModifiedValue(double_spin_box_widget->value());
-                });
-                break;
+
+            widget->setFixedSize(kWidthParameter, kHeightParameter);
+
+            auto* inputLayout = new QHBoxLayout();
+            inputLayout->addWidget(label);
+            inputLayout->addWidget(widget);
+            target.layout->addLayout(inputLayout);
+        });
+    }
+}
+
+void MainWindow::createWidgets() {
+    TraceSpan span("MainWindow::createWidgets");
+    widgets_.assign(parameters.size(), nullptr);
+    pages_widget_ = new QToolBox();
+
+    for (const ParameterSection& section : parameters.GetSections()) {
+        const int page_count = (section.end - section.begin + kPageSize - 1) / kPageSize;
+        for (int i = 0; i < page_count; ++i) {
+            const int begin = section.begin + i * kPageSize;
+            const int end = std::min(begin + kPageSize, section.end);
+
+            QString title = section.title.isEmpty() ? QString("Parameters") : section.title;
+            if (page_count > 1) {
+                title += QString(" (%1/%2)").arg(i + 1).arg(page_count);
             }
-        }
 
-        widget->setFixedSize(kWidthParameter, kHeightParameter);
+            auto* content = new QWidget();
+            auto* layout = new QVBoxLayout();
+            content->setLayout(layout);
+
+            auto* scroll_area = new QScrollArea();
+            scroll_area->setWidgetResizable(true);
+            scroll_area->setWidget(content);
 
-        auto* inputLayout = new QHBoxLayout();
-        inputLayout->addWidget(label);
-        inputLayout->addWidget(widget);
-        main_layout_->addLayout(inputLayout);
+            pages_.push_back({begin, end, layout, false});
+            pages_widget_->addItem(scroll_area, title);
+        }
     }
+    main_layout_->addWidget(pages_widget_);
+
+    QObject::connect(pages_widget_, &QToolBox::currentChanged, [this](int page) {
+        if (loaded_) {
+            createPage(page);
+        }
+    });
 
-    main_layout_->addWidget(save_button_, 0, Qt::AlignTop | Qt::AlignRight);
+    rules_status_->setStyleSheet("color: red");
+    main_layout_->addWidget(rules_status_);
+
+    auto* orbit_box = new QGroupBox("Orbit preview");
+    auto* orbit_layout = new QVBoxLayout();
+    orbit_preview_->setText("Loading...");
+    orbit_layout->addWidget(orbit_preview_);
+    orbit_box->setLayout(orbit_layout);
+    main_layout_->addWidget(orbit_box);
+
+    // Enabled once the config is loaded.
+    auto* buttons_layout = new QHBoxLayout();
+    buttons_layout->addStretch();
+    for (QPushButton* button : {undo_button_, redo_button_, checkpoint_button_, restore_button_, save_button_}) {
+        button->setEnabled(false);
+        buttons_layout->addWidget(button);
+    }
+    main_layout_->addLayout(buttons_layout);
     main_window_->setLayout(main_layout_);
 
     QObject::connect(save_button_, &QPushButton::clicked, [&]() {
         saveConfig(true);
     });
+    QObject::connect(undo_button_, &QPushButton::clicked, [&]() {
+        undo();
+    });
+    QObject::connect(redo_button_, &QPushButton::clicked, [&]() {
+        redo();
+    });
+    QObject::connect(new QShortcut(QKeySequence::Undo, main_window_), &QShortcut::activated, [&]() {
+        undo();
+    });
+    QObject::connect(new QShortcut(QKeySequence::Redo, main_window_), &QShortcut::activated, [&]() {
+        redo();
+    });
+    QObject::connect(checkpoint_button_, &QPushButton::clicked, [&]() {
+        bool ok = false;
+        QString name = QInputDialog::getText(main_window_, "Checkpoint", "Name:", QLineEdit::Normal, QString(), &ok);
+        if (ok && !name.isEmpty()) {
+            setCheckpoint(name);
+        }
+    });
+    QObject::connect(restore_button_, &QPushButton::clicked, [&]() {
+        QStringList names = history_.GetCheckpointNames();
+        if (names.isEmpty()) {
+            showReport("Restoring...", "No checkpoints have been set.");
+            return;
+        }
+        bool ok = false;
+        QString name = QInputDialog::getItem(main_window_, "Restore checkpoint", "Checkpoint:", names, 0, false, &ok);
+        if (ok) {
+            restoreCheckpoint(name);
+        }
+    });
 }
@@ -1,6 +1,13 @@
 #pragma once
 
-#include "Parameters.h"
+#include "ConfigDocument.h"
+#include "ConfigSaver.h"
+#include "EditHistory.h"
+#include "ParameterStore.h"
+#include "SharedSnapshotWriter.h"
+#include "StartupTimer.h"
+#include "TelemetryIngest.h"
+#include "TelemetryQueue.h"
 
 #include <QApplication>
 #include <QWidget>
@@ -13,39 +20,245 @@
 #include <QJsonObject>
 #include <QJsonDocument>
 #include <QPushButton>
+#include <QGroupBox>
+#include <QToolBox>
+#include <QInputDialog>
+#include <QShortcut>
+#include <QScrollArea>
 #include <QMessageBox>
 #include <QFile>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QTimer>
+#include <functional>
+#include <memory>
 #include <vector>
 #include <sstream>
+#include <thread>
 
 class MainWindow {
 private:
-    QString config_file_;
+    // Load/modify/save logic; the window only adds widgets around it.
+    ConfigDocument document_;
+
+    ConfigSaver* saver_;
+
+    // Reloads the config when another process rewrites it. Bursts of change
+    // notifications restart reload_timer_, so they cause a single reload.
+    QFileSystemWatcher* watcher_;
+    QTimer* reload_timer_;
+
+    static const int kReloadDelayMs = 200;
+
+    // The config is read on loader_ while the window skeleton is shown; the
+    // parameters are not touched by the GUI until finishLoading() joined it.
+    std::thread loader_;
+    bool loaded_ = false;
+    bool load_ok_ = true;
+    ConfigError load_error_;
+    double load_ms_ = 0.0;
+
+    StartupTimer startup_timer_;
+    bool report_startup_ = false;
+    bool first_frame_shown_ = false;
+
+    // Stored values for other processes, null unless publishSnapshot() was called.
+    std::unique_ptr<SharedSnapshotWriter> snapshot_;
+
+    // Live values pushed by the ingest threads. They are applied once per
+    // frame of telemetry_timer_, the latest value of each slot only, so the
+    // widgets are updated at most kTelemetryFrameMs apart at any input rate.
+    // The queue outlives the sources that push into it.
+    std::unique_ptr<TelemetryQueue> telemetry_queue_;
+    std::vector<std::unique_ptr<TelemetryIngest>> telemetry_sources_;
+    QTimer* telemetry_timer_ = nullptr;
+    // Latest value per slot of the current frame; slot is -1 for the others.
+    std::vector<TelemetryUpdate> telemetry_latest_;
+    std::vector<int> telemetry_pending_;
+    // Latest live value per slot, invalid until one arrived. Live values are
+    // a layer over the document that only the widgets show: they never enter
+    // the parameters, so they are not saved, derived from, checked by the
+    // rules or undone.
+    std::vector<QVariant> telemetry_values_;
+    quint64 telemetry_popped_ = 0;
+    quint64 telemetry_applied_ = 0;
+    quint64 telemetry_ignored_ = 0;
+    int telemetry_max_depth_ = 0;
+
+    static const int kTelemetryFrameMs = 16;
+    static const int kTelemetryCapacity = 1 << 16;
+
+    QString save_report_;
+    quint64 save_report_generation_ = 0;
 
     QVBoxLayout* main_layout_;
 
     QPushButton* save_button_;
+    QPushButton* undo_button_;
+    QPushButton* redo_button_;
+    QPushButton* checkpoint_button_;
+    QPushButton* restore_button_;
+
+    // Modified values after every edit, started once the config is loaded.
+    EditHistory history_;
     QWidget* main_window_;
 
+    // Position of the satellite computed from the edited values.
+    QLabel* orbit_preview_;
+
+    // Violated cross-field rules, empty when the orbit is consistent.
+    QLabel* rules_status_;
+
     static const int kWeightMainWindow = 800;
     static const int kHeightMainWindow = 600;
 
     const QString kNameMainWindow = "Satellite App";
 
-    std::vector<Parameter*> parameters;
+    ParameterStore& parameters;
+
+    // Parameter sections are split into pages of at most kPageSize inputs;
+    // the inputs of a page are created the first time it is shown.
+    struct WidgetPage {
+        int begin;
+        int end;
+        QVBoxLayout* layout;
+        bool created;
+    };
+
+    static const int kPageSize = 200;
+
+    bool lazy_widgets_;
+    QToolBox* pages_widget_;
+    std::vector<WidgetPage> pages_;
+
+    // Input widget of every parameter slot, null until its page is created.
+    std::vector<QWidget*> widgets_;
+
+    void createPage(int page);
+
+    void startLoading();
+
+    // Waits for the background load, then fills the current page (or every
+    // page without lazy widgets). Does nothing once the config is loaded.
+    void finishLoading();
+
+    void reportStartup();
+
+    // Writes every stored value to snapshot_; drops it if that fails.
+    void writeSnapshot();
+
+    EditHistory::State takeHistoryState() const;
+
+    // Adds a history state if any of the slots differs from the current one.
+    void recordEdit(const std::vector<int>& edited);
+
+    // Sets the values that differ between the states, re-derives from them
+    // and updates their widgets and the rules status.
+    void applyState(const EditHistory::State& from, const EditHistory::State& to);
+
+    void updateHistoryButtons();
+
+    // Shows the live value of the slot if it has one, otherwise its
+    // modified value.
+    void updateWidget(int slot);
+
+    void updateOrbitPreview();
+
+    // Re-derives the parameters that depend on an edited slot.
+    void onParameterEdited(int slot);
+
+    // Shows the slots the edit of slot derived and records the edit.
+    void finishEdit(int slot, std::vector<int>& changed);
+
+    void updateRulesStatus();
+
+    // Watches the config and its directory; the file is re-added after it
+    // was replaced (QSaveFile renames over it).
+    void watchConfig();
+
+    void reloadConfig();
+
+    // Sets aside a journal the load found superseded by a rewrite of the
+    // config, before the saver appends to it, and tells the user where its
+    // saves are kept.
+    void keepStaleJournal();
+
+    // Shows the telemetry queued since the last frame in the widgets. A
+    // widget showing live values is disabled, so they cannot be taken for
+    // an edit. A live value of a derived parameter (altitude) replaces the
+    // computed one on screen, as a measurement of it.
+    void drainTelemetry();
+
+    // Logs the queue metrics of the run.
+    void reportTelemetry();
 
 public:
-    explicit MainWindow(QWidget* parent = nullptr, QString config_file = "config.json");
+    // With lazy_widgets the inputs of a page are created when it is first
+    // shown, otherwise all of them once the config is loaded.
+    explicit MainWindow(QWidget* parent = nullptr, QString config_file = "config.json",
+                        CONFIG_FORMAT format = CONFIG_FORMAT::Auto, bool lazy_widgets = true);
+
+    // Edits a config of another schema than createDefaultParameters().
+    MainWindow(QWidget* parent, QString config_file, ParameterStore defaults,
+               CONFIG_FORMAT format = CONFIG_FORMAT::Auto, bool lazy_widgets = true);
 
     ~MainWindow();
 
     void setDefaultValues();
 
+    // Saves the edits unless they break the rules. Then the save button
+    // shows the violations, while the save on exit writes the edits to
+    // ConfigDocument::unsavedFileFor() instead.
     void saveConfig(bool is_save_button = false);
 
     void show();
 
+    // Logs the duration of each startup phase once the first frame is shown
+    // and the config is loaded.
+    void setStartupReport(bool enabled);
+
+    // Starts reading live values from a file or named pipe of "name value"
+    // lines (see TelemetryIngest); may be called for several sources.
+    bool addTelemetrySource(const QString& file_name, QString* message = nullptr);
+
+    // Keeps every saved state in a ConfigHistory in the directory. Called
+    // before the config is loaded.
+    void setHistoryDirectory(const QString& directory);
+
+    // Publishes the stored values under key for SharedSnapshotReader, once
+    // loaded and after every save or reload.
+    void publishSnapshot(const QString& key);
+
+    // Reads the current (possibly unsaved) value of a parameter by name.
+    // Like every access to the values, waits for the config to be loaded.
+    QVariant getValue(const QString& name);
+
+    // Sets a parameter by name as if it was edited in its widget, through
+    // the checks of ConfigDocument::SetValue(): unknown names, values of the
+    // wrong type or out of bounds and derived parameters are rejected with
+    // message.
+    bool setValue(const QString& name, const QVariant& value, QString* message = nullptr);
+
+    // Reads the config from disk again, dropping unsaved edits and the undo
+    // history; the widgets show the loaded values.
     void loadConfig();
 
+    void onSaveFinished(quint64 generation, bool ok, const QString& message);
+
+    void showSaveReport(const QString& text);
+
+    void showReport(const QString& title, const QString& text);
+
+    void undo();
+
+    void redo();
+
+    // Names the current values; restoring a checkpoint can itself be undone.
+    void setCheckpoint(const QString& name);
+
+    bool restoreCheckpoint(const QString& name);
+
+    // Creates the window skeleton: one page per parameter section, the rules
+    // status, the orbit preview and the save button.
     void createWidgets();
 };
@@ -0,0 +1,292 @@
+#include "ConfigDiff.h"
+
+#include <algorithm>
+#include <clocale>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+
+namespace {
+
+// Values compared as a block before looking at single values.
+const int kBlockSize = 256;
+
+// Whether no value of a block differs by the != of
+// ParameterColumn::isChanged(). Integers that are equal are bit-identical,
+// so memcmp answers for them. Doubles are not, since -0.0 equals 0.0 and a
+// NaN equals nothing, so they are compared by value in a loop without
+// branches, which is vectorized as well.
+template<typename T>
+bool equalBlock(const T* before, const T* after, int count) {
+    if (!std::is_floating_point<T>::value) {
+        return std::memcmp(before, after, count * sizeof(T)) == 0;
+    }
+    bool differs = false;
+    for (int i = 0; i < count; ++i) {
+        differs |= before[i] != after[i];
+    }
+    return !differs;
+}
+
+template<typename T, typename Function>
+void forEachDifference(const std::vector<T>& before, const std::vector<T>& after, Function function) {
+    const int count = static_cast<int>(std::min(before.size(), after.size()));
+    for (int begin = 0; begin < count; begin += kBlockSize) {
+        const int end = std::min(count, begin + kBlockSize);
+        if (equalBlock(before.data() + begin, after.data() + begin, end - begin)) {
+            continue;
+        }
+        for (int i = begin; i < end; ++i) {
+            if (before[i] != after[i]) {
+                function(i);
+            }
+        }
+    }
+}
+
+template<typename Function>
+void forEachDifference(const std::vector<QString>& before, const std::vector<QString>& after, Function function) {
+    const int count = static_cast<int>(std::min(before.size(), after.size()));
+    for (int i = 0; i < count; ++i) {
+        if (before[i] != after[i]) {
+            function(i);
+        }
+    }
+}
+
+ConfigChange makeChange(int satellite, int slot, const QString& before, const QString& after) {
+    return {satellite, slot, 0.0, 0.0, before, after};
+}
+
+template<typename T>
+ConfigChange makeChange(int satellite, int slot, T before, T after) {
+    return {satellite, slot, static_cast<double>(before), static_cast<double>(after), QString(), QString()};
+}
+
+template<typename Column, typename S>
+void addColumnChanges(const Column& column, const std::vector<S>& before, const std::vector<S>& after,
+                      std::vector<ConfigChange>& changes) {
+    forEachDifference(before, after, [&](int index) {
+        changes.push_back(makeChange(-1, column.store_slots[index], before[index], after[index]));
+    });
+}
+
+template<typename T>
+void addFleetChanges(int slot, const std::vector<T>& before, const std::vector<T>& after,
+                     std::vector<ConfigChange>& changes) {
+    forEachDifference(before, after, [&](int satellite) {
+        changes.push_back(makeChange(satellite, slot, before[satellite], after[satellite]));
+    });
+}
+
+void sortChanges(std::vector<ConfigChange>& changes) {
+    std::sort(changes.begin(), changes.end(), [](const ConfigChange& a, const ConfigChange& b) {
+        return a.satellite != b.satellite ? a.satellite < b.satellite : a.slot < b.slot;
+    });
+}
+
+void appendInteger(std::string& out, long long value) {
+    char buffer[24];
+    char* end = buffer + sizeof(buffer);
+    char* begin = end;
+    unsigned long long magnitude = value < 0 ? 0ULL - static_cast<unsigned long long>(value)
+                                             : static_cast<unsigned long long>(value);
+    do {
+        *--begin = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (value < 0) {
+        *--begin = '-';
+    }
+    out.append(begin, end);
+}
+
+// Shortest of 15 to 17 significant digits that reads back as the same
+// double, into a stack buffer.
+void appendDouble(std::string& out, double value) {
+    char buffer[32];
+    int length = 0;
+    for (int precision = 15; precision <= 17; ++precision) {
+        length = std::snprintf(buffer, sizeof(buffer), "%.*g", precision, value);
+        if (precision == 17 || std::strtod(buffer, nullptr) == value) {
+            break;
+        }
+    }
+
+    // QApplication sets the user's locale, which may use a decimal comma.
+    const char separator = *std::localeconv()->decimal_point;
+    if (separator != '.') {
+        std::replace(buffer, buffer + length, separator, '.');
+    }
+    out.append(buffer, length);
+}
+
+// Appends UTF-16 as UTF-8, escaped for a JSON string if asked to.
+void appendString(std::string& out, const QString& text, bool json) {
+    const ushort* data = text.utf16();
+    const int size = text.size();
+    for (int i = 0; i < size; ++i) {
+        uint code_point = data[i];
+        if (code_point >= 0xD800 && code_point < 0xDC00 && i + 1 < size && data[i + 1] >= 0xDC00 &&
+            data[i + 1] < 0xE000) {
+            code_point = 0x10000 + ((code_point - 0xD800) << 10) + (data[++i] - 0xDC00);
+        }
+
+        if (json && (code_point == '"' || code_point == '\\')) {
+            out += '\\';
+            out += static_cast<char>(code_point);
+        } else if (json && code_point < 0x20) {
+            char escape[8];
+            std::snprintf(escape, sizeof(escape), "\\u%04x", code_point);
+            out += escape;
+        } else if (code_point < 0x80) {
+            out += static_cast<char>(code_point);
+        } else if (code_point < 0x800) {
+            out += static_cast<char>(0xC0 | (code_point >> 6));
+            out += static_cast<char>(0x80 | (code_point & 0x3F));
+        } else if (code_point < 0x10000) {
+            out += static_cast<char>(0xE0 | (code_point >> 12));
+            out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code_point & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (code_point >> 18));
+            out += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code_point & 0x3F));
+        }
+    }
+}
+
+void appendValue(std::string& out, TYPE_PARAMETER type, double number, const QString& text, bool json) {
+    switch (type) {
+        case TYPE_PARAMETER::LineEdit:
+            if (json) {
+                out += '"';
+            }
+            appendString(out, text, json);
+            if (json) {
+                out += '"';
+            }
+            return;
+        case TYPE_PARAMETER::CheckBox:
+            out += number != 0.0 ? "true" : "false";
+            return;
+        case TYPE_PARAMETER::SpinBox:
+            appendInteger(out, static_cast<long long>(number));
+            return;
+        case TYPE_PARAMETER::DoubleSpinBox:
+            if (json && !std::isfinite(number)) {
+                out += "null";
+            } else {
+                appendDouble(out, number);
+            }
+            return;
+    }
+}
+
+}  // namespace
+
+ConfigDiff diffConfigs(const ParameterStore& before, const ParameterStore& after) {
+    ConfigDiff diff;
+    addColumnChanges(before.GetLineEdits(), before.GetLineEdits().values, after.GetLineEdits().values, diff.changes);
+    addColumnChanges(before.GetIntSpinBoxes(), before.GetIntSpinBoxes().values, after.GetIntSpinBoxes().values,
+                     diff.changes);
+    addColumnChanges(before.GetDoubleSpinBoxes(), before.GetDoubleSpinBoxes().values,
+                     after.GetDoubleSpinBoxes().values, diff.changes);
+    addColumnChanges(before.GetCheckBoxes(), before.GetCheckBoxes().values, after.GetCheckBoxes().values,
+                     diff.changes);
+    sortChanges(diff.changes);
+    return diff;
+}
+
+ConfigDiff diffModifiedValues(const ParameterStore& parameters) {
+    ConfigDiff diff;
+    parameters.VisitColumns([&](const auto& column) {
+        addColumnChanges(column, column.values, column.modified_values, diff.changes);
+    });
+    sortChanges(diff.changes);
+    return diff;
+}
+
+ConfigDiff diffFleets(const Fleet& before, const Fleet& after) {
+    ConfigDiff diff;
+    diff.is_fleet = true;
+    diff.satellites_before = before.GetSatelliteCount();
+    diff.satellites_after = after.GetSatelliteCount();
+
+    for (int slot = 0; slot < before.GetParameterCount(); ++slot) {
+        switch (before.GetSchema().GetType(slot)) {
+            case TYPE_PARAMETER::LineEdit:
+                addFleetChanges(slot, before.GetTexts(slot), after.GetTexts(slot), diff.changes);
+                break;
+            case TYPE_PARAMETER::CheckBox:
+                addFleetChanges(slot, before.GetBools(slot), after.GetBools(slot), diff.changes);
+                break;
+            case TYPE_PARAMETER::SpinBox:
+                addFleetChanges(slot, before.GetInts(slot), after.GetInts(slot), diff.changes);
+                break;
+            case TYPE_PARAMETER::DoubleSpinBox:
+                addFleetChanges(slot, before.GetDoubles(slot), after.GetDoubles(slot), diff.changes);
+                break;
+        }
+    }
+    sortChanges(diff.changes);
+    return diff;
+}
+
+void appendDiffText(const ConfigDiff& diff, const ParameterStore& schema, std::string& out) {
+    for (const ConfigChange& change : diff.changes) {
+        const TYPE_PARAMETER type = schema.GetType(change.slot);
+        if (diff.is_fleet) {
+            out += "satellite ";
+            appendInteger(out, change.satellite + 1);
+            out += ": ";
+        }
+        appendString(out, schema.GetName(change.slot), false);
+        out += " has been changed from ";
+        appendValue(out, type, change.number_before, change.text_before, false);
+        out += " to ";
+        appendValue(out, type, change.number_after, change.text_after, false);
+        out += '\n';
+    }
+
+    if (diff.satellites_after > diff.satellites_before) {
+        appendInteger(out, diff.satellites_after - diff.satellites_before);
+        out += " satellites added\n";
+    } else if (diff.satellites_after < diff.satellites_before) {
+        appendInteger(out, diff.satellites_before - diff.satellites_after);
+        out += " satellites removed\n";
+    }
+}
+
+void appendDiffJson(const ConfigDiff& diff, const ParameterStore& schema, std::string& out) {
+    out += "{\"changes\":[";
+    for (size_t i = 0; i < diff.changes.size(); ++i) {
+        const ConfigChange& change = diff.changes[i];
+        const TYPE_PARAMETER type = schema.GetType(change.slot);
+        out += i == 0 ? "{" : ",{";
+        if (diff.is_fleet) {
+            out += "\"satellite\":";
+            appendInteger(out, change.satellite + 1);
+            out += ',';
+        }
+        out += "\"name\":\"";
+        appendString(out, schema.GetName(change.slot), true);
+        out += "\",\"before\":";
+        appendValue(out, type, change.number_before, change.text_before, true);
+        out += ",\"after\":";
+        appendValue(out, type, change.number_after, change.text_after, true);
+        out += '}';
+    }
+    out += ']';
+
+    if (diff.is_fleet) {
+        out += ",\"satellites_before\":";
+        appendInteger(out, diff.satellites_before);
+        out += ",\"satellites_after\":";
+        appendInteger(out, diff.satellites_after);
+    }
+    out += "}\n";
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Fleet.h"
+#include "ParameterStore.h"
+
+#include <QString>
+#include <string>
+#include <vector>
+
+// A parameter whose value differs between two configs or two fleets.
+struct ConfigChange {
+    // Satellite of a fleet, -1 for a single config.
+    int satellite;
+    int slot;
+    // Values of text parameters are in the strings, of any other kind in
+    // the numbers (bools as 0 or 1).
+    double number_before;
+    double number_after;
+    QString text_before;
+    QString text_after;
+};
+
+struct ConfigDiff {
+    // Ordered by satellite, then slot.
+    std::vector<ConfigChange> changes;
+
+    bool is_fleet = false;
+    // Satellites present in only one fleet are counted, not listed.
+    int satellites_before = 0;
+    int satellites_after = 0;
+
+    bool empty() const {
+        return changes.empty() && satellites_before == satellites_after;
+    }
+};
+
+// Compares the stored values of two configs of the same schema, value by
+// value as ParameterColumn::isChanged() does. Numeric columns are compared
+// in blocks first (memcmp for ints and bools, a vectorized loop for
+// doubles), so unchanged stretches cost a few cycles per value.
+ConfigDiff diffConfigs(const ParameterStore& before, const ParameterStore& after);
+
+// What a save would write: stored against modified values of one config.
+ConfigDiff diffModifiedValues(const ParameterStore& parameters);
+
+// Compares two fleets of the same schema column by column over the
+// satellites both have.
+ConfigDiff diffFleets(const Fleet& before, const Fleet& after);
+
+// Appends one "X has been changed from A to B" line per change (prefixed by
+// the satellite for fleets). Numbers are written in the shortest form that
+// reads back exactly; nothing is allocated beyond the growth of out.
+void appendDiffText(const ConfigDiff& diff, const ParameterStore& schema, std::string& out);
+
+// Appends the diff as a JSON object:
+// {"changes":[{"satellite":1,"name":"apogee","before":1000,"after":1200}],
+//  "satellites_before":3,"satellites_after":3}
+// where the satellite fields appear for fleets only.
+void appendDiffJson(const ConfigDiff& diff, const ParameterStore& schema, std::string& out);
@@ -0,0 +1,230 @@
+#include "ConfigDocument.h"
+#include "ConfigDiff.h"
+#include "ConfigJournal.h"
+#include "ConfigPatch.h"
+#include "DefaultParameters.h"
+#include "Trace.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <algorithm>
+#include <cmath>
+
+ConfigDocument::ConfigDocument(QString file_name, CONFIG_FORMAT format)
+    : ConfigDocument(std::move(file_name), createDefaultParameters(), format) {
+}
+
+ConfigDocument::ConfigDocument(QString file_name, ParameterStore defaults, CONFIG_FORMAT format)
+    : file_name_(std::move(file_name)), defaults_(std::move(defaults)) {
+    serializer_ = createSerializer(format == CONFIG_FORMAT::Auto ? formatForFile(file_name_) : format);
+    SetDefaultValues();
+    rules_.reset(new ParameterRules(createDefaultRules(parameters_)));
+}
+
+const QString& ConfigDocument::GetFileName() const {
+    return file_name_;
+}
+
+CONFIG_FORMAT ConfigDocument::GetFormat() const {
+    return serializer_->GetFormat();
+}
+
+ParameterStore& ConfigDocument::GetParameters() {
+    return parameters_;
+}
+
+const ParameterStore& ConfigDocument::GetParameters() const {
+    return parameters_;
+}
+
+ParameterRules& ConfigDocument::GetRules() {
+    return *rules_;
+}
+
+void ConfigDocument::SetDefaultValues() {
+    parameters_ = defaults_;
+}
+
+bool ConfigDocument::read(ParameterStore& parameters, ConfigError* error, bool* stale_journal) const {
+    bool ok = true;
+
+    // Если файла нет, остаются значения по умолчанию
+    if (QFile::exists(file_name_)) {
+        ok = serializer_->Load(file_name_, parameters, error);
+    }
+
+    // Изменения, сохранённые после последнего сжатия журнала
+    ConfigJournal journal(ConfigJournal::journalFileFor(file_name_));
+    *stale_journal = journal.IsStale(file_name_);
+    if (*stale_journal) {
+        qWarning("%s is older than %s, not replaying it", qPrintable(journal.GetFileName()), qPrintable(file_name_));
+        return ok;
+    }
+
+    ConfigError journal_error;
+    if (!journal.Replay(parameters, &journal_error)) {
+        if (ok && error) {
+            *error = journal_error;
+        }
+        ok = false;
+    }
+    return ok;
+}
+
+bool ConfigDocument::Load(ConfigError* error) {
+    TraceSpan span("ConfigDocument::Load");
+    bool ok = read(parameters_, error, &stale_journal_);
+
+    // Derived parameters follow the loaded values.
+    rules_->InvalidateAll();
+    rules_->Update(parameters_);
+    return ok;
+}
+
+bool ConfigDocument::Reload(std::vector<int>* changed, std::vector<int>* conflicts, ConfigError* error) {
+    ParameterStore disk = defaults_;
+    bool stale_journal = false;
+    if (!read(disk, error, &stale_journal)) {
+        return false;
+    }
+    stale_journal_ = stale_journal_ || stale_journal;
+
+    for (int slot = 0; slot < parameters_.size(); ++slot) {
+        const QVariant value = disk.GetValue(slot);
+        const QVariant stored = parameters_.GetValue(slot);
+        if (value == stored) {
+            continue;
+        }
+
+        const QVariant modified = parameters_.GetModifiedValue(slot);
+        if (modified == stored) {
+            parameters_.Apply(slot, value);
+            changed->push_back(slot);
+        } else {
+            parameters_.SetValue(slot, value);
+            if (modified != value) {
+                conflicts->push_back(slot);
+            }
+        }
+    }
+
+    rules_->InvalidateAll();
+    rules_->Update(parameters_, changed);
+    return true;
+}
+
+bool ConfigDocument::SetValue(const QString& name, const QVariant& value, std::vector<int>* changed,
+                              QString* message) {
+    ConfigPatch entry{{name, value}};
+    if (!checkConfigPatch(parameters_, entry, message)) {
+        return false;
+    }
+    const int slot = parameters_.Find(name);
+    if (rules_->IsDerived(slot)) {
+        if (message) {
+            *message = QString("%1 is derived from other parameters").arg(name);
+        }
+        return false;
+    }
+    SetValue(slot, entry.front().second, changed);
+    return true;
+}
+
+void ConfigDocument::SetValue(int slot, const QVariant& value, std::vector<int>* changed) {
+    parameters_.SetModifiedValue(slot, value);
+    Derive(slot, changed);
+}
+
+void ConfigDocument::SetValues(const std::vector<std::pair<int, QVariant>>& values, std::vector<int>* changed) {
+    for (const auto& value : values) {
+        parameters_.SetModifiedValue(value.first, value.second);
+        rules_->Invalidate(value.first);
+    }
+    rules_->Update(parameters_, changed);
+}
+
+void ConfigDocument::Derive(int slot, std::vector<int>* changed) {
+    rules_->Invalidate(slot);
+    rules_->Update(parameters_, changed);
+}
+
+std::vector<RuleViolation> ConfigDocument::GetViolations() const {
+    return rules_->GetViolations();
+}
+
+ConfigSnapshot ConfigDocument::CommitChanges(std::string* report) {
+    TraceSpan span("ConfigDocument::CommitChanges");
+    ConfigSnapshot changes;
+    const ConfigDiff diff = diffModifiedValues(parameters_);
+    if (diff.empty()) {
+        return changes;
+    }
+    if (report) {
+        appendDiffText(diff, parameters_, *report);
+    }
+
+    changes.reserve(diff.changes.size());
+    for (const ConfigChange& change : diff.changes) {
+        parameters_.Visit(change.slot, [&](auto& column, int index) {
+            column.Commit(index);
+            changes.push_back({column.names[index], column.kType, QVariant(column.GetValue(index))});
+        });
+    }
+    Trace::Count("parameters changed", static_cast<double>(changes.size()));
+    return changes;
+}
+
+bool ConfigDocument::Save(QString* message) {
+    TraceSpan span("ConfigDocument::Save");
+    if (!writeConfigFile(file_name_, GetFormat(), takeSnapshot(parameters_), message)) {
+        return false;
+    }
+
+    // A stale journal holds records the file does not contain.
+    ConfigJournal journal(ConfigJournal::journalFileFor(file_name_));
+    if (stale_journal_) {
+        QString kept_file;
+        if (!journal.KeepStale(&kept_file, message)) {
+            return false;
+        }
+        qWarning("Kept the superseded journal of %s as %s", qPrintable(file_name_), qPrintable(kept_file));
+        stale_journal_ = false;
+    } else if (!journal.Clear()) {
+        if (message) {
+            *message = QString("Could not clear %1").arg(journal.GetFileName());
+        }
+        return false;
+    }
+    return true;
+}
+
+bool ConfigDocument::HasStaleJournal() const {
+    return stale_journal_;
+}
+
+bool ConfigDocument::KeepStaleJournal(QString* kept_file, QString* message) {
+    if (!stale_journal_) {
+        return true;
+    }
+    ConfigJournal journal(ConfigJournal::journalFileFor(file_name_));
+    if (QFile::exists(journal.GetFileName()) && !journal.KeepStale(kept_file, message)) {
+        return false;
+    }
+    stale_journal_ = false;
+    return true;
+}
+
+QString ConfigDocument::unsavedFileFor(const QString& config_file) {
+    const QFileInfo info(config_file);
+    const QString base = info.path() + "/" + info.completeBaseName() + ".unsaved";
+    return info.suffix().isEmpty() ? base : base + "." + info.suffix();
+}
+
+bool ConfigDocument::SaveUnsaved(QString* message) const {
+    ConfigSnapshot snapshot;
+    snapshot.reserve(parameters_.size());
+    for (int slot = 0; slot < parameters_.size(); ++slot) {
+        snapshot.push_back({parameters_.GetName(slot), parameters_.GetType(slot), parameters_.GetModifiedValue(slot)});
+    }
+    return writeConfigFile(unsavedFileFor(file_name_), GetFormat(), snapshot, message);
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "ConfigReader.h"
+#include "ConfigSerializer.h"
+#include "ParameterRules.h"
+#include "ParameterStore.h"
+
+#include <QString>
+#include <QVariant>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// One config file with its parameters and orbit rules, without any widgets:
+// loading (base file plus journal), editing by name, collecting the changes
+// and writing the file back. MainWindow and the batch CLI are both built on
+// it.
+class ConfigDocument {
+    QString file_name_;
+    std::unique_ptr<ConfigSerializer> serializer_;
+
+    // Schema and default values; parameters_ starts as a copy of it.
+    ParameterStore defaults_;
+
+    ParameterStore parameters_;
+    // Refers to parameters_, so documents are neither copied nor moved.
+    std::unique_ptr<ParameterRules> rules_;
+
+    // Set when a load found a stale journal, until it is set aside.
+    bool stale_journal_ = false;
+
+    // Reads the file and its journal over the given values. A stale journal
+    // (see ConfigJournal::IsStale()) is neither replayed nor touched.
+    bool read(ParameterStore& parameters, ConfigError* error, bool* stale_journal) const;
+
+public:
+    explicit ConfigDocument(QString file_name, CONFIG_FORMAT format = CONFIG_FORMAT::Auto);
+
+    // A document over another schema than createDefaultParameters(); the
+    // orbit rules apply only if it has the parameters they refer to.
+    ConfigDocument(QString file_name, ParameterStore defaults, CONFIG_FORMAT format = CONFIG_FORMAT::Auto);
+
+    ConfigDocument(const ConfigDocument& other) = delete;
+
+    ConfigDocument& operator=(const ConfigDocument& other) = delete;
+
+    const QString& GetFileName() const;
+
+    CONFIG_FORMAT GetFormat() const;
+
+    ParameterStore& GetParameters();
+
+    const ParameterStore& GetParameters() const;
+
+    ParameterRules& GetRules();
+
+    void SetDefaultValues();
+
+    // Reads the config (defaults stay if it does not exist), replays its
+    // journal and derives dependent parameters. On error the values read so
+    // far are kept. A journal older than the config was superseded by a
+    // rewrite of the config by another process; it is not replayed, and
+    // HasStaleJournal() reports it. Loading never changes any file.
+    bool Load(ConfigError* error = nullptr);
+
+    // Re-reads the file after another process changed it and merges it into
+    // the current values: parameters without unsaved edits take the value on
+    // disk (appended to changed), edited ones keep the local value and only
+    // their stored value follows the disk. Edits that differ from the new
+    // disk value are appended to conflicts.
+    bool Reload(std::vector<int>* changed, std::vector<int>* conflicts, ConfigError* error = nullptr);
+
+    // Sets a modified value by name and re-derives the parameters depending
+    // on it. Slots the derivation changed are appended to changed. The value
+    // is converted to the type of the parameter as by checkConfigPatch();
+    // an unknown name, a value that is not of the type or out of bounds, and
+    // a derived parameter are rejected with message and change nothing.
+    bool SetValue(const QString& name, const QVariant& value, std::vector<int>* changed = nullptr,
+                  QString* message = nullptr);
+
+    void SetValue(int slot, const QVariant& value, std::vector<int>* changed = nullptr);
+
+    // Sets the modified values of several slots, as undo does, then
+    // re-derives the parameters depending on any of them. Slots the
+    // derivation changed are appended to changed.
+    void SetValues(const std::vector<std::pair<int, QVariant>>& values, std::vector<int>* changed = nullptr);
+
+    // Re-derives the parameters depending on a slot whose modified value was
+    // changed directly in its column (by an input widget).
+    void Derive(int slot, std::vector<int>* changed = nullptr);
+
+    std::vector<RuleViolation> GetViolations() const;
+
+    // Makes every modified value the stored one and returns the changed
+    // parameters; report gets one "X has been changed from A to B" line each.
+    ConfigSnapshot CommitChanges(std::string* report = nullptr);
+
+    // Writes every stored value to the file and drops the journal, whose
+    // records the file now contains. A stale journal is kept as by
+    // KeepStaleJournal() instead.
+    bool Save(QString* message = nullptr);
+
+    // Whether Load() or Reload() found a stale journal that has not been set
+    // aside yet. Saves appended to it would be replayed with its superseded
+    // records, so it must be set aside before anything else is journaled.
+    bool HasStaleJournal() const;
+
+    // Renames a stale journal as ConfigJournal::KeepStale() does; kept_file
+    // gets its new name.
+    bool KeepStaleJournal(QString* kept_file = nullptr, QString* message = nullptr);
+
+    // "config.unsaved.json" for "config.json": same directory and format.
+    static QString unsavedFileFor(const QString& config_file);
+
+    // Writes every modified value, rule violations included, to
+    // unsavedFileFor() and leaves the config and its journal alone. Keeps
+    // edits that cannot be saved when they would otherwise be lost.
+    bool SaveUnsaved(QString* message = nullptr) const;
+};
@@ -0,0 +1,501 @@
+#include "ConfigHistory.h"
+#include "ConfigJournal.h"
+#include "Trace.h"
+
+#include <QCborArray>
+#include <QCborMap>
+#include <QCborValue>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <algorithm>
+
+namespace {
+
+QByteArray hashOf(const QByteArray& data) {
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha256);
+}
+
+// Positions the reader on item `index` of the array it is at.
+bool enterArrayAt(QCborStreamReader& reader, int index) {
+    if (!reader.isArray() || !reader.enterContainer()) {
+        return false;
+    }
+    for (int i = 0; i < index; ++i) {
+        if (!reader.hasNext() || !reader.next()) {
+            return false;
+        }
+    }
+    return reader.hasNext();
+}
+
+// First slot of each chunk: a chunk per section, and one per
+// chunk_parameters slots within longer sections or outside any section.
+std::vector<int> chunkStarts(int size, const std::vector<ParameterSection>& sections, int chunk_parameters) {
+    std::vector<int> bounds{0};
+    for (const ParameterSection& section : sections) {
+        for (int bound : {section.begin, section.end}) {
+            if (bound > 0 && bound < size) {
+                bounds.push_back(bound);
+            }
+        }
+    }
+    std::sort(bounds.begin(), bounds.end());
+    bounds.erase(std::unique(bounds.begin(), bounds.end()), bounds.end());
+    bounds.push_back(size);
+
+    std::vector<int> starts;
+    for (size_t i = 0; i + 1 < bounds.size(); ++i) {
+        for (int start = bounds[i]; start < bounds[i + 1]; start += chunk_parameters) {
+            starts.push_back(start);
+        }
+    }
+    return starts;
+}
+
+// Index of the chunk holding the slot.
+int chunkOf(const std::vector<int>& starts, int slot) {
+    return static_cast<int>(std::upper_bound(starts.begin(), starts.end(), slot) - starts.begin()) - 1;
+}
+
+// Time, schema and chunks of a record of a version log.
+void readVersion(const QCborMap& record, ConfigVersion& version) {
+    version.time = record.value(QString("time")).toInteger();
+    version.schema = record.value(QString("schema")).toByteArray();
+    version.chunks.clear();
+    for (const QCborValue& hash : record.value(QString("chunks")).toArray()) {
+        version.chunks.push_back(hash.toByteArray());
+    }
+}
+
+}  // namespace
+
+ConfigHistory::ConfigHistory(QString directory) : directory_(std::move(directory)) {
+}
+
+QString ConfigHistory::defaultDirectoryFor(const QString& config_file) {
+    return QFileInfo(config_file).absolutePath() + "/.history";
+}
+
+const QString& ConfigHistory::GetDirectory() const {
+    return directory_;
+}
+
+QString ConfigHistory::objectPath(const QByteArray& hash) const {
+    const QString hex = QString::fromLatin1(hash.toHex());
+    return directory_ + "/objects/" + hex.left(2) + "/" + hex.mid(2);
+}
+
+QString ConfigHistory::logPath(const QString& config_file) const {
+    const QFileInfo info(config_file);
+    const QByteArray path_hash = hashOf(info.absoluteFilePath().toUtf8()).toHex().left(8);
+    return directory_ + "/versions/" + info.fileName() + "-" + QString::fromLatin1(path_hash) + ".log";
+}
+
+bool ConfigHistory::storeObject(const QByteArray& data, QByteArray& hash, QString* message) {
+    hash = hashOf(data);
+    const QString path = objectPath(hash);
+    if (QFile::exists(path)) {
+        return true;
+    }
+    if (!QDir().mkpath(QFileInfo(path).absolutePath())) {
+        if (message) {
+            *message = QString("Could not create the directory of %1").arg(path);
+        }
+        return false;
+    }
+
+    // Writers of the same object in other processes write the same bytes,
+    // so whichever rename lands last is as good as the first.
+    const QByteArray compressed = qCompress(data);
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(compressed) != compressed.size() || !file.commit()) {
+        if (message) {
+            *message = file.errorString();
+        }
+        return false;
+    }
+    Trace::Count("bytes written", compressed.size());
+    return true;
+}
+
+bool ConfigHistory::loadObject(const QByteArray& hash, QByteArray& data, QString* message) const {
+    auto it = objects_.constFind(hash);
+    if (it != objects_.constEnd()) {
+        data = it.value();
+        return true;
+    }
+
+    QFile file(objectPath(hash));
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (message) {
+            *message = QString("Missing object %1").arg(QString::fromLatin1(hash.toHex()));
+        }
+        return false;
+    }
+    const QByteArray compressed = file.readAll();
+    Trace::Count("bytes read", compressed.size());
+    data = qUncompress(compressed);
+    if (data.isEmpty()) {
+        if (message) {
+            *message = QString("Corrupt object %1").arg(QString::fromLatin1(hash.toHex()));
+        }
+        return false;
+    }
+
+    if (cached_bytes_ + data.size() > kCacheBytes) {
+        objects_.clear();
+        cached_bytes_ = 0;
+    }
+    objects_.insert(hash, data);
+    cached_bytes_ += data.size();
+    return true;
+}
+
+const ConfigHistory::Schema* ConfigHistory::loadSchema(const QByteArray& hash, QString* message) const {
+    auto it = schemas_.constFind(hash);
+    if (it != schemas_.constEnd()) {
+        return &it.value();
+    }
+
+    QByteArray data;
+    if (!loadObject(hash, data, message)) {
+        return nullptr;
+    }
+    // {"fields": [name, type, ...], "chunks": [first slot, ...]}. Histories
+    // written before chunks followed sections hold just the fields, chunked
+    // every 256 slots.
+    const QCborValue root = QCborValue::fromCbor(data);
+    const QCborArray fields = root.isArray() ? root.toArray() : root.toMap().value(QString("fields")).toArray();
+    Schema schema;
+    bool valid = (root.isArray() || root.isMap()) && fields.size() % 2 == 0;
+    for (qsizetype i = 0; valid && i < fields.size(); i += 2) {
+        valid = fields.at(i).isString() && fields.at(i + 1).isInteger();
+        if (valid) {
+            schema.fields.push_back({fields.at(i).toString(),
+                                     static_cast<TYPE_PARAMETER>(fields.at(i + 1).toInteger())});
+        }
+    }
+    const int size = static_cast<int>(schema.fields.size());
+    if (root.isArray()) {
+        for (int start = 0; start < size; start += 256) {
+            schema.starts.push_back(start);
+        }
+    } else {
+        for (const QCborValue& start : root.toMap().value(QString("chunks")).toArray()) {
+            const qint64 value = start.toInteger(-1);
+            valid = valid && value >= (schema.starts.empty() ? 0 : schema.starts.back() + 1) && value < size &&
+                    (!schema.starts.empty() || value == 0);
+            schema.starts.push_back(static_cast<int>(value));
+        }
+        valid = valid && (size == 0) == schema.starts.empty();
+    }
+    if (!valid) {
+        if (message) {
+            *message = QString("Corrupt schema %1").arg(QString::fromLatin1(hash.toHex()));
+        }
+        return nullptr;
+    }
+    return &schemas_.insert(hash, std::move(schema)).value();
+}
+
+QByteArray ConfigHistory::encodeChunk(const ConfigSnapshot& snapshot, int begin, int end) {
+    QByteArray data;
+    QCborStreamWriter writer(&data);
+    writer.startArray(end - begin);
+    for (int slot = begin; slot < end; ++slot) {
+        writeCborValue(writer, snapshot[slot].type, snapshot[slot].value);
+    }
+    writer.endArray();
+    return data;
+}
+
+bool ConfigHistory::Commit(const QString& config_file, const ConfigSnapshot& snapshot,
+                           const std::vector<ParameterSection>& sections, QString* message,
+                           const std::vector<int>* changed_slots) {
+    TraceSpan span("ConfigHistory::Commit");
+    const QString log_path = logPath(config_file);
+    const int size = static_cast<int>(snapshot.size());
+    const std::vector<int> starts = chunkStarts(size, sections, kChunkParameters);
+    const int chunk_count = static_cast<int>(starts.size());
+
+    auto cached = heads_.constFind(log_path);
+    const bool incremental = changed_slots && cached != heads_.constEnd() && cached->starts == starts;
+    Head head;
+    std::vector<char> dirty(chunk_count, !incremental);
+    if (incremental) {
+        head = cached.value();
+        for (int slot : *changed_slots) {
+            if (slot >= 0 && slot < size) {
+                dirty[chunkOf(starts, slot)] = true;
+            }
+        }
+    } else {
+        QByteArray schema;
+        QCborStreamWriter writer(&schema);
+        writer.startMap(2);
+        writer.append(QLatin1String("fields"));
+        writer.startArray(2 * snapshot.size());
+        for (const ConfigValue& value : snapshot) {
+            writer.append(value.name);
+            writer.append(static_cast<int>(value.type));
+        }
+        writer.endArray();
+        writer.append(QLatin1String("chunks"));
+        writer.startArray(starts.size());
+        for (int start : starts) {
+            writer.append(start);
+        }
+        writer.endArray();
+        writer.endMap();
+        if (!storeObject(schema, head.schema, message)) {
+            return false;
+        }
+        head.starts = starts;
+        head.chunks.resize(chunk_count);
+    }
+    for (int chunk = 0; chunk < chunk_count; ++chunk) {
+        const int end = chunk + 1 < chunk_count ? starts[chunk + 1] : size;
+        if (dirty[chunk] && !storeObject(encodeChunk(snapshot, starts[chunk], end), head.chunks[chunk], message)) {
+            return false;
+        }
+    }
+
+    heads_.insert(log_path, head);
+
+    // One write per record, so a crash can only tear the last one, which is
+    // cut off before the next record is appended. Only the records other
+    // processes appended since the last commit of this one are read.
+    QDir().mkpath(QFileInfo(log_path).absolutePath());
+    QFile file(log_path);
+    Tail tail = tails_.value(log_path);
+    if (QFileInfo(log_path).size() < tail.end) {
+        tail = Tail();
+    }
+    std::vector<QByteArray> records;
+    if (!openCborLog(file, message, tail.end, &records)) {
+        heads_.remove(log_path);
+        tails_.remove(log_path);
+        return false;
+    }
+    if (!records.empty()) {
+        readVersion(QCborValue::fromCbor(records.back()).toMap(), tail.last);
+    }
+    tail.end = file.pos();
+
+    // A save that changed nothing, or a reload of the committed state, is
+    // not a new version. The head is the last record of the log rather than
+    // the last commit of this process, which another process may have
+    // followed with its own.
+    if (tail.last.schema == head.schema && tail.last.chunks == head.chunks) {
+        tails_.insert(log_path, tail);
+        return true;
+    }
+
+    QCborArray chunks;
+    for (const QByteArray& hash : head.chunks) {
+        chunks.append(hash);
+    }
+    QCborMap record;
+    const qint64 time = QDateTime::currentMSecsSinceEpoch();
+    record.insert(QString("time"), time);
+    record.insert(QString("schema"), head.schema);
+    record.insert(QString("chunks"), chunks);
+    const QByteArray bytes = record.toCborValue().toCbor();
+
+    if (file.write(bytes) != bytes.size() || !file.flush()) {
+        if (message) {
+            *message = file.errorString();
+        }
+        heads_.remove(log_path);
+        tails_.remove(log_path);
+        return false;
+    }
+    Trace::Count("bytes written", bytes.size());
+    tail.end += bytes.size();
+    tail.last.time = time;
+    tail.last.schema = head.schema;
+    tail.last.chunks = head.chunks;
+    tails_.insert(log_path, tail);
+    return true;
+}
+
+bool ConfigHistory::GetVersions(const QString& config_file, std::vector<ConfigVersion>& versions,
+                                QString* message) const {
+    versions.clear();
+    QFile file(logPath(config_file));
+    if (!file.exists()) {
+        return true;
+    }
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (message) {
+            *message = file.errorString();
+        }
+        return false;
+    }
+    const QByteArray data = file.readAll();
+    Trace::Count("bytes read", data.size());
+
+    QCborStreamReader reader(data);
+    while (reader.isMap()) {
+        const QCborMap record = QCborValue::fromCbor(reader).toMap();
+        if (reader.lastError() != QCborError::NoError) {
+            qWarning("Ignoring a torn record at the end of %s", qPrintable(file.fileName()));
+            break;
+        }
+        ConfigVersion version;
+        version.number = static_cast<int>(versions.size());
+        readVersion(record, version);
+        versions.push_back(std::move(version));
+    }
+    return true;
+}
+
+bool ConfigHistory::LoadVersion(const ConfigVersion& version, ConfigSnapshot& snapshot, QString* message,
+                                std::vector<ParameterSection>* sections) const {
+    TraceSpan span("ConfigHistory::LoadVersion");
+    snapshot.clear();
+    const Schema* schema = loadSchema(version.schema, message);
+    if (!schema) {
+        return false;
+    }
+    const std::vector<Field>& fields = schema->fields;
+    if (version.chunks.size() != schema->starts.size()) {
+        if (message) {
+            *message = QString("Version %1 is missing values").arg(version.number);
+        }
+        return false;
+    }
+    snapshot.reserve(fields.size());
+
+    QByteArray data;
+    for (size_t chunk = 0; chunk < version.chunks.size(); ++chunk) {
+        if (!loadObject(version.chunks[chunk], data, message)) {
+            return false;
+        }
+        const size_t end = chunk + 1 < schema->starts.size() ? schema->starts[chunk + 1] : fields.size();
+        QCborStreamReader reader(data);
+        bool valid = reader.isArray() && reader.enterContainer();
+        while (valid && reader.hasNext() && snapshot.size() < end) {
+            const Field& field = fields[snapshot.size()];
+            QVariant value;
+            valid = readCborValue(reader, field.type, value);
+            snapshot.push_back({field.name, field.type, std::move(value)});
+        }
+        if (!valid || snapshot.size() != end) {
+            if (message) {
+                *message = QString("Corrupt object %1").arg(QString::fromLatin1(version.chunks[chunk].toHex()));
+            }
+            return false;
+        }
+    }
+
+    if (sections) {
+        sections->clear();
+        for (size_t chunk = 0; chunk < schema->starts.size(); ++chunk) {
+            const int end = chunk + 1 < schema->starts.size() ? schema->starts[chunk + 1]
+                                                               : static_cast<int>(fields.size());
+            sections->push_back({QString(), schema->starts[chunk], end});
+        }
+    }
+    return true;
+}
+
+bool ConfigHistory::GetParameterHistory(const QString& config_file, const QString& name,
+                                        std::vector<ParameterVersion>& history, QString* message) const {
+    TraceSpan span("ConfigHistory::GetParameterHistory");
+    history.clear();
+    std::vector<ConfigVersion> versions;
+    if (!GetVersions(config_file, versions, message)) {
+        return false;
+    }
+
+    // Slot of the parameter per schema, -1 where it does not exist.
+    QHash<QByteArray, int> slots_by_schema;
+    QByteArray last_chunk;
+    QByteArray data;
+    for (const ConfigVersion& version : versions) {
+        const Schema* schema = loadSchema(version.schema, message);
+        if (!schema) {
+            return false;
+        }
+        auto found = slots_by_schema.constFind(version.schema);
+        if (found == slots_by_schema.constEnd()) {
+            int slot = -1;
+            for (size_t i = 0; i < schema->fields.size() && slot < 0; ++i) {
+                if (schema->fields[i].name == name) {
+                    slot = static_cast<int>(i);
+                }
+            }
+            found = slots_by_schema.insert(version.schema, slot);
+        }
+        const int slot = found.value();
+        const int chunk = slot < 0 ? -1 : chunkOf(schema->starts, slot);
+        if (chunk < 0 || chunk >= static_cast<int>(version.chunks.size())) {
+            last_chunk.clear();
+            continue;
+        }
+        // An unchanged chunk holds an unchanged value.
+        if (version.chunks[chunk] == last_chunk) {
+            continue;
+        }
+        last_chunk = version.chunks[chunk];
+
+        if (!loadObject(last_chunk, data, message)) {
+            return false;
+        }
+        QCborStreamReader reader(data);
+        QVariant value;
+        const TYPE_PARAMETER type = schema->fields[slot].type;
+        if (!enterArrayAt(reader, slot - schema->starts[chunk]) || !readCborValue(reader, type, value)) {
+            if (message) {
+                *message = QString("Corrupt object %1").arg(QString::fromLatin1(last_chunk.toHex()));
+            }
+            return false;
+        }
+        if (history.empty() || history.back().value != value) {
+            history.push_back({version.number, version.time, std::move(value)});
+        }
+    }
+    return true;
+}
+
+qint64 ConfigHistory::GetStoredBytes() const {
+    qint64 bytes = 0;
+    QDirIterator it(directory_ + "/objects", QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        bytes += it.fileInfo().size();
+    }
+    return bytes;
+}
+
+bool restoreConfigVersion(ConfigHistory& history, const QString& config_file, const ConfigVersion& version,
+                          QString* message) {
+    TraceSpan span("restoreConfigVersion");
+    ConfigSnapshot snapshot;
+    std::vector<ParameterSection> sections;
+    if (!history.LoadVersion(version, snapshot, message, &sections)) {
+        return false;
+    }
+
+    // The journal holds changes on top of the replaced file unless it is
+    // already stale, which the rewrite would hide, so tell before writing.
+    ConfigJournal journal(ConfigJournal::journalFileFor(config_file));
+    const bool replaced_journal = QFile::exists(journal.GetFileName()) && !journal.IsStale(config_file);
+    if (!writeConfigFile(config_file, formatForFile(config_file), snapshot, message) ||
+        !history.Commit(config_file, snapshot, sections, message)) {
+        return false;
+    }
+    if (replaced_journal && !journal.Clear()) {
+        if (message) {
+            *message = QString("Could not remove %1").arg(journal.GetFileName());
+        }
+        return false;
+    }
+    return true;
+}
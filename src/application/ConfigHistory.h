@@ -0,0 +1,141 @@
+#pragma once
+
+#include "ConfigSerializer.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QVariant>
+#include <vector>
+
+// One committed state of a config.
+struct ConfigVersion {
+    // Position in the history of the config, from 0.
+    int number;
+    // Milliseconds since the epoch.
+    qint64 time;
+    // Hash of the names and types object.
+    QByteArray schema;
+    // Hash of the values of each chunk, in slot order.
+    std::vector<QByteArray> chunks;
+};
+
+// Value of one parameter from the version that set it on.
+struct ParameterVersion {
+    int number;
+    qint64 time;
+    QVariant value;
+};
+
+// Every committed version of the configs of a directory, content-addressed:
+// the values of a version are split into chunks, one per section of the
+// schema (sections longer than kChunkParameters slots are split further),
+// and each chunk is stored once, compressed, under the SHA-256 of its
+// content ("objects/ab/cdef..."). The schema object holds the names, types
+// and chunk boundaries. A version is a record of chunk hashes appended to
+// the log of its config ("versions/config.json-0123abcd.log"), so a save
+// stores only the sections it changed, and configs of a fleet that share
+// most values share most chunks.
+//
+// Restoring a version decompresses its chunks; the history of one parameter
+// decompresses only the chunk holding it, and only in the versions where
+// that chunk changed.
+//
+// Not thread-safe; any number of processes may share a directory.
+class ConfigHistory {
+    struct Head {
+        QByteArray schema;
+        // First slot of each chunk.
+        std::vector<int> starts;
+        std::vector<QByteArray> chunks;
+    };
+
+    // End of the last complete record of a log and that record, so a commit
+    // reads only what other processes appended since. Logs only grow; one
+    // shorter than the end is read again from the start.
+    struct Tail {
+        qint64 end = 0;
+        ConfigVersion last;
+    };
+
+    struct Field {
+        QString name;
+        TYPE_PARAMETER type;
+    };
+
+    struct Schema {
+        std::vector<Field> fields;
+        std::vector<int> starts;
+    };
+
+    QString directory_;
+
+    // Last version committed by this process per config, so the next commit
+    // re-hashes only the chunks with changed slots.
+    QHash<QString, Head> heads_;
+
+    QHash<QString, Tail> tails_;
+
+    // Decompressed objects and decoded schemas, dropped past kCacheBytes.
+    mutable QHash<QByteArray, QByteArray> objects_;
+    mutable qint64 cached_bytes_ = 0;
+    mutable QHash<QByteArray, Schema> schemas_;
+
+    QString objectPath(const QByteArray& hash) const;
+
+    QString logPath(const QString& config_file) const;
+
+    // Stores the compressed data unless an object of that hash exists.
+    bool storeObject(const QByteArray& data, QByteArray& hash, QString* message);
+
+    bool loadObject(const QByteArray& hash, QByteArray& data, QString* message) const;
+
+    const Schema* loadSchema(const QByteArray& hash, QString* message) const;
+
+    static QByteArray encodeChunk(const ConfigSnapshot& snapshot, int begin, int end);
+
+public:
+    static const int kChunkParameters = 64;
+
+    static const qint64 kCacheBytes = 64 * 1024 * 1024;
+
+    explicit ConfigHistory(QString directory);
+
+    // ".history" next to the config, shared by the configs of its directory.
+    static QString defaultDirectoryFor(const QString& config_file);
+
+    const QString& GetDirectory() const;
+
+    // Adds the values as the newest version of the config unless they equal
+    // it, chunked along the sections of the schema (one chunk of
+    // kChunkParameters slots after another without sections). changed_slots
+    // (if given) are the only slots that differ from the previous commit of
+    // this process; other chunks are not re-hashed.
+    bool Commit(const QString& config_file, const ConfigSnapshot& snapshot,
+                const std::vector<ParameterSection>& sections, QString* message = nullptr,
+                const std::vector<int>* changed_slots = nullptr);
+
+    // Oldest first. A record torn by a crash at the end of the log is skipped.
+    bool GetVersions(const QString& config_file, std::vector<ConfigVersion>& versions,
+                     QString* message = nullptr) const;
+
+    // sections (if given) gets one untitled section per chunk, to commit the
+    // values again with the same chunks.
+    bool LoadVersion(const ConfigVersion& version, ConfigSnapshot& snapshot, QString* message = nullptr,
+                     std::vector<ParameterSection>* sections = nullptr) const;
+
+    // The value of the parameter in the first version and in every later one
+    // that changed it.
+    bool GetParameterHistory(const QString& config_file, const QString& name, std::vector<ParameterVersion>& history,
+                             QString* message = nullptr) const;
+
+    // Bytes of the compressed objects on disk.
+    qint64 GetStoredBytes() const;
+};
+
+// Rewrites the config with the values of a version and commits that as the
+// newest version. The journal of the replaced state is removed only after
+// both succeeded; one that was already stale is left for loading to set
+// aside, and one left behind by a failed commit is stale by then.
+bool restoreConfigVersion(ConfigHistory& history, const QString& config_file, const ConfigVersion& version,
+                          QString* message = nullptr);
@@ -0,0 +1,149 @@
+#include "ConfigJournal.h"
+#include "Trace.h"
+
+#include <QFile>
+#include <QFileInfo>
+
+ConfigJournal::ConfigJournal(QString file_name) : file_name_(std::move(file_name)) {}
+
+QString ConfigJournal::journalFileFor(const QString& config_file) {
+    return config_file + ".journal";
+}
+
+const QString& ConfigJournal::GetFileName() const {
+    return file_name_;
+}
+
+qint64 ConfigJournal::GetSize() const {
+    QFile file(file_name_);
+    return file.exists() ? file.size() : 0;
+}
+
+bool ConfigJournal::Append(const ConfigSnapshot& changes, QString* message) {
+    TraceSpan span("append journal");
+    QByteArray record;
+    QCborStreamWriter writer(&record);
+
+    writer.startMap(changes.size());
+    for (const auto& value : changes) {
+        writeCborValue(writer, value);
+    }
+    writer.endMap();
+
+    // One write per record, so a crash can only tear the last one, which is
+    // cut off before the next record is appended.
+    QFile file(file_name_);
+    if (!openCborLog(file, message)) {
+        return false;
+    }
+    if (file.write(record) != record.size() || !file.flush()) {
+        if (message) {
+            *message = file.errorString();
+        }
+        return false;
+    }
+    Trace::Count("bytes written", record.size());
+    return true;
+}
+
+bool ConfigJournal::Clear() {
+    return !QFile::exists(file_name_) || QFile::remove(file_name_);
+}
+
+bool ConfigJournal::IsStale(const QString& config_file) const {
+    const QFileInfo config_info(config_file);
+    const QFileInfo journal_info(file_name_);
+    return config_info.exists() && journal_info.exists() && journal_info.lastModified() < config_info.lastModified();
+}
+
+bool ConfigJournal::KeepStale(QString* kept_file, QString* message) {
+    QString target = file_name_ + ".stale";
+    for (int i = 1; QFile::exists(target); ++i) {
+        target = QString("%1.stale%2").arg(file_name_).arg(i);
+    }
+    if (!QFile::rename(file_name_, target)) {
+        if (message) {
+            *message = QString("Could not rename %1 to %2").arg(file_name_, target);
+        }
+        return false;
+    }
+    if (kept_file) {
+        *kept_file = target;
+    }
+    return true;
+}
+
+bool ConfigJournal::Replay(ParameterStore& parameters, ConfigError* error) const {
+    TraceSpan span("replay journal");
+    QFile file(file_name_);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        return true;
+    }
+
+    const qint64 size = file.size();
+    if (size == 0) {
+        return true;
+    }
+    Trace::Count("bytes read", size);
+    const uchar* data = file.map(0, size);
+    if (!data) {
+        if (error) {
+            *error = ConfigError{-1, QString("Could not map %1").arg(file_name_)};
+        }
+        return false;
+    }
+
+    std::vector<QVariant> values(parameters.size());
+    QCborStreamReader reader(reinterpret_cast<const char*>(data), size);
+    QString key;
+
+    while (reader.isMap()) {
+        qint64 record_offset = reader.currentOffset();
+        bool valid = reader.enterContainer();
+
+        for (auto& value : values) {
+            value = QVariant();
+        }
+        while (valid && reader.lastError() == QCborError::NoError && reader.hasNext()) {
+            if (!reader.isString() || !readCborString(reader, key)) {
+                valid = false;
+                break;
+            }
+
+            int slot = parameters.Find(key);
+            if (slot < 0) {
+                valid = reader.next();
+            } else {
+                valid = readCborValue(reader, parameters.GetType(slot), values[slot]);
+            }
+        }
+        valid = valid && reader.lastError() == QCborError::NoError && reader.leaveContainer();
+
+        if (!valid) {
+            if (reader.lastError() == QCborError::EndOfFile) {
+                qWarning("Ignoring a torn record at the end of %s", qPrintable(file_name_));
+                return true;
+            }
+            if (error) {
+                *error = ConfigError{record_offset, "invalid journal record"};
+            }
+            return false;
+        }
+
+        for (int slot = 0; slot < parameters.size(); ++slot) {
+            if (values[slot].isValid()) {
+                parameters.Apply(slot, values[slot]);
+            }
+        }
+    }
+
+    if (reader.lastError() != QCborError::NoError && reader.lastError() != QCborError::EndOfFile) {
+        if (error) {
+            *error = ConfigError{reader.currentOffset(), reader.lastError().toString()};
+        }
+        return false;
+    }
+
+    return true;
+}
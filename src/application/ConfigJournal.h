@@ -0,0 +1,42 @@
+#pragma once
+
+#include "ConfigReader.h"
+#include "ConfigSerializer.h"
+
+#include <QString>
+#include <vector>
+
+// Append-only log of parameter changes kept next to the base config
+// ("config.json.journal"). Every save appends one CBOR map holding only the
+// changed parameters; loading replays the records over the base config.
+class ConfigJournal {
+    QString file_name_;
+
+public:
+    explicit ConfigJournal(QString file_name);
+
+    static QString journalFileFor(const QString& config_file);
+
+    const QString& GetFileName() const;
+
+    qint64 GetSize() const;
+
+    // Appends one record, after cutting off a record torn by a crash.
+    bool Append(const ConfigSnapshot& changes, QString* message = nullptr);
+
+    bool Clear();
+
+    // Whether the journal is older than the config, whose rewrite by another
+    // process then superseded its records. Such a journal is not replayed,
+    // nor appended to or cleared before KeepStale() set it aside.
+    bool IsStale(const QString& config_file) const;
+
+    // Renames a stale journal to "config.json.journal.stale" (or ".stale1",
+    // ".stale2"... if taken), so that saves start a new journal while the
+    // superseded records stay on disk for the user.
+    bool KeepStale(QString* kept_file = nullptr, QString* message = nullptr);
+
+    // Applies every complete record in order. A record cut short by a crash
+    // at the end of the file is skipped with a warning.
+    bool Replay(ParameterStore& parameters, ConfigError* error = nullptr) const;
+};
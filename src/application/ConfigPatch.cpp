@@ -0,0 +1,156 @@
+#include "ConfigPatch.h"
+#include "ConfigDocument.h"
+
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonParseError>
+#include <cmath>
+
+bool loadConfigPatch(const QString& file_name, ConfigPatch& patch, ConfigError* error) {
+    QFile file(file_name);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) {
+            *error = ConfigError{-1, QString("Could not open %1").arg(file_name)};
+        }
+        return false;
+    }
+
+    QJsonParseError parse_error;
+    QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &parse_error);
+    if (parse_error.error != QJsonParseError::NoError || !document.isObject()) {
+        if (error) {
+            *error = parse_error.error != QJsonParseError::NoError
+                     ? ConfigError{parse_error.offset, parse_error.errorString()}
+                     : ConfigError{0, "Expected an object"};
+        }
+        return false;
+    }
+
+    QJsonObject object = document.object();
+    for (const QString& name : object.keys()) {
+        patch.emplace_back(name, object.value(name).toVariant());
+    }
+    return true;
+}
+
+bool parseConfigPatchEntry(const QString& text, ConfigPatch& patch) {
+    int separator = text.indexOf("=");
+    if (separator <= 0) {
+        return false;
+    }
+    patch.emplace_back(text.left(separator), QVariant(text.mid(separator + 1)));
+    return true;
+}
+
+namespace {
+
+// The value as the type of a slot, or an invalid QVariant.
+QVariant convertPatchValue(const ParameterStore& parameters, int slot, const QVariant& value) {
+    const bool is_text = value.userType() == QMetaType::QString;
+    const bool is_bool = value.userType() == QMetaType::Bool;
+    bool ok = !value.isNull();
+    switch (parameters.GetType(slot)) {
+        case TYPE_PARAMETER::LineEdit:
+            return ok && !is_bool ? QVariant(value.toString()) : QVariant();
+        case TYPE_PARAMETER::CheckBox: {
+            if (is_bool) {
+                return value;
+            }
+            const QString text = value.toString().trimmed().toLower();
+            if (text == "true" || text == "1") {
+                return QVariant(true);
+            }
+            if (text == "false" || text == "0") {
+                return QVariant(false);
+            }
+            return QVariant();
+        }
+        case TYPE_PARAMETER::SpinBox: {
+            const double number = is_text ? value.toString().trimmed().toDouble(&ok) : value.toDouble(&ok);
+            const IntSpinBoxColumn& column = parameters.GetColumn<IntSpinBoxColumn>();
+            const int index = parameters.GetSlot(slot).index;
+            if (!ok || is_bool || number != std::floor(number) || number < column.mins[index] ||
+                number > column.maxs[index]) {
+                return QVariant();
+            }
+            return QVariant(static_cast<int>(number));
+        }
+        case TYPE_PARAMETER::DoubleSpinBox:
+            break;
+    }
+    const double number = is_text ? value.toString().trimmed().toDouble(&ok) : value.toDouble(&ok);
+    const DoubleSpinBoxColumn& column = parameters.GetColumn<DoubleSpinBoxColumn>();
+    const int index = parameters.GetSlot(slot).index;
+    if (!ok || is_bool || !(number >= column.mins[index] && number <= column.maxs[index])) {
+        return QVariant();
+    }
+    return QVariant(number);
+}
+
+}  // namespace
+
+bool checkConfigPatch(const ParameterStore& parameters, ConfigPatch& patch, QString* message) {
+    for (auto& entry : patch) {
+        const int slot = parameters.Find(entry.first);
+        if (slot < 0) {
+            if (message) {
+                *message = QString("Unknown parameter %1").arg(entry.first);
+            }
+            return false;
+        }
+        QVariant converted = convertPatchValue(parameters, slot, entry.second);
+        if (!converted.isValid()) {
+            if (message) {
+                *message = QString("%1 is not a valid value of %2").arg(entry.second.toString(), entry.first);
+            }
+            return false;
+        }
+        entry.second = std::move(converted);
+    }
+    return true;
+}
+
+bool applyConfigPatch(const QString& config_file, const ConfigPatch& patch, bool* changed, QString* message) {
+    ConfigDocument document(config_file);
+
+    ConfigError error;
+    if (!document.Load(&error)) {
+        if (message) {
+            *message = error.toString();
+        }
+        return false;
+    }
+
+    // Every value is checked before the first one is set.
+    ConfigPatch values = patch;
+    if (!checkConfigPatch(document.GetParameters(), values, message)) {
+        return false;
+    }
+    for (const auto& entry : values) {
+        if (document.GetRules().IsDerived(document.GetParameters().Find(entry.first))) {
+            if (message) {
+                *message = QString("%1 is derived from other parameters").arg(entry.first);
+            }
+            return false;
+        }
+    }
+    for (const auto& entry : values) {
+        document.SetValue(entry.first, entry.second);
+    }
+
+    std::vector<RuleViolation> violations = document.GetViolations();
+    if (!violations.empty()) {
+        if (message) {
+            *message = violations.front().message;
+        }
+        return false;
+    }
+
+    ConfigSnapshot changes = document.CommitChanges();
+    if (changed) {
+        *changed = !changes.empty();
+    }
+    return changes.empty() || document.Save(message);
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "ConfigReader.h"
+#include "ParameterStore.h"
+
+#include <QString>
+#include <QVariant>
+#include <utility>
+#include <vector>
+
+// Parameter values to set in a config, by name, in the order given.
+typedef std::vector<std::pair<QString, QVariant>> ConfigPatch;
+
+// Reads a patch from a JSON object of name to value.
+bool loadConfigPatch(const QString& file_name, ConfigPatch& patch, ConfigError* error = nullptr);
+
+// Parses "name=value" into a patch entry.
+bool parseConfigPatchEntry(const QString& text, ConfigPatch& patch);
+
+// Converts every value of the patch to the type of its parameter. Fails on
+// the first unknown name, value that is not of the type (text for a number,
+// a fraction for an int, anything but true/false/1/0 for a bool) or number
+// outside the bounds of its parameter, leaving the patch unusable.
+bool checkConfigPatch(const ParameterStore& parameters, ConfigPatch& patch, QString* message = nullptr);
+
+// Loads a config (with its journal), applies the patch and, if anything
+// changed, rewrites the config. Values that checkConfigPatch() rejects,
+// derived parameters and configs that break the orbit rules leave the file
+// untouched.
+bool applyConfigPatch(const QString& config_file, const ConfigPatch& patch, bool* changed = nullptr,
+                      QString* message = nullptr);
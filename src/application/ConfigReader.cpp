@@ -0,0 +1,488 @@
+#include "ConfigReader.h"
+#include "Trace.h"
+
+#include <QFile>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+void appendUtf8(QByteArray& out, uint code_point) {
+    if (code_point < 0x80) {
+        out.append(static_cast<char>(code_point));
+    } else if (code_point < 0x800) {
+        out.append(static_cast<char>(0xC0 | (code_point >> 6)));
+        out.append(static_cast<char>(0x80 | (code_point & 0x3F)));
+    } else if (code_point < 0x10000) {
+        out.append(static_cast<char>(0xE0 | (code_point >> 12)));
+        out.append(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        out.append(static_cast<char>(0x80 | (code_point & 0x3F)));
+    } else {
+        out.append(static_cast<char>(0xF0 | (code_point >> 18)));
+        out.append(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+        out.append(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+        out.append(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+}
+
+int hexDigit(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+}  // namespace
+
+QString ConfigError::toString() const {
+    if (offset < 0) {
+        return message;
+    }
+    return QString("%1 at byte %2").arg(message).arg(offset);
+}
+
+JsonStreamReader::JsonStreamReader(const char* data, qint64 size) : begin_(data), pos_(data), end_(data + size) {}
+
+void JsonStreamReader::skipWhitespace() {
+    while (pos_ != end_ && (*pos_ == ' ' || *pos_ == '\n' || *pos_ == '\r' || *pos_ == '\t')) {
+        ++pos_;
+    }
+}
+
+bool JsonStreamReader::fail(const char* message) {
+    if (!failed_) {
+        failed_ = true;
+        error_.offset = pos_ - begin_;
+        error_.message = message;
+    }
+    return false;
+}
+
+bool JsonStreamReader::expect(char c, const char* message) {
+    if (failed_) {
+        return false;
+    }
+    skipWhitespace();
+    if (pos_ == end_ || *pos_ != c) {
+        return fail(message);
+    }
+    ++pos_;
+    return true;
+}
+
+bool JsonStreamReader::next(char close, const char* message) {
+    if (failed_ || first_.empty()) {
+        return fail("unexpected value");
+    }
+    skipWhitespace();
+    if (pos_ == end_) {
+        return fail("unexpected end of input");
+    }
+    if (*pos_ == close) {
+        ++pos_;
+        first_.pop_back();
+        return false;
+    }
+    if (first_.back()) {
+        first_.back() = false;
+        return true;
+    }
+    if (*pos_ != ',') {
+        return fail(message);
+    }
+    ++pos_;
+    return true;
+}
+
+bool JsonStreamReader::readRawString(QByteArray& value) {
+    if (!expect('"', "expected a string")) {
+        return false;
+    }
+
+    const char* start = pos_;
+    while (pos_ != end_ && *pos_ != '"' && *pos_ != '\\') {
+        if (static_cast<unsigned char>(*pos_) < 0x20) {
+            return fail("control character in string");
+        }
+        ++pos_;
+    }
+    if (pos_ == end_) {
+        return fail("unterminated string");
+    }
+    if (*pos_ == '"') {
+        // Fast path: no escapes, point straight into the mapped file.
+        value = QByteArray::fromRawData(start, static_cast<int>(pos_ - start));
+        ++pos_;
+        return true;
+    }
+
+    QByteArray decoded(start, static_cast<int>(pos_ - start));
+    while (pos_ != end_ && *pos_ != '"') {
+        char c = *pos_;
+        if (static_cast<unsigned char>(c) < 0x20) {
+            return fail("control character in string");
+        }
+        if (c != '\\') {
+            decoded.append(c);
+            ++pos_;
+            continue;
+        }
+        if (++pos_ == end_) {
+            break;
+        }
+        switch (*pos_++) {
+            case '"': decoded.append('"'); break;
+            case '\\': decoded.append('\\'); break;
+            case '/': decoded.append('/'); break;
+            case 'b': decoded.append('\b'); break;
+            case 'f': decoded.append('\f'); break;
+            case 'n': decoded.append('\n'); break;
+            case 'r': decoded.append('\r'); break;
+            case 't': decoded.append('\t'); break;
+            case 'u': {
+                uint code_point = 0;
+                for (int i = 0; i < 4; ++i) {
+                    int digit = pos_ != end_ ? hexDigit(*pos_) : -1;
+                    if (digit < 0) {
+                        return fail("invalid unicode escape");
+                    }
+                    code_point = code_point * 16 + digit;
+                    ++pos_;
+                }
+                if (code_point >= 0xD800 && code_point < 0xDC00 && end_ - pos_ >= 6 &&
+                    pos_[0] == '\\' && pos_[1] == 'u') {
+                    uint low = 0;
+                    bool valid = true;
+                    for (int i = 2; i < 6; ++i) {
+                        int digit = hexDigit(pos_[i]);
+                        valid = valid && digit >= 0;
+                        low = low * 16 + (digit < 0 ? 0 : digit);
+                    }
+                    if (valid && low >= 0xDC00 && low < 0xE000) {
+                        code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+                        pos_ += 6;
+                    }
+                }
+                appendUtf8(decoded, code_point);
+                break;
+            }
+            default:
+                --pos_;
+                return fail("invalid escape sequence");
+        }
+    }
+    if (pos_ == end_) {
+        return fail("unterminated string");
+    }
+    ++pos_;
+    value = decoded;
+    return true;
+}
+
+bool JsonStreamReader::readNumber(QByteArray& value) {
+    if (failed_) {
+        return false;
+    }
+    skipWhitespace();
+
+    const char* start = pos_;
+    if (pos_ != end_ && *pos_ == '-') {
+        ++pos_;
+    }
+    if (pos_ == end_ || !isDigit(*pos_)) {
+        pos_ = start;
+        return fail("expected a number");
+    }
+    while (pos_ != end_ && isDigit(*pos_)) {
+        ++pos_;
+    }
+    if (pos_ != end_ && *pos_ == '.') {
+        ++pos_;
+        if (pos_ == end_ || !isDigit(*pos_)) {
+            return fail("invalid number");
+        }
+        while (pos_ != end_ && isDigit(*pos_)) {
+            ++pos_;
+        }
+    }
+    if (pos_ != end_ && (*pos_ == 'e' || *pos_ == 'E')) {
+        ++pos_;
+        if (pos_ != end_ && (*pos_ == '+' || *pos_ == '-')) {
+            ++pos_;
+        }
+        if (pos_ == end_ || !isDigit(*pos_)) {
+            return fail("invalid number");
+        }
+        while (pos_ != end_ && isDigit(*pos_)) {
+            ++pos_;
+        }
+    }
+
+    value = QByteArray::fromRawData(start, static_cast<int>(pos_ - start));
+    return true;
+}
+
+bool JsonStreamReader::skipValue(int depth) {
+    if (failed_) {
+        return false;
+    }
+    if (depth > kMaxDepth) {
+        return fail("nesting too deep");
+    }
+    skipWhitespace();
+    if (pos_ == end_) {
+        return fail("unexpected end of input");
+    }
+
+    switch (*pos_) {
+        case '"': {
+            QByteArray ignored;
+            return readRawString(ignored);
+        }
+        case '{': {
+            EnterObject();
+            QByteArray key;
+            while (NextKey(key)) {
+                if (!skipValue(depth + 1)) {
+                    return false;
+                }
+            }
+            return !failed_;
+        }
+        case '[': {
+            EnterArray();
+            while (NextElement()) {
+                if (!skipValue(depth + 1)) {
+                    return false;
+                }
+            }
+            return !failed_;
+        }
+        case 't':
+        case 'f': {
+            bool ignored;
+            return ReadBool(ignored);
+        }
+        case 'n': {
+            if (end_ - pos_ >= 4 && qstrncmp(pos_, "null", 4) == 0) {
+                pos_ += 4;
+                return true;
+            }
+            return fail("invalid literal");
+        }
+        default: {
+            QByteArray ignored;
+            return readNumber(ignored);
+        }
+    }
+}
+
+bool JsonStreamReader::EnterObject() {
+    if (!expect('{', "expected an object")) {
+        return false;
+    }
+    first_.push_back(true);
+    return true;
+}
+
+bool JsonStreamReader::EnterArray() {
+    if (!expect('[', "expected an array")) {
+        return false;
+    }
+    first_.push_back(true);
+    return true;
+}
+
+bool JsonStreamReader::NextKey(QByteArray& key) {
+    if (!next('}', "expected ',' or '}'")) {
+        return false;
+    }
+    skipWhitespace();
+    return readRawString(key) && expect(':', "expected ':'");
+}
+
+bool JsonStreamReader::NextElement() {
+    return next(']', "expected ',' or ']'");
+}
+
+bool JsonStreamReader::ReadString(QString& value) {
+    QByteArray bytes;
+    if (!readRawString(bytes)) {
+        return false;
+    }
+    value = QString::fromUtf8(bytes.constData(), bytes.size());
+    return true;
+}
+
+bool JsonStreamReader::ReadBool(bool& value) {
+    if (failed_) {
+        return false;
+    }
+    skipWhitespace();
+    if (end_ - pos_ >= 4 && qstrncmp(pos_, "true", 4) == 0) {
+        pos_ += 4;
+        value = true;
+        return true;
+    }
+    if (end_ - pos_ >= 5 && qstrncmp(pos_, "false", 5) == 0) {
+        pos_ += 5;
+        value = false;
+        return true;
+    }
+    return fail("expected true or false");
+}
+
+bool JsonStreamReader::ReadInt(int& value) {
+    const char* start = pos_;
+    double number;
+    if (!ReadDouble(number)) {
+        return false;
+    }
+    if (std::floor(number) != number || number < std::numeric_limits<int>::min() ||
+        number > std::numeric_limits<int>::max()) {
+        pos_ = start;
+        skipWhitespace();
+        return fail("expected an integer");
+    }
+    value = static_cast<int>(number);
+    return true;
+}
+
+bool JsonStreamReader::ReadDouble(double& value) {
+    QByteArray token;
+    if (!readNumber(token)) {
+        return false;
+    }
+    bool ok = false;
+    value = token.toDouble(&ok);
+    if (!ok) {
+        pos_ -= token.size();
+        return fail("number out of range");
+    }
+    return true;
+}
+
+bool JsonStreamReader::SkipValue() {
+    return skipValue(0);
+}
+
+bool JsonStreamReader::Finish() {
+    if (failed_) {
+        return false;
+    }
+    skipWhitespace();
+    if (pos_ != end_) {
+        return fail("unexpected data after the end of the document");
+    }
+    return true;
+}
+
+bool JsonStreamReader::HasError() const {
+    return failed_;
+}
+
+const ConfigError& JsonStreamReader::GetError() const {
+    return error_;
+}
+
+bool readParameterValue(JsonStreamReader& reader, TYPE_PARAMETER type, QVariant& value) {
+    switch (type) {
+        case TYPE_PARAMETER::LineEdit: {
+            QString text;
+            if (!reader.ReadString(text)) {
+                return false;
+            }
+            value = text;
+            return true;
+        }
+        case TYPE_PARAMETER::CheckBox: {
+            bool status;
+            if (!reader.ReadBool(status)) {
+                return false;
+            }
+            value = status;
+            return true;
+        }
+        case TYPE_PARAMETER::SpinBox: {
+            int number;
+            if (!reader.ReadInt(number)) {
+                return false;
+            }
+            value = number;
+            return true;
+        }
+        case TYPE_PARAMETER::DoubleSpinBox: {
+            double number;
+            if (!reader.ReadDouble(number)) {
+                return false;
+            }
+            value = number;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool loadConfigFile(const QString& file_name, ParameterStore& parameters, ConfigError* error) {
+    TraceSpan span("parse JSON config");
+    QFile file(file_name);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) {
+            *error = ConfigError{-1, QString("Could not open %1").arg(file_name)};
+        }
+        return false;
+    }
+
+    const qint64 size = file.size();
+    Trace::Count("bytes read", size);
+    const uchar* data = size > 0 ? file.map(0, size) : nullptr;
+    if (size > 0 && !data) {
+        if (error) {
+            *error = ConfigError{-1, QString("Could not map %1").arg(file_name)};
+        }
+        return false;
+    }
+
+    // Values are staged per parameter and applied only once the file parsed.
+    std::vector<QVariant> values(parameters.size());
+
+    JsonStreamReader reader(reinterpret_cast<const char*>(data), size);
+    QByteArray key;
+    if (reader.EnterObject()) {
+        while (reader.NextKey(key)) {
+            int slot = parameters.Find(key.constData(), key.size());
+            if (slot < 0) {
+                reader.SkipValue();
+            } else {
+                readParameterValue(reader, parameters.GetType(slot), values[slot]);
+            }
+        }
+    }
+    reader.Finish();
+
+    if (reader.HasError()) {
+        if (error) {
+            *error = reader.GetError();
+        }
+        return false;
+    }
+
+    for (int slot = 0; slot < parameters.size(); ++slot) {
+        if (values[slot].isValid()) {
+            parameters.Apply(slot, values[slot]);
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "ParameterStore.h"
+
+#include <QByteArray>
+#include <QString>
+#include <QVariant>
+#include <vector>
+
+struct ConfigError {
+    // Byte offset of the error in the file, -1 if the file could not be opened.
+    qint64 offset = -1;
+    QString message;
+
+    QString toString() const;
+};
+
+// Single-pass pull parser over a JSON text held in memory (usually a mapping
+// of the config file). Nothing is copied except decoded string values, and
+// every failure records the byte offset at which it happened.
+class JsonStreamReader {
+    const char* begin_;
+    const char* pos_;
+    const char* end_;
+
+    // One entry per open object/array: true until its first member is read.
+    std::vector<bool> first_;
+
+    bool failed_ = false;
+    ConfigError error_;
+
+    static const int kMaxDepth = 256;
+
+    void skipWhitespace();
+
+    bool fail(const char* message);
+
+    bool expect(char c, const char* message);
+
+    bool next(char close, const char* message);
+
+    bool readRawString(QByteArray& value);
+
+    bool readNumber(QByteArray& value);
+
+    bool skipValue(int depth);
+
+public:
+    JsonStreamReader(const char* data, qint64 size);
+
+    bool EnterObject();
+
+    bool EnterArray();
+
+    // Moves to the next member of the current object and reads its key.
+    // Returns false when the object is closed or on error.
+    bool NextKey(QByteArray& key);
+
+    // Moves to the next element of the current array. Returns false when the
+    // array is closed or on error.
+    bool NextElement();
+
+    bool ReadString(QString& value);
+
+    bool ReadBool(bool& value);
+
+    bool ReadInt(int& value);
+
+    bool ReadDouble(double& value);
+
+    bool SkipValue();
+
+    // Checks that only whitespace follows the top-level value.
+    bool Finish();
+
+    bool HasError() const;
+
+    const ConfigError& GetError() const;
+};
+
+// Reads a value of the given parameter type at the reader position.
+bool readParameterValue(JsonStreamReader& reader, TYPE_PARAMETER type, QVariant& value);
+
+// Maps the config file and reads it in one pass straight into the matching
+// parameters. The parameters are left untouched unless the whole file parses.
+bool loadConfigFile(const QString& file_name, ParameterStore& parameters, ConfigError* error = nullptr);
@@ -0,0 +1,205 @@
+#include "ConfigSaver.h"
+#include "ConfigHistory.h"
+#include "ConfigJournal.h"
+#include "Trace.h"
+
+#include <QHash>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+struct ConfigSaver::State {
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+
+    ConfigSaver* owner = nullptr;
+    std::thread thread;
+    bool stop = false;
+    bool busy = false;
+
+    QString file_name;
+    CONFIG_FORMAT format = CONFIG_FORMAT::Json;
+    ConfigSnapshot snapshot;
+    QHash<QString, int> index;
+
+    ConfigSnapshot pending;
+    // Position in pending of each name, so a burst of saves merges in O(1)
+    // per change.
+    QHash<QString, int> pending_index;
+    quint64 generation = 0;
+
+    std::unique_ptr<ConfigHistory> history;
+    std::vector<ParameterSection> sections;
+    // The base has not been committed to the history yet.
+    bool commit_base = false;
+};
+
+namespace {
+
+void mergeChanges(ConfigSnapshot& pending, QHash<QString, int>& pending_index, ConfigSnapshot changes) {
+    for (auto& change : changes) {
+        auto it = pending_index.constFind(change.name);
+        if (it == pending_index.constEnd()) {
+            pending_index.insert(change.name, static_cast<int>(pending.size()));
+            pending.push_back(std::move(change));
+        } else {
+            pending[it.value()] = std::move(change);
+        }
+    }
+}
+
+// Called on the worker without the lock; only the worker uses the history.
+void commitHistory(ConfigHistory& history, const QString& file_name, const ConfigSnapshot& snapshot,
+                   const std::vector<ParameterSection>& sections, const std::vector<int>* changed_slots) {
+    QString message;
+    if (!history.Commit(file_name, snapshot, sections, &message, changed_slots)) {
+        qWarning("Could not add %s to the history: %s", qPrintable(file_name), qPrintable(message));
+    }
+}
+
+}  // namespace
+
+ConfigSaver::ConfigSaver(QObject* parent) : QObject(parent), state_(std::make_shared<State>()) {
+    state_->owner = this;
+
+    std::shared_ptr<State> state = state_;
+    state_->thread = std::thread([state]() {
+        Trace::SetThreadName("ConfigSaver");
+        std::unique_lock<std::mutex> lock(state->mutex);
+        while (true) {
+            state->wake.wait(lock, [&]() {
+                return state->stop || !state->pending.empty() || state->commit_base;
+            });
+            if (state->commit_base && state->pending.empty()) {
+                state->commit_base = false;
+                state->busy = true;
+                QString file_name = state->file_name;
+                ConfigSnapshot snapshot = state->snapshot;
+                lock.unlock();
+
+                commitHistory(*state->history, file_name, snapshot, state->sections, nullptr);
+
+                lock.lock();
+                state->busy = false;
+                state->idle.notify_all();
+                continue;
+            }
+            if (state->pending.empty()) {
+                break;
+            }
+
+            ConfigSnapshot changes = std::move(state->pending);
+            state->pending.clear();
+            state->pending_index.clear();
+            quint64 generation = state->generation;
+            state->busy = true;
+
+            std::vector<int> changed_slots;
+            for (const auto& change : changes) {
+                auto it = state->index.constFind(change.name);
+                if (it != state->index.constEnd()) {
+                    state->snapshot[it.value()].value = change.value;
+                    changed_slots.push_back(it.value());
+                }
+            }
+            ConfigJournal journal(ConfigJournal::journalFileFor(state->file_name));
+            lock.unlock();
+
+            TraceSpan span("ConfigSaver write");
+            QString message;
+            bool ok = journal.Append(changes, &message);
+
+            if (ok && journal.GetSize() >= kCompactThresholdBytes) {
+                lock.lock();
+                QString file_name = state->file_name;
+                CONFIG_FORMAT format = state->format;
+                ConfigSnapshot snapshot = state->snapshot;
+                lock.unlock();
+
+                // The journal is removed only after the base file has been
+                // replaced, so a crash in between just replays it once more.
+                ok = writeConfigFile(file_name, format, snapshot, &message);
+                if (ok && !journal.Clear()) {
+                    qWarning("Could not remove %s", qPrintable(journal.GetFileName()));
+                }
+            }
+
+            if (ok && state->history) {
+                lock.lock();
+                QString file_name = state->file_name;
+                ConfigSnapshot snapshot = state->snapshot;
+                lock.unlock();
+
+                commitHistory(*state->history, file_name, snapshot, state->sections, &changed_slots);
+            }
+
+            lock.lock();
+            state->busy = false;
+            if (state->owner) {
+                emit state->owner->saveFinished(generation, ok, message);
+            }
+            state->idle.notify_all();
+        }
+    });
+}
+
+ConfigSaver::~ConfigSaver() {
+    if (!Flush(kFlushTimeoutMs)) {
+        qWarning("Config write is taking longer than %d ms, waiting for it.", kFlushTimeoutMs);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        state_->owner = nullptr;
+        state_->stop = true;
+    }
+    state_->wake.notify_one();
+
+    // The worker writes everything still pending before it stops.
+    state_->thread.join();
+}
+
+void ConfigSaver::SetBase(const QString& file_name, CONFIG_FORMAT format, ConfigSnapshot snapshot) {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    state_->file_name = file_name;
+    state_->format = format;
+    state_->snapshot = std::move(snapshot);
+    state_->index.clear();
+    for (int i = 0; i < static_cast<int>(state_->snapshot.size()); ++i) {
+        state_->index.insert(state_->snapshot[i].name, i);
+    }
+    if (state_->history) {
+        state_->commit_base = true;
+        state_->wake.notify_one();
+    }
+}
+
+void ConfigSaver::SetHistory(const QString& directory, std::vector<ParameterSection> sections) {
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        state_->history.reset(new ConfigHistory(directory));
+        state_->sections = std::move(sections);
+        state_->commit_base = !state_->file_name.isEmpty();
+    }
+    state_->wake.notify_one();
+}
+
+quint64 ConfigSaver::Save(ConfigSnapshot changes) {
+    quint64 generation;
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        mergeChanges(state_->pending, state_->pending_index, std::move(changes));
+        generation = ++state_->generation;
+    }
+    state_->wake.notify_one();
+    return generation;
+}
+
+bool ConfigSaver::Flush(int timeout_ms) {
+    std::unique_lock<std::mutex> lock(state_->mutex);
+    return state_->idle.wait_for(lock, std::chrono::milliseconds(timeout_ms), [&]() {
+        return state_->pending.empty() && !state_->busy;
+    });
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "ConfigSerializer.h"
+
+#include <QObject>
+#include <QString>
+#include <memory>
+#include <vector>
+
+// Persists config changes on a worker thread. Each save appends only the
+// changed parameters to the ConfigJournal next to the config; once the
+// journal grows past kCompactThresholdBytes it is folded back into the base
+// file, which is rewritten through QSaveFile so a crash mid-write never
+// leaves a truncated config behind. Requests that arrive while a write is in
+// progress are coalesced into one record. With a history directory, every
+// written state is also committed to a ConfigHistory there.
+class ConfigSaver : public QObject {
+    Q_OBJECT
+
+    struct State;
+    std::shared_ptr<State> state_;
+
+public:
+    explicit ConfigSaver(QObject* parent = nullptr);
+
+    // Waits until every queued write is done, warning once it takes longer
+    // than kFlushTimeoutMs. A write is never abandoned: the base file goes
+    // through QSaveFile, but the journal append does not, and a process that
+    // exits during it would lose the save.
+    ~ConfigSaver() override;
+
+    static const int kFlushTimeoutMs = 2000;
+
+    static const qint64 kCompactThresholdBytes = 256 * 1024;
+
+    // Sets the config file and the full set of values it currently holds
+    // (base file plus replayed journal).
+    void SetBase(const QString& file_name, CONFIG_FORMAT format, ConfigSnapshot snapshot);
+
+    // Commits the base and every save to the history in the directory,
+    // chunked along the sections of the schema. Called once, before
+    // SetBase(); the worker uses the history unlocked.
+    void SetHistory(const QString& directory, std::vector<ParameterSection> sections);
+
+    // Queues the changed values and returns the generation number of the write.
+    quint64 Save(ConfigSnapshot changes);
+
+    // Blocks until every queued write is done or the timeout expires.
+    bool Flush(int timeout_ms);
+
+signals:
+    // Emitted from the worker thread once the write of `generation` (and of
+    // every earlier generation coalesced into it) has finished. Connect with
+    // a queued connection.
+    void saveFinished(quint64 generation, bool ok, const QString& message);
+};
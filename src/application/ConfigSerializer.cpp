@@ -0,0 +1,319 @@
+#include "ConfigSerializer.h"
+#include "ConfigJournal.h"
+#include "Trace.h"
+
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <limits>
+
+bool readCborString(QCborStreamReader& reader, QString& value) {
+    value.clear();
+    auto chunk = reader.readString();
+    while (chunk.status == QCborStreamReader::Ok) {
+        value += chunk.data;
+        chunk = reader.readString();
+    }
+    return chunk.status == QCborStreamReader::EndOfString;
+}
+
+bool readCborValue(QCborStreamReader& reader, TYPE_PARAMETER type, QVariant& value) {
+    switch (type) {
+        case TYPE_PARAMETER::LineEdit: {
+            QString text;
+            if (!reader.isString() || !readCborString(reader, text)) {
+                return false;
+            }
+            value = text;
+            return true;
+        }
+        case TYPE_PARAMETER::CheckBox: {
+            if (!reader.isBool()) {
+                return false;
+            }
+            value = reader.toBool();
+            return reader.next();
+        }
+        case TYPE_PARAMETER::SpinBox: {
+            if (!reader.isInteger()) {
+                return false;
+            }
+            // As in JSON, a value an int cannot hold is an error, not wrapped.
+            // A negative one is read as its magnitude (0 for -2^64, which the
+            // subtraction wraps past the limit).
+            const quint64 limit = static_cast<quint64>(std::numeric_limits<int>::max());
+            const bool fits = reader.isUnsignedInteger()
+                              ? reader.toUnsignedInteger() <= limit
+                              : static_cast<quint64>(reader.toNegativeInteger()) - 1 <= limit;
+            if (!fits) {
+                return false;
+            }
+            value = static_cast<int>(reader.toInteger());
+            return reader.next();
+        }
+        case TYPE_PARAMETER::DoubleSpinBox: {
+            if (reader.isDouble()) {
+                value = reader.toDouble();
+            } else if (reader.isFloat()) {
+                value = static_cast<double>(reader.toFloat());
+            } else if (reader.isInteger()) {
+                value = static_cast<double>(reader.toInteger());
+            } else {
+                return false;
+            }
+            return reader.next();
+        }
+    }
+    return false;
+}
+
+void writeCborValue(QCborStreamWriter& writer, const ConfigValue& value) {
+    writer.append(value.name);
+    writeCborValue(writer, value.type, value.value);
+}
+
+void writeCborValue(QCborStreamWriter& writer, TYPE_PARAMETER type, const QVariant& value) {
+    switch (type) {
+        case TYPE_PARAMETER::LineEdit:
+            writer.append(value.toString());
+            break;
+        case TYPE_PARAMETER::CheckBox:
+            writer.append(value.toBool());
+            break;
+        case TYPE_PARAMETER::SpinBox:
+            writer.append(static_cast<qint64>(value.toInt()));
+            break;
+        case TYPE_PARAMETER::DoubleSpinBox:
+            writer.append(value.toDouble());
+            break;
+    }
+}
+
+bool openCborLog(QFile& file, QString* message, qint64 from, std::vector<QByteArray>* records) {
+    if (!file.open(QIODevice::ReadWrite)) {
+        if (message) {
+            *message = file.errorString();
+        }
+        return false;
+    }
+
+    const qint64 size = file.size();
+    if (from > size) {
+        if (message) {
+            *message = QString("%1 is shorter than it was").arg(file.fileName());
+        }
+        return false;
+    }
+    qint64 end = from;
+    if (size > from) {
+        const uchar* data = file.map(from, size - from);
+        if (!data) {
+            if (message) {
+                *message = QString("Could not map %1").arg(file.fileName());
+            }
+            return false;
+        }
+        Trace::Count("bytes read", size - from);
+
+        // next() skips a whole map, and fails on one cut short.
+        QCborStreamReader reader(reinterpret_cast<const char*>(data), size - from);
+        qint64 begin = 0;
+        while (reader.isMap() && reader.next()) {
+            const qint64 next = reader.currentOffset();
+            if (records) {
+                records->emplace_back(reinterpret_cast<const char*>(data) + begin, static_cast<int>(next - begin));
+            }
+            begin = next;
+        }
+        end = from + begin;
+        file.unmap(const_cast<uchar*>(data));
+    }
+
+    if (end < size) {
+        qWarning("Cutting a torn record off the end of %s", qPrintable(file.fileName()));
+        if (!file.resize(end)) {
+            if (message) {
+                *message = file.errorString();
+            }
+            return false;
+        }
+    }
+    return file.seek(end);
+}
+
+ConfigSnapshot takeSnapshot(const ParameterStore& parameters) {
+    ConfigSnapshot snapshot;
+    snapshot.reserve(parameters.size());
+
+    for (int slot = 0; slot < parameters.size(); ++slot) {
+        snapshot.push_back({parameters.GetName(slot), parameters.GetType(slot), parameters.GetValue(slot)});
+    }
+
+    return snapshot;
+}
+
+CONFIG_FORMAT JsonConfigSerializer::GetFormat() const {
+    return CONFIG_FORMAT::Json;
+}
+
+QByteArray JsonConfigSerializer::Serialize(const ConfigSnapshot& snapshot) const {
+    QJsonObject jsonObj;
+
+    for (const auto& value : snapshot) {
+        jsonObj[value.name] = QJsonValue::fromVariant(value.value);
+    }
+
+    return QJsonDocument(jsonObj).toJson();
+}
+
+bool JsonConfigSerializer::Load(const QString& file_name, ParameterStore& parameters,
+                                ConfigError* error) const {
+    return loadConfigFile(file_name, parameters, error);
+}
+
+CONFIG_FORMAT CborConfigSerializer::GetFormat() const {
+    return CONFIG_FORMAT::Cbor;
+}
+
+QByteArray CborConfigSerializer::Serialize(const ConfigSnapshot& snapshot) const {
+    QByteArray data;
+    QCborStreamWriter writer(&data);
+
+    writer.startMap(snapshot.size());
+    for (const auto& value : snapshot) {
+        writeCborValue(writer, value);
+    }
+    writer.endMap();
+
+    return data;
+}
+
+bool CborConfigSerializer::Load(const QString& file_name, ParameterStore& parameters,
+                                ConfigError* error) const {
+    TraceSpan span("parse CBOR config");
+    QFile file(file_name);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) {
+            *error = ConfigError{-1, QString("Could not open %1").arg(file_name)};
+        }
+        return false;
+    }
+
+    const qint64 size = file.size();
+    Trace::Count("bytes read", size);
+    const uchar* data = size > 0 ? file.map(0, size) : nullptr;
+    if (size > 0 && !data) {
+        if (error) {
+            *error = ConfigError{-1, QString("Could not map %1").arg(file_name)};
+        }
+        return false;
+    }
+
+    std::vector<QVariant> values(parameters.size());
+
+    QCborStreamReader reader(reinterpret_cast<const char*>(data), size);
+    QString message;
+    QString key;
+
+    if (!reader.isMap() || !reader.enterContainer()) {
+        message = "expected a map";
+    }
+    while (message.isEmpty() && reader.lastError() == QCborError::NoError && reader.hasNext()) {
+        if (!reader.isString() || !readCborString(reader, key)) {
+            message = "expected a string key";
+            break;
+        }
+
+        int slot = parameters.Find(key);
+        if (slot < 0) {
+            reader.next();
+        } else if (!readCborValue(reader, parameters.GetType(slot), values[slot])) {
+            message = QString("unexpected type for %1").arg(key);
+        }
+    }
+    if (message.isEmpty() && reader.lastError() == QCborError::NoError) {
+        reader.leaveContainer();
+    }
+    if (message.isEmpty() && reader.lastError() != QCborError::NoError) {
+        message = reader.lastError().toString();
+    }
+
+    if (!message.isEmpty()) {
+        if (error) {
+            *error = ConfigError{reader.currentOffset(), message};
+        }
+        return false;
+    }
+
+    for (int slot = 0; slot < parameters.size(); ++slot) {
+        if (values[slot].isValid()) {
+            parameters.Apply(slot, values[slot]);
+        }
+    }
+
+    return true;
+}
+
+CONFIG_FORMAT formatForFile(const QString& file_name) {
+    if (file_name.endsWith(".cbor", Qt::CaseInsensitive)) {
+        return CONFIG_FORMAT::Cbor;
+    }
+    return CONFIG_FORMAT::Json;
+}
+
+std::unique_ptr<ConfigSerializer> createSerializer(CONFIG_FORMAT format) {
+    if (format == CONFIG_FORMAT::Cbor) {
+        return std::unique_ptr<ConfigSerializer>(new CborConfigSerializer());
+    }
+    return std::unique_ptr<ConfigSerializer>(new JsonConfigSerializer());
+}
+
+bool writeConfigFile(const QString& file_name, CONFIG_FORMAT format, const ConfigSnapshot& snapshot,
+                     QString* message) {
+    TraceSpan span("write config");
+    QSaveFile file(file_name);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (message) {
+            *message = file.errorString();
+        }
+        return false;
+    }
+
+    Trace::Count("bytes written", file.write(createSerializer(format)->Serialize(snapshot)));
+    if (!file.commit()) {
+        if (message) {
+            *message = file.errorString();
+        }
+        return false;
+    }
+    return true;
+}
+
+bool convertConfigFile(const QString& from, const QString& to, ParameterStore parameters, CONFIG_FORMAT to_format,
+                       ConfigError* error) {
+    if (to_format == CONFIG_FORMAT::Auto) {
+        to_format = formatForFile(to);
+    }
+
+    // The saves journaled since the config was last written are part of it,
+    // unless a rewrite by another process superseded them.
+    bool ok = createSerializer(formatForFile(from))->Load(from, parameters, error);
+    const ConfigJournal journal(ConfigJournal::journalFileFor(from));
+    if (ok && journal.IsStale(from)) {
+        qWarning("%s is older than %s, not replaying it", qPrintable(journal.GetFileName()), qPrintable(from));
+    } else if (ok) {
+        ok = journal.Replay(parameters, error);
+    }
+
+    QString message;
+    if (ok && !writeConfigFile(to, to_format, takeSnapshot(parameters), &message)) {
+        ok = false;
+        if (error) {
+            *error = ConfigError{-1, QString("Could not write %1: %2").arg(to, message)};
+        }
+    }
+
+    return ok;
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "ConfigReader.h"
+#include "ParameterStore.h"
+
+#include <QByteArray>
+#include <QCborStreamReader>
+#include <QCborStreamWriter>
+#include <QFile>
+#include <QString>
+#include <QVariant>
+#include <memory>
+#include <vector>
+
+enum class CONFIG_FORMAT {
+    Auto,
+    Json,
+    Cbor
+};
+
+// Stored values of a parameter set, detached from the Parameter objects so
+// they can be serialized on another thread.
+struct ConfigValue {
+    QString name;
+    TYPE_PARAMETER type;
+    QVariant value;
+};
+
+typedef std::vector<ConfigValue> ConfigSnapshot;
+
+ConfigSnapshot takeSnapshot(const ParameterStore& parameters);
+
+bool readCborString(QCborStreamReader& reader, QString& value);
+
+// Reads a value of the given parameter type and advances past it.
+bool readCborValue(QCborStreamReader& reader, TYPE_PARAMETER type, QVariant& value);
+
+// Writes the name and the value of one parameter as a CBOR map entry.
+void writeCborValue(QCborStreamWriter& writer, const ConfigValue& value);
+
+// Writes only the value, as readCborValue() reads it back.
+void writeCborValue(QCborStreamWriter& writer, TYPE_PARAMETER type, const QVariant& value);
+
+// Opens a log of CBOR maps appended one per write (a journal or a version
+// log) for appending a record. Whatever follows the last complete map, a
+// record torn by a crash, is cut off first, so the new record starts where a
+// reader expects one. Only the bytes past from, the end of a complete record
+// the caller has already read, are scanned; records (if given) gets the
+// complete records after it. The file is left positioned at its end.
+bool openCborLog(QFile& file, QString* message = nullptr, qint64 from = 0,
+                 std::vector<QByteArray>* records = nullptr);
+
+// Encodes the stored values of a parameter set and reads them back.
+class ConfigSerializer {
+public:
+    virtual ~ConfigSerializer() = default;
+
+    virtual CONFIG_FORMAT GetFormat() const = 0;
+
+    virtual QByteArray Serialize(const ConfigSnapshot& snapshot) const = 0;
+
+    virtual bool Load(const QString& file_name, ParameterStore& parameters,
+                      ConfigError* error = nullptr) const = 0;
+};
+
+// Indented JSON, kept for interchange and hand editing.
+class JsonConfigSerializer : public ConfigSerializer {
+public:
+    CONFIG_FORMAT GetFormat() const override;
+
+    QByteArray Serialize(const ConfigSnapshot& snapshot) const override;
+
+    bool Load(const QString& file_name, ParameterStore& parameters,
+              ConfigError* error = nullptr) const override;
+};
+
+// CBOR map of name to value. Doubles are stored as binary float64, so nothing
+// is formatted or parsed as text.
+class CborConfigSerializer : public ConfigSerializer {
+public:
+    CONFIG_FORMAT GetFormat() const override;
+
+    QByteArray Serialize(const ConfigSnapshot& snapshot) const override;
+
+    bool Load(const QString& file_name, ParameterStore& parameters,
+              ConfigError* error = nullptr) const override;
+};
+
+// ".cbor" files are CBOR, everything else is JSON.
+CONFIG_FORMAT formatForFile(const QString& file_name);
+
+std::unique_ptr<ConfigSerializer> createSerializer(CONFIG_FORMAT format);
+
+// Writes a whole config through QSaveFile, so the old file stays intact if
+// the write fails.
+bool writeConfigFile(const QString& file_name, CONFIG_FORMAT format, const ConfigSnapshot& snapshot,
+                     QString* message = nullptr);
+
+// Reads a config of the schema of parameters (which give the defaults) in
+// one format, with its journal replayed, and writes it through QSaveFile in
+// the format of the target file name (or the explicit format).
+bool convertConfigFile(const QString& from, const QString& to, ParameterStore parameters,
+                       CONFIG_FORMAT to_format = CONFIG_FORMAT::Auto, ConfigError* error = nullptr);
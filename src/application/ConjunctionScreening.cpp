@@ -0,0 +1,326 @@
+#include "ConjunctionScreening.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+
+namespace {
+
+// Steps screened per task; threads take slices from a shared counter, so a
+// slow slice (a crowded part of the window) does not hold up the others.
+const int kStepsPerSlice = 32;
+
+// Cell coordinates are packed into 21 bits each.
+const int kCoordinateBits = 21;
+const std::int64_t kCoordinateMask = (std::int64_t(1) << kCoordinateBits) - 1;
+const std::int64_t kCoordinateOffset = std::int64_t(1) << (kCoordinateBits - 1);
+
+const double kMinCellSize = 1e-3;
+
+struct Shell {
+    double min_radius;
+    double max_radius;
+    int satellite;
+};
+
+// An approach found on the segment from one sample to the next.
+struct Sample {
+    CloseApproach approach;
+    int step;
+};
+
+// Satellites of a fleet at one instant hashed by grid cell. Buckets are
+// filled by a counting sort, so building is O(n) with no per-cell
+// allocations; a bucket may hold several cells, which are kept apart by key.
+class CellGrid {
+    double cell_size_ = 1.0;
+    int bucket_bits_ = 1;
+    std::vector<std::uint64_t> keys_;
+    std::vector<int> starts_;
+    // Satellites by bucket, and within a bucket by cell.
+    std::vector<int> entries_;
+    std::vector<int> cursors_;
+
+    static std::uint64_t pack(std::int64_t x, std::int64_t y, std::int64_t z) {
+        return (static_cast<std::uint64_t>(x & kCoordinateMask) << (2 * kCoordinateBits)) |
+               (static_cast<std::uint64_t>(y & kCoordinateMask) << kCoordinateBits) |
+               static_cast<std::uint64_t>(z & kCoordinateMask);
+    }
+
+    std::int64_t coordinate(double value) const {
+        return static_cast<std::int64_t>(std::floor(value / cell_size_)) + kCoordinateOffset;
+    }
+
+    int bucket(std::uint64_t key) const {
+        return static_cast<int>((key * 0x9E3779B97F4A7C15ULL) >> (64 - bucket_bits_));
+    }
+
+    // Entries [begin, end) of the cell, or an empty range.
+    void find(std::uint64_t key, int& begin, int& end) const {
+        const int b = bucket(key);
+        begin = starts_[b];
+        while (begin < starts_[b + 1] && keys_[entries_[begin]] != key) {
+            ++begin;
+        }
+        end = begin;
+        while (end < starts_[b + 1] && keys_[entries_[end]] == key) {
+            ++end;
+        }
+    }
+
+public:
+    explicit CellGrid(double cell_size) : cell_size_(cell_size) {}
+
+    void Build(const double* x, const double* y, const double* z, int count) {
+        bucket_bits_ = 1;
+        while ((1 << bucket_bits_) < 2 * count) {
+            ++bucket_bits_;
+        }
+
+        keys_.resize(count);
+        starts_.assign((1 << bucket_bits_) + 1, 0);
+        entries_.resize(count);
+        for (int i = 0; i < count; ++i) {
+            keys_[i] = pack(coordinate(x[i]), coordinate(y[i]), coordinate(z[i]));
+            ++starts_[bucket(keys_[i]) + 1];
+        }
+        for (size_t i = 1; i < starts_.size(); ++i) {
+            starts_[i] += starts_[i - 1];
+        }
+        cursors_.assign(starts_.begin(), starts_.end() - 1);
+        for (int i = 0; i < count; ++i) {
+            entries_[cursors_[bucket(keys_[i])]++] = i;
+        }
+
+        // Buckets hold a few satellites; sorting them by key makes each
+        // cell a contiguous run.
+        for (size_t b = 0; b + 1 < starts_.size(); ++b) {
+            if (starts_[b + 1] - starts_[b] > 1) {
+                std::sort(entries_.begin() + starts_[b], entries_.begin() + starts_[b + 1], [&](int left, int right) {
+                    return keys_[left] < keys_[right];
+                });
+            }
+        }
+    }
+
+    // Calls function(first, second) once for every pair of satellites in
+    // the same or in neighbouring cells. Each occupied cell is paired with
+    // itself and with the 13 of its 26 neighbours that follow it, so every
+    // pair of cells is visited once.
+    template<typename Function>
+    void ForEachPair(Function&& function) const {
+        const int count = static_cast<int>(entries_.size());
+        for (int begin = 0; begin < count;) {
+            const std::uint64_t key = keys_[entries_[begin]];
+            int end = begin + 1;
+            while (end < count && keys_[entries_[end]] == key) {
+                ++end;
+            }
+
+            for (int i = begin; i < end; ++i) {
+                for (int j = i + 1; j < end; ++j) {
+                    function(entries_[i], entries_[j]);
+                }
+            }
+
+            const std::int64_t x = static_cast<std::int64_t>(key >> (2 * kCoordinateBits)) & kCoordinateMask;
+            const std::int64_t y = static_cast<std::int64_t>(key >> kCoordinateBits) & kCoordinateMask;
+            const std::int64_t z = static_cast<std::int64_t>(key) & kCoordinateMask;
+            for (int offset = 14; offset < 27; ++offset) {
+                int neighbour_begin = 0;
+                int neighbour_end = 0;
+                find(pack(x + offset / 9 - 1, y + offset / 3 % 3 - 1, z + offset % 3 - 1), neighbour_begin,
+                     neighbour_end);
+                for (int i = begin; i < end; ++i) {
+                    for (int j = neighbour_begin; j < neighbour_end; ++j) {
+                        function(entries_[i], entries_[j]);
+                    }
+                }
+            }
+            begin = end;
+        }
+    }
+};
+
+// Satellites whose radial range, widened by the threshold, overlaps that of
+// another satellite, in ascending order. Ranges are swept by their lower
+// end: a shell overlaps an earlier one if the largest earlier upper end
+// reaches it, and a later one if the next lower end falls inside it.
+std::vector<int> overlappingShells(const OrbitalElements& elements, double threshold, double& max_speed) {
+    std::vector<Shell> shells;
+    shells.reserve(elements.size());
+    for (size_t i = 0; i < elements.size(); ++i) {
+        const double a = OrbitPropagator::kEarthRadius + 0.5 * (elements.apogees[i] + elements.perigees[i]);
+        const double e = std::min(std::max(elements.eccentricities[i], 0.0), OrbitPropagator::kMaxEccentricity);
+        if (std::isfinite(a) && a > 0.0) {
+            shells.push_back({a * (1.0 - e), a * (1.0 + e), static_cast<int>(i)});
+        }
+    }
+    std::sort(shells.begin(), shells.end(), [](const Shell& left, const Shell& right) {
+        return left.min_radius < right.min_radius;
+    });
+
+    std::vector<int> satellites;
+    max_speed = 0.0;
+    double max_radius = -1.0;
+    for (size_t i = 0; i < shells.size(); ++i) {
+        const Shell& shell = shells[i];
+        const bool overlaps_earlier = shell.min_radius - threshold <= max_radius;
+        const bool overlaps_later = i + 1 < shells.size() && shells[i + 1].min_radius - threshold <= shell.max_radius;
+        max_radius = std::max(max_radius, shell.max_radius);
+        if (!overlaps_earlier && !overlaps_later) {
+            continue;
+        }
+
+        satellites.push_back(shell.satellite);
+        // Speed at perigee, the fastest point of the orbit.
+        const double a = 0.5 * (shell.min_radius + shell.max_radius);
+        max_speed = std::max(max_speed, std::sqrt(OrbitPropagator::kEarthMu * (2.0 / shell.min_radius - 1.0 / a)));
+    }
+    std::sort(satellites.begin(), satellites.end());
+    return satellites;
+}
+
+OrbitalElements selectElements(const OrbitalElements& elements, const std::vector<int>& satellites) {
+    OrbitalElements selected;
+    for (int i : satellites) {
+        selected.push_back(elements.apogees[i], elements.perigees[i], elements.eccentricities[i],
+                           elements.inclinations[i], elements.arg_perigees[i], elements.mean_anomalies[i]);
+    }
+    return selected;
+}
+
+// Screens the segments from sample first_step to sample last_step.
+void screenSlice(const OrbitPropagator& propagator, const std::vector<int>& satellites,
+                 const ScreeningOptions& options, double search_radius, int first_step, int last_step,
+                 std::vector<Sample>& samples) {
+    TraceSpan span("screen conjunction slice");
+    const int count = static_cast<int>(propagator.size());
+    auto sampleTime = [&](int step) {
+        return std::min(step * options.step, options.duration);
+    };
+
+    PositionGrid current;
+    PositionGrid next;
+    propagator.Propagate({sampleTime(first_step)}, current, 1);
+    CellGrid grid(std::max(search_radius, kMinCellSize));
+    const double search_radius_squared = search_radius * search_radius;
+
+    for (int step = first_step; step < last_step; ++step) {
+        const double start = sampleTime(step);
+        const double duration = sampleTime(step + 1) - start;
+        propagator.Propagate({sampleTime(step + 1)}, next, 1);
+        grid.Build(current.x.data(), current.y.data(), current.z.data(), count);
+
+        grid.ForEachPair([&](int i, int j) {
+            if (i > j) {
+                std::swap(i, j);
+            }
+            const double rx = current.x[j] - current.x[i];
+            const double ry = current.y[j] - current.y[i];
+            const double rz = current.z[j] - current.z[i];
+            if (rx * rx + ry * ry + rz * rz > search_radius_squared) {
+                return;
+            }
+
+            // Closest point of the relative motion, taken as linear
+            // between the samples.
+            const double vx = next.x[j] - next.x[i] - rx;
+            const double vy = next.y[j] - next.y[i] - ry;
+            const double vz = next.z[j] - next.z[i] - rz;
+            const double speed_squared = vx * vx + vy * vy + vz * vz;
+            double s = speed_squared > 0.0 ? -(rx * vx + ry * vy + rz * vz) / speed_squared : 0.0;
+            s = std::min(std::max(s, 0.0), 1.0);
+            const double dx = rx + s * vx;
+            const double dy = ry + s * vy;
+            const double dz = rz + s * vz;
+            const double distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+            if (distance < options.threshold) {
+                samples.push_back({{satellites[i], satellites[j], start + s * duration, distance}, step});
+            }
+        });
+        std::swap(current, next);
+    }
+}
+
+}  // namespace
+
+std::vector<CloseApproach> screenConjunctions(const OrbitalElements& elements, const ScreeningOptions& options) {
+    TraceSpan span("screenConjunctions");
+    if (options.duration <= 0.0 || options.step <= 0.0 || options.threshold <= 0.0) {
+        return {};
+    }
+
+    double max_speed = 0.0;
+    const std::vector<int> satellites = overlappingShells(elements, options.threshold, max_speed);
+    Trace::Count("conjunction candidates", static_cast<double>(satellites.size()));
+    if (satellites.size() < 2) {
+        return {};
+    }
+
+    // Two satellites closing at the highest possible speed meet within a
+    // step only if they were this close at its start.
+    const double search_radius = options.threshold + 2.0 * max_speed * options.step;
+    const OrbitPropagator propagator(selectElements(elements, satellites));
+
+    const int step_count = static_cast<int>(std::ceil(options.duration / options.step));
+    const int slice_count = (step_count + kStepsPerSlice - 1) / kStepsPerSlice;
+    int thread_count = options.thread_count;
+    if (thread_count <= 0) {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    thread_count = std::min(thread_count, slice_count);
+
+    std::atomic<int> next_slice{0};
+    std::vector<std::vector<Sample>> thread_samples(thread_count);
+    auto work = [&](int thread) {
+        for (int slice = next_slice++; slice < slice_count; slice = next_slice++) {
+            screenSlice(propagator, satellites, options, search_radius, slice * kStepsPerSlice,
+                        std::min(step_count, (slice + 1) * kStepsPerSlice), thread_samples[thread]);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int thread = 1; thread < thread_count; ++thread) {
+        threads.emplace_back(work, thread);
+    }
+    work(0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::vector<Sample> samples;
+    for (auto& part : thread_samples) {
+        samples.insert(samples.end(), part.begin(), part.end());
+    }
+    std::sort(samples.begin(), samples.end(), [](const Sample& left, const Sample& right) {
+        if (left.approach.first != right.approach.first) {
+            return left.approach.first < right.approach.first;
+        }
+        if (left.approach.second != right.approach.second) {
+            return left.approach.second < right.approach.second;
+        }
+        return left.step < right.step;
+    });
+
+    // Runs of consecutive steps of one pair are one encounter.
+    std::vector<CloseApproach> approaches;
+    for (size_t i = 0; i < samples.size(); ++i) {
+        const Sample& sample = samples[i];
+        const bool continues = i > 0 && samples[i - 1].approach.first == sample.approach.first &&
+                               samples[i - 1].approach.second == sample.approach.second &&
+                               samples[i - 1].step + 1 == sample.step;
+        if (!continues) {
+            approaches.push_back(sample.approach);
+        } else if (sample.approach.distance < approaches.back().distance) {
+            approaches.back() = sample.approach;
+        }
+    }
+
+    std::sort(approaches.begin(), approaches.end(), [](const CloseApproach& left, const CloseApproach& right) {
+        return left.distance != right.distance ? left.distance < right.distance : left.time < right.time;
+    });
+    return approaches;
+}
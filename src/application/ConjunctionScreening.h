@@ -0,0 +1,39 @@
+#pragma once
+
+#include "OrbitPropagator.h"
+
+#include <vector>
+
+// Closest approach of two satellites during one encounter.
+struct CloseApproach {
+    int first;
+    int second;
+    // Offset from the epoch of the elements (s).
+    double time;
+    double distance;
+};
+
+struct ScreeningOptions {
+    // Approaches closer than this are reported (km).
+    double threshold = 5.0;
+    // Screened window from the epoch of the elements (s).
+    double duration = 86400.0;
+    // Time between sampled positions (s). Approaches between samples are
+    // found by following the relative motion linearly from one sample to
+    // the next.
+    double step = 10.0;
+    // 0 means one thread per core.
+    int thread_count = 0;
+};
+
+// Every pair of satellites passing within options.threshold of each other
+// during the window, closest first; an encounter spanning several steps is
+// reported once, at its closest point.
+//
+// Satellites whose radial shell (perigee to apogee radius, widened by the
+// threshold) overlaps no other shell are dropped before propagation. The
+// rest are propagated one step at a time and hashed into a grid whose cells
+// are as large as the distance two satellites can close within a step, so
+// only satellites in neighbouring cells are compared. The window is split
+// into slices of steps that are screened on separate threads.
+std::vector<CloseApproach> screenConjunctions(const OrbitalElements& elements, const ScreeningOptions& options);
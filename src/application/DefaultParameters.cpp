@@ -0,0 +1,92 @@
+#include "DefaultParameters.h"
+#include "OrbitPropagator.h"
+#include "SatelliteSchema.h"
+
+namespace {
+
+// Parameter is a ParameterDescriptor or a ParameterDefinition, Section a
+// SectionDescriptor or a SectionDefinition.
+template<typename Parameter, typename Section>
+ParameterStore createStore(const Parameter* parameters, int parameter_count, const Section* sections,
+                           int section_count) {
+    // Parameters are constructed in place in the store columns, with no
+    // temporary Parameter objects or per-parameter allocations.
+    ParameterStore store;
+    int section = 0;
+    for (int slot = 0; slot < parameter_count; ++slot) {
+        for (; section < section_count && sections[section].begin <= slot; ++section) {
+            store.BeginSection(sections[section].title);
+        }
+        const Parameter& parameter = parameters[slot];
+        switch (parameter.type) {
+            case TYPE_PARAMETER::LineEdit:
+                store.AddLineEdit(parameter.name, parameter.placeholder, parameter.text, parameter.label);
+                break;
+            case TYPE_PARAMETER::CheckBox:
+                store.AddCheckBox(parameter.name, parameter.label, parameter.value != 0.0);
+                break;
+            case TYPE_PARAMETER::SpinBox:
+                store.AddSpinBox(parameter.name, parameter.label, static_cast<int>(parameter.min),
+                                 static_cast<int>(parameter.max), static_cast<int>(parameter.value),
+                                 static_cast<int>(parameter.step));
+                break;
+            case TYPE_PARAMETER::DoubleSpinBox:
+                store.AddSpinBox(parameter.name, parameter.label, parameter.min, parameter.max, parameter.value,
+                                 parameter.step);
+                break;
+        }
+    }
+    return store;
+}
+
+}  // namespace
+
+ParameterStore createDefaultParameters() {
+    return SatelliteSchema::Create();
+}
+
+ParameterStore createParameterStore(const ParameterDescriptor* parameters, int parameter_count,
+                                    const SectionDescriptor* sections, int section_count) {
+    return createStore(parameters, parameter_count, sections, section_count);
+}
+
+bool matchesParameterDescriptors(const ParameterStore& parameters, const ParameterDescriptor* descriptors,
+                                 int count) {
+    if (parameters.size() != count) {
+        return false;
+    }
+    for (int slot = 0; slot < count; ++slot) {
+        if (parameters.GetType(slot) != descriptors[slot].type ||
+            parameters.GetName(slot) != QLatin1String(descriptors[slot].name)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+ParameterStore createParameterStore(const ParameterSchema& schema) {
+    return createStore(schema.parameters.data(), static_cast<int>(schema.parameters.size()),
+                       schema.sections.data(), static_cast<int>(schema.sections.size()));
+}
+
+ParameterRules createDefaultRules(const ParameterStore& schema) {
+    const double kEarthRadius = OrbitPropagator::kEarthRadius;
+
+    ParameterRules rules(schema);
+
+    rules.AddCheck({"apogee", "perigee"}, "Apogee must be at least perigee", [](const double* inputs) {
+        return inputs[0] >= inputs[1];
+    });
+    rules.AddDerivation({"apogee", "perigee"}, "eccentricity", [=](const double* inputs) {
+        return (inputs[0] - inputs[1]) / (inputs[0] + inputs[1] + 2.0 * kEarthRadius);
+    });
+    rules.AddDerivation({"apogee", "perigee"}, "altitude", [](const double* inputs) {
+        return 0.5 * (inputs[0] + inputs[1]);
+    });
+
+    return rules;
+}
+
+QStringList defaultIndexedColumns() {
+    return {"altitude", "inclination", "eccentricity", "noradId", "status", "countryCode"};
+}
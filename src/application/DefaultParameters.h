@@ -0,0 +1,31 @@
+#pragma once
+
+#include "ParameterRules.h"
+#include "ParameterSchema.h"
+#include "ParameterStore.h"
+
+#include <QStringList>
+
+// Builds the parameter set of a single satellite with its default values,
+// from the tables generated from schemas/satellite.json.
+ParameterStore createDefaultParameters();
+
+// Builds a store from the tables of a generated schema.
+ParameterStore createParameterStore(const ParameterDescriptor* parameters, int parameter_count,
+                                    const SectionDescriptor* sections, int section_count);
+
+// Whether the store has the names and types of the tables, slot by slot.
+bool matchesParameterDescriptors(const ParameterStore& parameters, const ParameterDescriptor* descriptors,
+                                 int count);
+
+// Builds a store from a schema loaded at runtime, e.g. of a user-defined
+// kind of satellite.
+ParameterStore createParameterStore(const ParameterSchema& schema);
+
+// Orbit consistency rules over a store built by createDefaultParameters():
+// apogee is at least perigee, and eccentricity and (mean) altitude are
+// derived from apogee and perigee.
+ParameterRules createDefaultRules(const ParameterStore& schema);
+
+// Fleet columns that get a FleetIndex: the ones operators filter on.
+QStringList defaultIndexedColumns();
@@ -0,0 +1,63 @@
+#include "EditHistory.h"
+
+void EditHistory::Reset(State state) {
+    states_.clear();
+    states_.push_back(std::move(state));
+    current_ = 0;
+    checkpoints_.clear();
+}
+
+bool EditHistory::IsStarted() const {
+    return current_ >= 0;
+}
+
+const EditHistory::State& EditHistory::GetCurrent() const {
+    return states_[current_];
+}
+
+void EditHistory::Push(State state) {
+    states_.resize(current_ + 1);
+    states_.push_back(std::move(state));
+    ++current_;
+}
+
+bool EditHistory::CanUndo() const {
+    return current_ > 0;
+}
+
+bool EditHistory::CanRedo() const {
+    return current_ + 1 < static_cast<int>(states_.size());
+}
+
+const EditHistory::State& EditHistory::Undo() {
+    if (CanUndo()) {
+        --current_;
+    }
+    return GetCurrent();
+}
+
+const EditHistory::State& EditHistory::Redo() {
+    if (CanRedo()) {
+        ++current_;
+    }
+    return GetCurrent();
+}
+
+int EditHistory::GetStateCount() const {
+    return static_cast<int>(states_.size());
+}
+
+void EditHistory::SetCheckpoint(const QString& name) {
+    checkpoints_.insert(name, GetCurrent());
+}
+
+QStringList EditHistory::GetCheckpointNames() const {
+    QStringList names = checkpoints_.keys();
+    names.sort();
+    return names;
+}
+
+const EditHistory::State* EditHistory::GetCheckpoint(const QString& name) const {
+    auto it = checkpoints_.constFind(name);
+    return it == checkpoints_.constEnd() ? nullptr : &it.value();
+}
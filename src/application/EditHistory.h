@@ -0,0 +1,59 @@
+#pragma once
+
+#include "PersistentVector.h"
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <vector>
+
+// Unlimited undo/redo over a table of values (the modified values of a
+// ParameterStore, or the cells of a Fleet row by row). Each state is a
+// PersistentVector sharing all unchanged nodes with its neighbours, so a
+// one-value edit costs O(log n) memory however large the table is. Named
+// checkpoints keep a state alive after it has left the undo stack.
+class EditHistory {
+public:
+    struct State {
+        PersistentVector<QVariant> values;
+        // Rows in use; values past row_count * columns are left over from
+        // rows that were removed.
+        int row_count = 0;
+    };
+
+private:
+    std::vector<State> states_;
+    int current_ = -1;
+    QHash<QString, State> checkpoints_;
+
+public:
+    // Forgets every state and checkpoint and starts over from one state.
+    void Reset(State state);
+
+    bool IsStarted() const;
+
+    const State& GetCurrent() const;
+
+    // Makes state the current one and drops the states that could be redone.
+    void Push(State state);
+
+    bool CanUndo() const;
+
+    bool CanRedo() const;
+
+    // Moves back or forward and returns the new current state.
+    const State& Undo();
+
+    const State& Redo();
+
+    // Number of states on the undo and redo stacks, the current one included.
+    int GetStateCount() const;
+
+    void SetCheckpoint(const QString& name);
+
+    QStringList GetCheckpointNames() const;
+
+    // Returns nullptr for an unknown name.
+    const State* GetCheckpoint(const QString& name) const;
+};
@@ -0,0 +1,236 @@
+#include "Fleet.h"
+#include "Trace.h"
+
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+
+Fleet::Fleet(ParameterStore schema) : schema_(std::move(schema)) {
+    columns_.texts.resize(schema_.GetLineEdits().size());
+    columns_.bools.resize(schema_.GetCheckBoxes().size());
+    columns_.ints.resize(schema_.GetIntSpinBoxes().size());
+    columns_.doubles.resize(schema_.GetDoubleSpinBoxes().size());
+}
+
+void Fleet::resize(Columns& columns, int satellite_count) const {
+    for (int i = 0; i < schema_.GetLineEdits().size(); ++i) {
+        columns.texts[i].resize(satellite_count, schema_.GetLineEdits().GetValue(i));
+    }
+    for (int i = 0; i < schema_.GetCheckBoxes().size(); ++i) {
+        columns.bools[i].resize(satellite_count, schema_.GetCheckBoxes().GetValue(i));
+    }
+    for (int i = 0; i < schema_.GetIntSpinBoxes().size(); ++i) {
+        columns.ints[i].resize(satellite_count, schema_.GetIntSpinBoxes().GetValue(i));
+    }
+    for (int i = 0; i < schema_.GetDoubleSpinBoxes().size(); ++i) {
+        columns.doubles[i].resize(satellite_count, schema_.GetDoubleSpinBoxes().GetValue(i));
+    }
+}
+
+int Fleet::GetSatelliteCount() const {
+    return satellite_count_;
+}
+
+int Fleet::GetParameterCount() const {
+    return schema_.size();
+}
+
+const ParameterStore& Fleet::GetSchema() const {
+    return schema_;
+}
+
+QVariant Fleet::GetValue(int satellite, int column) const {
+    const ParameterSlot& slot = schema_.GetSlot(column);
+    switch (slot.type) {
+        case TYPE_PARAMETER::LineEdit:
+            return columns_.texts[slot.index][satellite];
+        case TYPE_PARAMETER::CheckBox:
+            return static_cast<bool>(columns_.bools[slot.index][satellite]);
+        case TYPE_PARAMETER::SpinBox:
+            return columns_.ints[slot.index][satellite];
+        case TYPE_PARAMETER::DoubleSpinBox:
+            return columns_.doubles[slot.index][satellite];
+    }
+    return {};
+}
+
+void Fleet::SetValue(int satellite, int column, const QVariant& value) {
+    const ParameterSlot& slot = schema_.GetSlot(column);
+    switch (slot.type) {
+        case TYPE_PARAMETER::LineEdit:
+            columns_.texts[slot.index][satellite] = value.toString();
+            break;
+        case TYPE_PARAMETER::CheckBox:
+            columns_.bools[slot.index][satellite] = value.toBool();
+            break;
+        case TYPE_PARAMETER::SpinBox:
+            columns_.ints[slot.index][satellite] = value.toInt();
+            break;
+        case TYPE_PARAMETER::DoubleSpinBox:
+            columns_.doubles[slot.index][satellite] = value.toDouble();
+            break;
+    }
+}
+
+const std::vector<QString>& Fleet::GetTexts(int column) const {
+    return columns_.texts[schema_.GetSlot(column).index];
+}
+
+const std::vector<char>& Fleet::GetBools(int column) const {
+    return columns_.bools[schema_.GetSlot(column).index];
+}
+
+const std::vector<int>& Fleet::GetInts(int column) const {
+    return columns_.ints[schema_.GetSlot(column).index];
+}
+
+const std::vector<double>& Fleet::GetDoubles(int column) const {
+    return columns_.doubles[schema_.GetSlot(column).index];
+}
+
+std::vector<QString>& Fleet::GetTexts(int column) {
+    return columns_.texts[schema_.GetSlot(column).index];
+}
+
+std::vector<char>& Fleet::GetBools(int column) {
+    return columns_.bools[schema_.GetSlot(column).index];
+}
+
+std::vector<int>& Fleet::GetInts(int column) {
+    return columns_.ints[schema_.GetSlot(column).index];
+}
+
+std::vector<double>& Fleet::GetDoubles(int column) {
+    return columns_.doubles[schema_.GetSlot(column).index];
+}
+
+int Fleet::AddSatellite() {
+    Resize(satellite_count_ + 1);
+    return satellite_count_ - 1;
+}
+
+void Fleet::Resize(int satellite_count) {
+    resize(columns_, satellite_count);
+    satellite_count_ = satellite_count;
+}
+
+void Fleet::Swap(Fleet& other) {
+    std::swap(columns_, other.columns_);
+    std::swap(satellite_count_, other.satellite_count_);
+}
+
+bool Fleet::Load(const QString& file_name, ConfigError* error) {
+    QFile file(file_name);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (error) {
+            *error = ConfigError{-1, QString("Could not open %1").arg(file_name)};
+        }
+        return false;
+    }
+
+    const qint64 size = file.size();
+    const uchar* data = size > 0 ? file.map(0, size) : nullptr;
+    if (size > 0 && !data) {
+        if (error) {
+            *error = ConfigError{-1, QString("Could not map %1").arg(file_name)};
+        }
+        return false;
+    }
+
+    Columns columns;
+    columns.texts.resize(columns_.texts.size());
+    columns.bools.resize(columns_.bools.size());
+    columns.ints.resize(columns_.ints.size());
+    columns.doubles.resize(columns_.doubles.size());
+    int satellite_count = 0;
+
+    JsonStreamReader reader(reinterpret_cast<const char*>(data), size);
+    QByteArray key;
+    if (reader.EnterArray()) {
+        while (reader.NextElement() && reader.EnterObject()) {
+            int row = satellite_count++;
+            resize(columns, satellite_count);
+
+            while (reader.NextKey(key)) {
+                int column = schema_.Find(key.constData(), key.size());
+                if (column < 0) {
+                    reader.SkipValue();
+                    continue;
+                }
+
+                const ParameterSlot& slot = schema_.GetSlot(column);
+                switch (slot.type) {
+                    case TYPE_PARAMETER::LineEdit:
+                        reader.ReadString(columns.texts[slot.index][row]);
+                        break;
+                    case TYPE_PARAMETER::CheckBox: {
+                        bool status = false;
+                        reader.ReadBool(status);
+                        columns.bools[slot.index][row] = status;
+                        break;
+                    }
+                    case TYPE_PARAMETER::SpinBox:
+                        reader.ReadInt(columns.ints[slot.index][row]);
+                        break;
+                    case TYPE_PARAMETER::DoubleSpinBox:
+                        reader.ReadDouble(columns.doubles[slot.index][row]);
+                        break;
+                }
+            }
+        }
+    }
+    reader.Finish();
+
+    if (reader.HasError()) {
+        if (error) {
+            *error = reader.GetError();
+        }
+        return false;
+    }
+
+    std::swap(columns_, columns);
+    satellite_count_ = satellite_count;
+
+    return true;
+}
+
+bool Fleet::Save(const QString& file_name, QString* message) const {
+    TraceSpan span("write fleet");
+    QSaveFile file(file_name);
+    if (!file.open(QIODevice::WriteOnly)) {
+        if (message) {
+            *message = file.errorString();
+        }
+        return false;
+    }
+
+    // One satellite at a time, so only one row is ever held as JSON. A
+    // failed write leaves the file as it was: QSaveFile then refuses to
+    // commit.
+    std::vector<QString> names(GetParameterCount());
+    for (int column = 0; column < GetParameterCount(); ++column) {
+        names[column] = schema_.GetName(column);
+    }
+    qint64 written = file.write("[\n");
+    for (int row = 0; row < satellite_count_; ++row) {
+        QJsonObject satellite;
+        for (int column = 0; column < GetParameterCount(); ++column) {
+            satellite[names[column]] = QJsonValue::fromVariant(GetValue(row, column));
+        }
+        QByteArray line = QJsonDocument(satellite).toJson(QJsonDocument::Compact);
+        line.append(row + 1 < satellite_count_ ? ",\n" : "\n");
+        written += file.write(line);
+    }
+    written += file.write("]\n");
+    Trace::Count("bytes written", written);
+
+    if (!file.commit()) {
+        if (message) {
+            *message = file.errorString();
+        }
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "ConfigReader.h"
+#include "ParameterStore.h"
+
+#include <QString>
+#include <QVariant>
+#include <vector>
+
+// A set of satellites sharing one parameter schema. Each schema parameter is
+// one typed column indexed by satellite, so a whole fleet is created and torn
+// down one column at a time rather than one value at a time. Text columns
+// start out sharing the schema's default string.
+class Fleet {
+    struct Columns {
+        std::vector<std::vector<QString>> texts;
+        std::vector<std::vector<char>> bools;
+        std::vector<std::vector<int>> ints;
+        std::vector<std::vector<double>> doubles;
+    };
+
+    ParameterStore schema_;
+    Columns columns_;
+    int satellite_count_ = 0;
+
+    void resize(Columns& columns, int satellite_count) const;
+
+public:
+    explicit Fleet(ParameterStore schema);
+
+    Fleet(const Fleet& other) = delete;
+
+    Fleet& operator=(const Fleet& other) = delete;
+
+    int GetSatelliteCount() const;
+
+    int GetParameterCount() const;
+
+    // One slot per column, holding the default values of a new satellite.
+    const ParameterStore& GetSchema() const;
+
+    QVariant GetValue(int satellite, int column) const;
+
+    void SetValue(int satellite, int column, const QVariant& value);
+
+    // Values of a column of the given kind, one per satellite.
+    const std::vector<QString>& GetTexts(int column) const;
+
+    const std::vector<char>& GetBools(int column) const;
+
+    const std::vector<int>& GetInts(int column) const;
+
+    const std::vector<double>& GetDoubles(int column) const;
+
+    // Writable values of a column, for bulk imports. The size must stay the
+    // satellite count.
+    std::vector<QString>& GetTexts(int column);
+
+    std::vector<char>& GetBools(int column);
+
+    std::vector<int>& GetInts(int column);
+
+    std::vector<double>& GetDoubles(int column);
+
+    int AddSatellite();
+
+    // Grows or shrinks the fleet in one step; new satellites get the defaults.
+    void Resize(int satellite_count);
+
+    // Exchanges the satellites of two fleets of the same schema.
+    void Swap(Fleet& other);
+
+    bool Load(const QString& file_name, ConfigError* error = nullptr);
+
+    // Writes through QSaveFile: on failure the file keeps its old content.
+    bool Save(const QString& file_name, QString* message = nullptr) const;
+};
@@ -0,0 +1,577 @@
+#include "FleetColumns.h"
+#include "Trace.h"
+
+#include <QHash>
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <thread>
+
+namespace {
+
+const char kMagic[4] = {'Q', 'T', 'F', 'C'};
+const int kHeaderSize = 16;
+const int kChunkHeaderSize = 16;
+const quint32 kMaxColumns = 1 << 16;
+const quint32 kMaxNameSize = 1 << 16;
+
+bool fail(QString* message, const QString& text) {
+    if (message != nullptr) {
+        *message = text;
+    }
+    return false;
+}
+
+// First of the values outside [min, max], NaN included, or -1.
+template<typename T>
+int findOutOfRange(const std::vector<T>& values, T min, T max) {
+    for (size_t row = 0; row < values.size(); ++row) {
+        if (!(values[row] >= min && values[row] <= max)) {
+            return static_cast<int>(row);
+        }
+    }
+    return -1;
+}
+
+int paddingFor(qint64 size) {
+    return static_cast<int>((8 - size % 8) % 8);
+}
+
+void appendPadding(QByteArray& data) {
+    data.append(paddingFor(data.size()), '\0');
+}
+
+// Integers and doubles as their little-endian bytes.
+template<typename T>
+void storeLittleEndian(T value, char* out) {
+    typename QIntegerForSize<sizeof(T)>::Unsigned bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    qToLittleEndian(bits, out);
+}
+
+template<typename T>
+T loadLittleEndian(const char* in) {
+    const auto bits = qFromLittleEndian<typename QIntegerForSize<sizeof(T)>::Unsigned>(in);
+    T value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+template<typename T>
+void appendValue(QByteArray& data, T value) {
+    char bytes[sizeof(T)];
+    storeLittleEndian(value, bytes);
+    data.append(bytes, sizeof(T));
+}
+
+// Appends the values as one padded buffer; a copy on little-endian hosts.
+template<typename T>
+void appendValues(QByteArray& data, const T* values, int count) {
+    const int offset = data.size();
+    data.resize(offset + count * static_cast<int>(sizeof(T)));
+    char* out = data.data() + offset;
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    std::memcpy(out, values, count * sizeof(T));
+#else
+    for (int i = 0; i < count; ++i) {
+        storeLittleEndian(values[i], out + i * sizeof(T));
+    }
+#endif
+    appendPadding(data);
+}
+
+template<typename Index>
+void appendIndices(QByteArray& data, const std::vector<quint32>& indices, int rows) {
+    const int offset = data.size();
+    data.resize(offset + rows * static_cast<int>(sizeof(Index)));
+    char* out = data.data() + offset;
+    for (int row = 0; row < rows; ++row) {
+        storeLittleEndian(static_cast<Index>(indices[row]), out + row * sizeof(Index));
+    }
+    appendPadding(data);
+}
+
+// Dictionary of the text column being encoded, reused across columns.
+struct TextEncoder {
+    QHash<QString, quint32> dictionary;
+    std::vector<const QString*> distinct;
+    std::vector<quint32> indices;
+};
+
+void appendTexts(QByteArray& data, const QString* texts, int rows, TextEncoder& encoder) {
+    encoder.dictionary.clear();
+    encoder.distinct.clear();
+    encoder.indices.resize(rows);
+
+    // Copies of one string, such as the default of new satellites, share its
+    // data; runs of them skip the hash.
+    const QChar* last = nullptr;
+    quint32 last_index = 0;
+    for (int row = 0; row < rows; ++row) {
+        const QString& text = texts[row];
+        if (row == 0 || text.constData() != last) {
+            auto found = encoder.dictionary.constFind(text);
+            if (found == encoder.dictionary.constEnd()) {
+                last_index = static_cast<quint32>(encoder.distinct.size());
+                encoder.dictionary.insert(text, last_index);
+                encoder.distinct.push_back(&text);
+            } else {
+                last_index = found.value();
+            }
+            last = text.constData();
+        }
+        encoder.indices[row] = last_index;
+    }
+
+    const quint32 size = static_cast<quint32>(encoder.distinct.size());
+    const quint32 width = size <= 0x100 ? 1 : size <= 0x10000 ? 2 : 4;
+    appendValue(data, size);
+    appendValue(data, width);
+
+    // Offsets are filled in as the UTF-8 data is appended after them.
+    const int offsets = data.size();
+    data.resize(offsets + (size + 1) * 4);
+    const int base = data.size();
+    storeLittleEndian<quint32>(0, data.data() + offsets);
+    for (quint32 i = 0; i < size; ++i) {
+        data.append(encoder.distinct[i]->toUtf8());
+        storeLittleEndian(static_cast<quint32>(data.size() - base), data.data() + offsets + (i + 1) * 4);
+    }
+    appendPadding(data);
+
+    if (width == 1) {
+        appendIndices<quint8>(data, encoder.indices, rows);
+    } else if (width == 2) {
+        appendIndices<quint16>(data, encoder.indices, rows);
+    } else {
+        appendIndices<quint32>(data, encoder.indices, rows);
+    }
+}
+
+// Encodes satellites [first, first + rows) as one chunk, header included.
+void encodeChunk(const Fleet& fleet, const std::vector<FleetColumnInfo>& columns, int first, int rows,
+                 QByteArray& data) {
+    TraceSpan span("encode fleet chunk");
+    // Keeps the allocation of the previous chunk, which resize(0) alone frees.
+    data.reserve(std::max(data.capacity(), kChunkHeaderSize));
+    data.resize(0);
+    appendValue(data, static_cast<quint32>(rows));
+    appendValue(data, quint32(0));
+    appendValue(data, quint64(0));
+
+    TextEncoder encoder;
+    for (int column = 0; column < static_cast<int>(columns.size()); ++column) {
+        switch (columns[column].type) {
+            case TYPE_PARAMETER::LineEdit:
+                appendTexts(data, fleet.GetTexts(column).data() + first, rows, encoder);
+                break;
+            case TYPE_PARAMETER::CheckBox:
+                appendValues(data, fleet.GetBools(column).data() + first, rows);
+                break;
+            case TYPE_PARAMETER::SpinBox:
+                appendValues(data, fleet.GetInts(column).data() + first, rows);
+                break;
+            case TYPE_PARAMETER::DoubleSpinBox:
+                appendValues(data, fleet.GetDoubles(column).data() + first, rows);
+                break;
+        }
+    }
+    storeLittleEndian(static_cast<quint64>(data.size() - kChunkHeaderSize), data.data() + 8);
+}
+
+// Bounds-checked reads from a chunk body.
+class Cursor {
+    const char* data_;
+    qint64 size_;
+    qint64 offset_ = 0;
+    bool ok_ = true;
+
+public:
+    Cursor(const char* data, qint64 size) : data_(data), size_(size) {
+    }
+
+    bool IsOk() const {
+        return ok_;
+    }
+
+    // The next bytes, or nullptr past the end.
+    const char* Take(qint64 bytes) {
+        if (!ok_ || bytes < 0 || bytes > size_ - offset_) {
+            ok_ = false;
+            return nullptr;
+        }
+        const char* result = data_ + offset_;
+        offset_ += bytes;
+        return result;
+    }
+
+    quint32 TakeUInt32() {
+        const char* bytes = Take(4);
+        return bytes != nullptr ? qFromLittleEndian<quint32>(bytes) : 0;
+    }
+
+    void Align() {
+        Take(paddingFor(offset_));
+    }
+};
+
+template<typename T>
+bool readValues(Cursor& cursor, int rows, std::vector<T>& values) {
+    const char* in = cursor.Take(qint64(rows) * sizeof(T));
+    cursor.Align();
+    if (!cursor.IsOk()) {
+        return false;
+    }
+    values.resize(rows);
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    std::memcpy(values.data(), in, rows * sizeof(T));
+#else
+    for (int row = 0; row < rows; ++row) {
+        values[row] = loadLittleEndian<T>(in + row * sizeof(T));
+    }
+#endif
+    return true;
+}
+
+bool readTexts(Cursor& cursor, int rows, FleetColumnData& column) {
+    const quint32 size = cursor.TakeUInt32();
+    const quint32 width = cursor.TakeUInt32();
+    if (!cursor.IsOk() || size > static_cast<quint32>(rows) || (size == 0 && rows > 0) ||
+        (width != 1 && width != 2 && width != 4)) {
+        return false;
+    }
+    const char* offsets = cursor.Take((qint64(size) + 1) * 4);
+    if (offsets == nullptr) {
+        return false;
+    }
+    const quint32 text_size = qFromLittleEndian<quint32>(offsets + size * 4);
+    const char* texts = cursor.Take(text_size);
+    cursor.Align();
+    if (!cursor.IsOk()) {
+        return false;
+    }
+    column.dictionary.resize(size);
+    quint32 begin = qFromLittleEndian<quint32>(offsets);
+    for (quint32 i = 0; i < size; ++i) {
+        const quint32 end = qFromLittleEndian<quint32>(offsets + (i + 1) * 4);
+        if (begin > end || end > text_size) {
+            return false;
+        }
+        column.dictionary[i] = QString::fromUtf8(texts + begin, static_cast<int>(end - begin));
+        begin = end;
+    }
+
+    const char* indices = cursor.Take(qint64(rows) * width);
+    cursor.Align();
+    if (!cursor.IsOk()) {
+        return false;
+    }
+    column.indices.resize(rows);
+    for (int row = 0; row < rows; ++row) {
+        const char* in = indices + row * width;
+        const quint32 index = width == 1 ? static_cast<quint8>(*in)
+                              : width == 2 ? qFromLittleEndian<quint16>(in) : qFromLittleEndian<quint32>(in);
+        if (index >= size) {
+            return false;
+        }
+        column.indices[row] = index;
+    }
+    return true;
+}
+
+}  // namespace
+
+FleetColumnWriter::FleetColumnWriter(int chunk_rows, int thread_count) : chunk_rows_(std::max(1, chunk_rows)) {
+    if (thread_count <= 0) {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    thread_count_ = thread_count;
+}
+
+bool FleetColumnWriter::write(const QByteArray& data, QString* message) {
+    if (file_.write(data) != data.size()) {
+        file_.cancelWriting();
+        return fail(message, QString("Could not write %1: %2").arg(file_.fileName(), file_.errorString()));
+    }
+    return true;
+}
+
+bool FleetColumnWriter::Open(const QString& file_name, const ParameterStore& schema, QString* message) {
+    file_.setFileName(file_name);
+    if (!file_.open(QIODevice::WriteOnly)) {
+        return fail(message, QString("Could not open %1: %2").arg(file_name, file_.errorString()));
+    }
+    columns_.clear();
+    rows_ = 0;
+
+    QByteArray header(kMagic, sizeof(kMagic));
+    appendValue(header, kVersion);
+    appendValue(header, static_cast<quint32>(schema.size()));
+    appendValue(header, static_cast<quint32>(chunk_rows_));
+    for (int slot = 0; slot < schema.size(); ++slot) {
+        columns_.push_back({schema.GetName(slot), schema.GetType(slot)});
+        const QByteArray name = schema.GetName(slot).toUtf8();
+        appendValue(header, static_cast<quint32>(schema.GetType(slot)));
+        appendValue(header, static_cast<quint32>(name.size()));
+        header.append(name);
+        appendPadding(header);
+    }
+    return write(header, message);
+}
+
+bool FleetColumnWriter::Write(const Fleet& fleet, int first, int count, QString* message) {
+    TraceSpan span("write fleet columns");
+    if (fleet.GetParameterCount() != static_cast<int>(columns_.size())) {
+        return fail(message, "The fleet is not of the schema of the file.");
+    }
+
+    // Each batch of thread_count_ chunks is encoded while the previous one
+    // is written, into the other half of buffers_.
+    buffers_.resize(2 * thread_count_);
+    const int chunk_count = (count + chunk_rows_ - 1) / chunk_rows_;
+    const int batch_count = (chunk_count + thread_count_ - 1) / thread_count_;
+    auto chunksOf = [&](int batch) {
+        return std::min(thread_count_, chunk_count - batch * thread_count_);
+    };
+    auto encode = [&](int batch, int i) {
+        const int begin = first + (batch * thread_count_ + i) * chunk_rows_;
+        encodeChunk(fleet, columns_, begin, std::min(chunk_rows_, first + count - begin),
+                    buffers_[(batch % 2) * thread_count_ + i]);
+    };
+
+    for (int batch = 0; batch <= batch_count; ++batch) {
+        std::vector<std::thread> threads;
+        if (batch < batch_count) {
+            for (int i = 0; i < chunksOf(batch); ++i) {
+                threads.emplace_back(encode, batch, i);
+            }
+        }
+        bool ok = true;
+        if (batch > 0) {
+            const int previous = batch - 1;
+            for (int i = 0; i < chunksOf(previous) && ok; ++i) {
+                ok = write(buffers_[(previous % 2) * thread_count_ + i], message);
+            }
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        if (!ok) {
+            return false;
+        }
+    }
+    rows_ += count;
+    return true;
+}
+
+bool FleetColumnWriter::Close(QString* message) {
+    QByteArray end;
+    appendValue(end, quint32(0));
+    appendValue(end, quint32(0));
+    appendValue(end, static_cast<quint64>(rows_));
+    if (!write(end, message)) {
+        return false;
+    }
+    if (!file_.commit()) {
+        return fail(message, QString("Could not write %1: %2").arg(file_.fileName(), file_.errorString()));
+    }
+    return true;
+}
+
+qint64 FleetColumnWriter::GetRowCount() const {
+    return rows_;
+}
+
+bool FleetColumnReader::Open(const QString& file_name, QString* message) {
+    file_.setFileName(file_name);
+    if (!file_.open(QIODevice::ReadOnly)) {
+        return fail(message, QString("Could not open %1: %2").arg(file_name, file_.errorString()));
+    }
+    columns_.clear();
+    rows_ = 0;
+    finished_ = false;
+
+    const QByteArray header = file_.read(kHeaderSize);
+    Cursor cursor(header.constData(), header.size());
+    const char* magic = cursor.Take(sizeof(kMagic));
+    const quint32 version = cursor.TakeUInt32();
+    const quint32 column_count = cursor.TakeUInt32();
+    const quint32 chunk_rows = cursor.TakeUInt32();
+    if (!cursor.IsOk() || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+        return fail(message, QString("%1 is not a fleet columns file.").arg(file_name));
+    }
+    if (version != FleetColumnWriter::kVersion || column_count > kMaxColumns || chunk_rows == 0 ||
+        chunk_rows > static_cast<quint32>(std::numeric_limits<int>::max())) {
+        return fail(message, QString("%1 is of an unknown version.").arg(file_name));
+    }
+    chunk_rows_ = static_cast<int>(chunk_rows);
+
+    for (quint32 i = 0; i < column_count; ++i) {
+        const QByteArray fields = file_.read(8);
+        Cursor field_cursor(fields.constData(), fields.size());
+        const quint32 type = field_cursor.TakeUInt32();
+        const quint32 name_size = field_cursor.TakeUInt32();
+        if (!field_cursor.IsOk() || type > static_cast<quint32>(TYPE_PARAMETER::DoubleSpinBox) ||
+            name_size > kMaxNameSize) {
+            return fail(message, QString("%1 has a malformed column %2.").arg(file_name).arg(i));
+        }
+        const QByteArray name = file_.read(name_size + paddingFor(8 + name_size));
+        if (name.size() != static_cast<int>(name_size) + paddingFor(8 + name_size)) {
+            return fail(message, QString("%1 is truncated.").arg(file_name));
+        }
+        columns_.push_back({QString::fromUtf8(name.constData(), name_size), static_cast<TYPE_PARAMETER>(type)});
+    }
+    return true;
+}
+
+const std::vector<FleetColumnInfo>& FleetColumnReader::GetColumns() const {
+    return columns_;
+}
+
+int FleetColumnReader::GetChunkRows() const {
+    return chunk_rows_;
+}
+
+bool FleetColumnReader::ReadChunk(FleetColumnChunk& chunk, QString* message) {
+    chunk.rows = 0;
+    if (finished_) {
+        return false;
+    }
+    const QByteArray header = file_.read(kChunkHeaderSize);
+    if (header.size() != kChunkHeaderSize) {
+        return fail(message, QString("%1 is truncated.").arg(file_.fileName()));
+    }
+    const quint32 rows = qFromLittleEndian<quint32>(header.constData());
+    const quint64 size = qFromLittleEndian<quint64>(header.constData() + 8);
+    if (rows == 0) {
+        if (size != static_cast<quint64>(rows_)) {
+            return fail(message, QString("%1 is missing rows.").arg(file_.fileName()));
+        }
+        finished_ = true;
+        return false;
+    }
+    if (rows > static_cast<quint32>(chunk_rows_) || size > static_cast<quint64>(kMaxChunkBytes)) {
+        return fail(message, QString("%1 has a malformed chunk.").arg(file_.fileName()));
+    }
+
+    TraceSpan span("read fleet chunk");
+    buffer_.resize(static_cast<int>(size));
+    if (file_.read(buffer_.data(), buffer_.size()) != buffer_.size()) {
+        return fail(message, QString("%1 is truncated.").arg(file_.fileName()));
+    }
+
+    Cursor cursor(buffer_.constData(), buffer_.size());
+    chunk.columns.resize(columns_.size());
+    for (size_t column = 0; column < columns_.size(); ++column) {
+        FleetColumnData& data = chunk.columns[column];
+        bool ok = false;
+        switch (columns_[column].type) {
+            case TYPE_PARAMETER::LineEdit:
+                ok = readTexts(cursor, rows, data);
+                break;
+            case TYPE_PARAMETER::CheckBox:
+                ok = readValues(cursor, rows, data.bools);
+                break;
+            case TYPE_PARAMETER::SpinBox:
+                ok = readValues(cursor, rows, data.ints);
+                break;
+            case TYPE_PARAMETER::DoubleSpinBox:
+                ok = readValues(cursor, rows, data.doubles);
+                break;
+        }
+        if (!ok) {
+            return fail(message, QString("%1 has a malformed column %2 after row %3.")
+                .arg(file_.fileName(), columns_[column].name).arg(rows_));
+        }
+    }
+    chunk.rows = static_cast<int>(rows);
+    rows_ += rows;
+    return true;
+}
+
+bool FleetColumnReader::IsFinished() const {
+    return finished_;
+}
+
+qint64 FleetColumnReader::GetRowCount() const {
+    return rows_;
+}
+
+bool exportFleetColumns(const Fleet& fleet, const QString& file_name, QString* message, int thread_count) {
+    TraceSpan span("export fleet columns");
+    FleetColumnWriter writer(FleetColumnWriter::kChunkRows, thread_count);
+    return writer.Open(file_name, fleet.GetSchema(), message) &&
+           writer.Write(fleet, 0, fleet.GetSatelliteCount(), message) && writer.Close(message);
+}
+
+bool importFleetColumns(const QString& file_name, Fleet& fleet, QString* message) {
+    TraceSpan span("import fleet columns");
+    FleetColumnReader reader;
+    if (!reader.Open(file_name, message)) {
+        return false;
+    }
+    const ParameterStore& schema = fleet.GetSchema();
+    std::vector<int> targets;
+    for (const FleetColumnInfo& info : reader.GetColumns()) {
+        const int slot = schema.Find(info.name);
+        targets.push_back(slot >= 0 && schema.GetType(slot) == info.type ? slot : -1);
+    }
+
+    // Satellites are decoded aside and take the place of the fleet's only once
+    // the whole file has been read and checked.
+    Fleet imported(schema);
+    FleetColumnChunk chunk;
+    while (reader.ReadChunk(chunk, message)) {
+        const int first = imported.GetSatelliteCount();
+        imported.Resize(first + chunk.rows);
+        for (size_t column = 0; column < targets.size(); ++column) {
+            const int slot = targets[column];
+            if (slot < 0) {
+                continue;
+            }
+            const FleetColumnData& data = chunk.columns[column];
+            const int index = schema.GetSlot(slot).index;
+            int bad_row = -1;
+            switch (schema.GetType(slot)) {
+                case TYPE_PARAMETER::LineEdit: {
+                    QString* texts = imported.GetTexts(slot).data() + first;
+                    for (int row = 0; row < chunk.rows; ++row) {
+                        texts[row] = data.dictionary[data.indices[row]];
+                    }
+                    break;
+                }
+                case TYPE_PARAMETER::CheckBox: {
+                    // Any byte but 0 reads as true, as the check box would show it.
+                    char* bools = imported.GetBools(slot).data() + first;
+                    for (int row = 0; row < chunk.rows; ++row) {
+                        bools[row] = data.bools[row] != 0;
+                    }
+                    break;
+                }
+                case TYPE_PARAMETER::SpinBox: {
+                    const IntSpinBoxColumn& bounds = schema.GetColumn<IntSpinBoxColumn>();
+                    bad_row = findOutOfRange(data.ints, bounds.mins[index], bounds.maxs[index]);
+                    std::copy(data.ints.begin(), data.ints.end(), imported.GetInts(slot).begin() + first);
+                    break;
+                }
+                case TYPE_PARAMETER::DoubleSpinBox: {
+                    const DoubleSpinBoxColumn& bounds = schema.GetColumn<DoubleSpinBoxColumn>();
+                    bad_row = findOutOfRange(data.doubles, bounds.mins[index], bounds.maxs[index]);
+                    std::copy(data.doubles.begin(), data.doubles.end(), imported.GetDoubles(slot).begin() + first);
+                    break;
+                }
+            }
+            if (bad_row >= 0) {
+                return fail(message, QString("%1: satellite %2 has %3 %4, outside its range.")
+                    .arg(file_name).arg(first + bad_row + 1).arg(schema.GetName(slot))
+                    .arg(imported.GetValue(first + bad_row, slot).toString()));
+            }
+        }
+    }
+    if (!reader.IsFinished()) {
+        return false;
+    }
+    fleet.Swap(imported);
+    return true;
+}
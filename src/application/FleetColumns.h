@@ -0,0 +1,129 @@
+#pragma once
+
+#include "Fleet.h"
+#include "ParameterStore.h"
+
+#include <QByteArray>
+#include <QFile>
+#include <QSaveFile>
+#include <QString>
+#include <QtGlobal>
+#include <vector>
+
+// Chunked columnar fleet files, for analysis tools that want whole columns
+// rather than one JSON object per satellite. All integers are little-endian
+// and every buffer starts 8-byte aligned, so a reader can map the file and
+// use the float64 buffers in place:
+//
+//     header    "QTFC", version, column count, chunk rows      (4 x uint32)
+//     column    type (TYPE_PARAMETER), name size, UTF-8 name, padding
+//     chunk     row count, 0, body size (uint32, uint32, uint64), body
+//     ...
+//     end       0, 0, total row count (uint32, uint32, uint64)
+//
+// A chunk body holds each column of its rows in turn:
+//
+//     double    float64 per row
+//     int       int32 per row
+//     bool      byte per row
+//     text      dictionary size and index width (uint32 each), dictionary
+//               size + 1 uint32 offsets into the UTF-8 data that follows,
+//               then one index of 1, 2 or 4 bytes per row
+//
+// Text dictionaries are per chunk, so neither side holds more than a chunk
+// of any column and chunks can be encoded independently.
+struct FleetColumnInfo {
+    QString name;
+    TYPE_PARAMETER type;
+};
+
+// Values of one column over the rows of a chunk, in the vector of its type.
+struct FleetColumnData {
+    std::vector<double> doubles;
+    std::vector<int> ints;
+    std::vector<char> bools;
+    // Text: the distinct values of the chunk and, per row, one of them.
+    std::vector<QString> dictionary;
+    std::vector<quint32> indices;
+};
+
+struct FleetColumnChunk {
+    int rows = 0;
+    std::vector<FleetColumnData> columns;
+};
+
+// Writes satellites of a fleet in chunks of chunk_rows. Chunks are encoded
+// on up to thread_count threads (0: one per core) while the previous batch
+// is written, so at most 2 * thread_count encoded chunks are held at a time.
+// The file replaces the target on Close().
+class FleetColumnWriter {
+    QSaveFile file_;
+    std::vector<FleetColumnInfo> columns_;
+    int chunk_rows_;
+    int thread_count_;
+    // Two batches of one encoded chunk per thread, reused.
+    std::vector<QByteArray> buffers_;
+    qint64 rows_ = 0;
+
+    bool write(const QByteArray& data, QString* message);
+
+public:
+    static const int kChunkRows = 65536;
+
+    static const quint32 kVersion = 1;
+
+    explicit FleetColumnWriter(int chunk_rows = kChunkRows, int thread_count = 0);
+
+    // Starts a file of the columns of the schema.
+    bool Open(const QString& file_name, const ParameterStore& schema, QString* message = nullptr);
+
+    // Appends satellites [first, first + count) of a fleet of the schema.
+    bool Write(const Fleet& fleet, int first, int count, QString* message = nullptr);
+
+    bool Close(QString* message = nullptr);
+
+    qint64 GetRowCount() const;
+};
+
+// Reads a file of FleetColumnWriter one chunk at a time.
+class FleetColumnReader {
+    QFile file_;
+    std::vector<FleetColumnInfo> columns_;
+    int chunk_rows_ = 0;
+    // Body of the current chunk, reused.
+    QByteArray buffer_;
+    qint64 rows_ = 0;
+    bool finished_ = false;
+
+public:
+    // Bodies past this size are taken for corruption.
+    static const qint64 kMaxChunkBytes = qint64(1) << 30;
+
+    bool Open(const QString& file_name, QString* message = nullptr);
+
+    const std::vector<FleetColumnInfo>& GetColumns() const;
+
+    int GetChunkRows() const;
+
+    // Reads the next chunk. Returns false at the end of the file (then
+    // IsFinished()) or on a truncated or malformed file.
+    bool ReadChunk(FleetColumnChunk& chunk, QString* message = nullptr);
+
+    bool IsFinished() const;
+
+    // Rows read so far; all of them once finished.
+    qint64 GetRowCount() const;
+};
+
+bool exportFleetColumns(const Fleet& fleet, const QString& file_name, QString* message = nullptr,
+                        int thread_count = 0);
+
+// Replaces the satellites of the fleet with those of the file. Columns are
+// matched by name; columns of the file that the schema does not have or
+// has with another type are skipped, and schema columns the file does not
+// have keep their defaults. Text values of a chunk share the strings of its
+// dictionary. The file is read in full before the fleet is touched: on a
+// truncated file or an int or double outside its parameter's range the fleet
+// keeps its satellites. Bool bytes other than 0 read as true. Derived columns
+// are taken as stored; see ParameterRules::Derive().
+bool importFleetColumns(const QString& file_name, Fleet& fleet, QString* message = nullptr);
@@ -0,0 +1,85 @@
+#include "FleetDelegate.h"
+
+#include <QCheckBox>
+#include <QDoubleSpinBox>
+#include <QLineEdit>
+#include <QSpinBox>
+
+namespace {
+
+QWidget* createEditorWidget(const LineEditColumn& column, int index, QWidget* parent) {
+    auto* line_edit_widget = new QLineEdit(parent);
+    line_edit_widget->setPlaceholderText(column.original_texts[index]);
+    return line_edit_widget;
+}
+
+QWidget* createEditorWidget(const CheckBoxColumn&, int, QWidget* parent) {
+    return new QCheckBox(parent);
+}
+
+QWidget* createEditorWidget(const IntSpinBoxColumn& column, int index, QWidget* parent) {
+    auto* spin_box_widget = new QSpinBox(parent);
+    spin_box_widget->setMinimum(column.mins[index]);
+    spin_box_widget->setMaximum(column.maxs[index]);
+    spin_box_widget->setSingleStep(column.steps[index]);
+    return spin_box_widget;
+}
+
+QWidget* createEditorWidget(const DoubleSpinBoxColumn& column, int index, QWidget* parent) {
+    auto* double_spin_box_widget = new QDoubleSpinBox(parent);
+    double_spin_box_widget->setMinimum(column.mins[index]);
+    double_spin_box_widget->setMaximum(column.maxs[index]);
+    double_spin_box_widget->setSingleStep(column.steps[index]);
+    return double_spin_box_widget;
+}
+
+}  // namespace
+
+FleetDelegate::FleetDelegate(const Fleet* fleet, QObject* parent) : QStyledItemDelegate(parent), fleet_(fleet) {}
+
+QWidget* FleetDelegate::createEditor(QWidget* parent, const QStyleOptionViewItem&,
+                                     const QModelIndex& index) const {
+    return fleet_->GetSchema().Visit(index.column(), [&](const auto& column, int slot_index) {
+        return createEditorWidget(column, slot_index, parent);
+    });
+}
+
+void FleetDelegate::setEditorData(QWidget* editor, const QModelIndex& index) const {
+    QVariant value = index.data(Qt::EditRole);
+
+    switch (fleet_->GetSchema().GetType(index.column())) {
+        case TYPE_PARAMETER::LineEdit:
+            static_cast<QLineEdit*>(editor)->setText(value.toString());
+            break;
+        case TYPE_PARAMETER::CheckBox:
+            static_cast<QCheckBox*>(editor)->setChecked(value.toBool());
+            break;
+        case TYPE_PARAMETER::SpinBox:
+            static_cast<QSpinBox*>(editor)->setValue(value.toInt());
+            break;
+        case TYPE_PARAMETER::DoubleSpinBox:
+            static_cast<QDoubleSpinBox*>(editor)->setValue(value.toDouble());
+            break;
+    }
+}
+
+void FleetDelegate::setModelData(QWidget* editor, QAbstractItemModel* model, const QModelIndex& index) const {
+    switch (fleet_->GetSchema().GetType(index.column())) {
+        case TYPE_PARAMETER::LineEdit: {
+            QString text = static_cast<QLineEdit*>(editor)->text();
+            if (!text.isEmpty()) {
+                model->setData(index, text);
+            }
+            break;
+        }
+        case TYPE_PARAMETER::CheckBox:
+            model->setData(index, static_cast<QCheckBox*>(editor)->isChecked());
+            break;
+        case TYPE_PARAMETER::SpinBox:
+            model->setData(index, static_cast<QSpinBox*>(editor)->value());
+            break;
+        case TYPE_PARAMETER::DoubleSpinBox:
+            model->setData(index, static_cast<QDoubleSpinBox*>(editor)->value());
+            break;
+    }
+}
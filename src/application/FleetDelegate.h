@@ -0,0 +1,23 @@
+#pragma once
+
+#include "Fleet.h"
+
+#include <QStyledItemDelegate>
+
+// Creates the same input widgets as MainWindow::createWidgets(), but only for
+// the cell that is being edited.
+class FleetDelegate : public QStyledItemDelegate {
+    Q_OBJECT
+
+    const Fleet* fleet_;
+
+public:
+    explicit FleetDelegate(const Fleet* fleet, QObject* parent = nullptr);
+
+    QWidget* createEditor(QWidget* parent, const QStyleOptionViewItem& option,
+                          const QModelIndex& index) const override;
+
+    void setEditorData(QWidget* editor, const QModelIndex& index) const override;
+
+    void setModelData(QWidget* editor, QAbstractItemModel* model, const QModelIndex& index) const override;
+};
@@ -0,0 +1,378 @@
+#include "FleetIndex.h"
+
+#include <QtAlgorithms>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Satellites added at once beyond which the indexes are rebuilt instead of
+// updated one satellite at a time.
+const int kRebuildThreshold = 1024;
+
+int wordCount(int satellite_count) {
+    return (satellite_count + 63) / 64;
+}
+
+bool isNumeric(TYPE_PARAMETER type) {
+    return type == TYPE_PARAMETER::SpinBox || type == TYPE_PARAMETER::DoubleSpinBox;
+}
+
+bool parseBool(const QString& text, bool& value) {
+    if (text == "true" || text == "on" || text == "1") {
+        value = true;
+        return true;
+    }
+    if (text == "false" || text == "off" || text == "0") {
+        value = false;
+        return true;
+    }
+    return false;
+}
+
+bool setError(QString* message, const QString& text) {
+    if (message) {
+        *message = text;
+    }
+    return false;
+}
+
+}  // namespace
+
+bool parseFleetQuery(const QString& text, const ParameterStore& schema, FleetQuery& query, QString* message) {
+    FleetQuery parsed;
+    for (const QString& term : text.simplified().split(" ")) {
+        if (term.isEmpty()) {
+            continue;
+        }
+
+        int position = 0;
+        while (position < term.size() && term.at(position) != '<' && term.at(position) != '>' &&
+               term.at(position) != '=') {
+            ++position;
+        }
+        if (position == 0 || position == term.size()) {
+            return setError(message, QString("Expected name=value, got %1").arg(term));
+        }
+
+        const QString name = term.left(position);
+        const int column = schema.Find(name);
+        if (column < 0) {
+            return setError(message, QString("Unknown parameter %1").arg(name));
+        }
+
+        QString op = term.mid(position, 1);
+        if (op != "=" && position + 1 < term.size() && term.at(position + 1) == '=') {
+            op += "=";
+        }
+        const QString value = term.mid(position + op.size());
+
+        const TYPE_PARAMETER type = schema.GetType(column);
+        if (!isNumeric(type)) {
+            if (op != "=") {
+                return setError(message, QString("%1 can only be compared with =").arg(name));
+            }
+            if (type == TYPE_PARAMETER::CheckBox) {
+                bool status = false;
+                if (!parseBool(value, status)) {
+                    return setError(message, QString("Expected true or false for %1").arg(name));
+                }
+                parsed.conditions.push_back({column, 0.0, 0.0, status ? "true" : "false"});
+            } else {
+                parsed.conditions.push_back({column, 0.0, 0.0, value});
+            }
+            continue;
+        }
+
+        const double kInfinity = std::numeric_limits<double>::infinity();
+        const QStringList bounds = op == "=" ? value.split("..") : QStringList{value};
+        if (bounds.size() > 2) {
+            return setError(message, QString("Expected a number or min..max for %1").arg(name));
+        }
+        double numbers[2] = {0.0, 0.0};
+        for (int i = 0; i < bounds.size(); ++i) {
+            bool ok = false;
+            numbers[i] = bounds.at(i).toDouble(&ok);
+            if (!ok || std::isnan(numbers[i])) {
+                return setError(message, QString("Expected a number for %1, got %2").arg(name, bounds.at(i)));
+            }
+        }
+
+        FleetCondition condition{column, -kInfinity, kInfinity, QString()};
+        if (op == "=") {
+            condition.min = numbers[0];
+            condition.max = bounds.size() == 2 ? numbers[1] : numbers[0];
+        } else if (op == "<") {
+            condition.max = std::nextafter(numbers[0], -kInfinity);
+        } else if (op == "<=") {
+            condition.max = numbers[0];
+        } else if (op == ">") {
+            condition.min = std::nextafter(numbers[0], kInfinity);
+        } else {
+            condition.min = numbers[0];
+        }
+        parsed.conditions.push_back(std::move(condition));
+    }
+
+    query = std::move(parsed);
+    return true;
+}
+
+FleetIndex::FleetIndex(const Fleet* fleet, const QStringList& columns) : fleet_(fleet) {
+    const ParameterStore& schema = fleet_->GetSchema();
+    sorted_of_column_.assign(schema.size(), -1);
+    bitmap_of_column_.assign(schema.size(), -1);
+
+    for (const QString& name : columns) {
+        const int column = schema.Find(name);
+        if (column < 0 || IsIndexed(column)) {
+            continue;
+        }
+        if (isNumeric(schema.GetType(column))) {
+            sorted_of_column_[column] = static_cast<int>(sorted_.size());
+            sorted_.push_back({column, {}, {}});
+        } else {
+            bitmap_of_column_[column] = static_cast<int>(bitmaps_.size());
+            bitmaps_.push_back({column, {}, {}});
+        }
+    }
+    Rebuild();
+}
+
+double FleetIndex::getNumber(int satellite, int column) const {
+    if (fleet_->GetSchema().GetType(column) == TYPE_PARAMETER::SpinBox) {
+        return fleet_->GetInts(column)[satellite];
+    }
+    return fleet_->GetDoubles(column)[satellite];
+}
+
+QString FleetIndex::getText(int satellite, int column) const {
+    if (fleet_->GetSchema().GetType(column) == TYPE_PARAMETER::CheckBox) {
+        return fleet_->GetBools(column)[satellite] ? "true" : "false";
+    }
+    return fleet_->GetTexts(column)[satellite];
+}
+
+void FleetIndex::insert(SortedIndex& index, int satellite, double value) {
+    index.values[satellite] = value;
+    if (!std::isnan(value)) {
+        const Entry entry{value, satellite};
+        index.entries.insert(std::lower_bound(index.entries.begin(), index.entries.end(), entry), entry);
+    }
+}
+
+void FleetIndex::erase(SortedIndex& index, int satellite) {
+    const double value = index.values[satellite];
+    if (!std::isnan(value)) {
+        index.entries.erase(std::lower_bound(index.entries.begin(), index.entries.end(), Entry{value, satellite}));
+    }
+}
+
+void FleetIndex::insert(BitmapIndex& index, int satellite, QString value) {
+    Bitmap& bitmap = index.bitmaps[value];
+    if (static_cast<int>(bitmap.words.size()) < wordCount(satellite + 1)) {
+        bitmap.words.resize(wordCount(satellite_count_));
+    }
+    bitmap.words[satellite / 64] |= quint64(1) << (satellite % 64);
+    ++bitmap.count;
+    index.values[satellite] = std::move(value);
+}
+
+void FleetIndex::erase(BitmapIndex& index, int satellite) {
+    auto it = index.bitmaps.find(index.values[satellite]);
+    it->words[satellite / 64] &= ~(quint64(1) << (satellite % 64));
+    if (--it->count == 0) {
+        index.bitmaps.erase(it);
+    }
+}
+
+void FleetIndex::Rebuild() {
+    satellite_count_ = fleet_->GetSatelliteCount();
+
+    for (SortedIndex& index : sorted_) {
+        index.values.resize(satellite_count_);
+        index.entries.clear();
+        index.entries.reserve(satellite_count_);
+        for (int satellite = 0; satellite < satellite_count_; ++satellite) {
+            const double value = getNumber(satellite, index.column);
+            index.values[satellite] = value;
+            if (!std::isnan(value)) {
+                index.entries.push_back({value, satellite});
+            }
+        }
+        std::sort(index.entries.begin(), index.entries.end());
+    }
+
+    for (BitmapIndex& index : bitmaps_) {
+        index.values.assign(satellite_count_, QString());
+        index.bitmaps.clear();
+        for (int satellite = 0; satellite < satellite_count_; ++satellite) {
+            insert(index, satellite, getText(satellite, index.column));
+        }
+    }
+}
+
+void FleetIndex::Update(int satellite, int column) {
+    if (satellite >= satellite_count_) {
+        return;
+    }
+
+    if (sorted_of_column_[column] >= 0) {
+        SortedIndex& index = sorted_[sorted_of_column_[column]];
+        const double value = getNumber(satellite, column);
+        if (value == index.values[satellite] || (std::isnan(value) && std::isnan(index.values[satellite]))) {
+            return;
+        }
+        erase(index, satellite);
+        insert(index, satellite, value);
+    } else if (bitmap_of_column_[column] >= 0) {
+        BitmapIndex& index = bitmaps_[bitmap_of_column_[column]];
+        QString value = getText(satellite, column);
+        if (value == index.values[satellite]) {
+            return;
+        }
+        erase(index, satellite);
+        insert(index, satellite, std::move(value));
+    }
+}
+
+void FleetIndex::UpdateSatelliteCount() {
+    const int count = fleet_->GetSatelliteCount();
+    if (count - satellite_count_ > kRebuildThreshold) {
+        Rebuild();
+        return;
+    }
+
+    for (SortedIndex& index : sorted_) {
+        for (int satellite = satellite_count_ - 1; satellite >= count; --satellite) {
+            erase(index, satellite);
+        }
+        index.values.resize(count);
+    }
+    for (BitmapIndex& index : bitmaps_) {
+        for (int satellite = satellite_count_ - 1; satellite >= count; --satellite) {
+            erase(index, satellite);
+        }
+        index.values.resize(count);
+    }
+
+    const int old_count = satellite_count_;
+    satellite_count_ = count;
+    for (int satellite = old_count; satellite < count; ++satellite) {
+        for (SortedIndex& index : sorted_) {
+            insert(index, satellite, getNumber(satellite, index.column));
+        }
+        for (BitmapIndex& index : bitmaps_) {
+            insert(index, satellite, getText(satellite, index.column));
+        }
+    }
+}
+
+bool FleetIndex::IsIndexed(int column) const {
+    return sorted_of_column_[column] >= 0 || bitmap_of_column_[column] >= 0;
+}
+
+int FleetIndex::estimate(const FleetCondition& condition) const {
+    if (sorted_of_column_[condition.column] >= 0) {
+        const std::vector<Entry>& entries = sorted_[sorted_of_column_[condition.column]].entries;
+        auto begin = std::lower_bound(entries.begin(), entries.end(), Entry{condition.min, -1});
+        auto end = std::upper_bound(begin, entries.end(), Entry{condition.max, std::numeric_limits<int>::max()});
+        return static_cast<int>(end - begin);
+    }
+    if (bitmap_of_column_[condition.column] >= 0) {
+        const BitmapIndex& index = bitmaps_[bitmap_of_column_[condition.column]];
+        auto it = index.bitmaps.constFind(condition.text);
+        return it == index.bitmaps.constEnd() ? 0 : it->count;
+    }
+    return -1;
+}
+
+bool FleetIndex::matches(int satellite, const FleetCondition& condition) const {
+    switch (fleet_->GetSchema().GetType(condition.column)) {
+        case TYPE_PARAMETER::LineEdit:
+            return fleet_->GetTexts(condition.column)[satellite] == condition.text;
+        case TYPE_PARAMETER::CheckBox:
+            return (fleet_->GetBools(condition.column)[satellite] != 0) == (condition.text == "true");
+        case TYPE_PARAMETER::SpinBox:
+        case TYPE_PARAMETER::DoubleSpinBox:
+            break;
+    }
+    const double value = getNumber(satellite, condition.column);
+    return value >= condition.min && value <= condition.max;
+}
+
+std::vector<int> FleetIndex::Query(const FleetQuery& query) const {
+    const int conditions = static_cast<int>(query.conditions.size());
+
+    int driver = -1;
+    int driver_count = satellite_count_ + 1;
+    for (int i = 0; i < conditions; ++i) {
+        const int count = estimate(query.conditions[i]);
+        if (count >= 0 && count < driver_count) {
+            driver = i;
+            driver_count = count;
+        }
+    }
+    if (driver_count == 0) {
+        return {};
+    }
+
+    // Candidates as a bitmap, so they come out in satellite order.
+    const int words = wordCount(satellite_count_);
+    std::vector<quint64> candidates;
+    std::vector<char> checked(conditions, false);
+    if (driver < 0) {
+        candidates.assign(words, ~quint64(0));
+        if (satellite_count_ % 64 != 0) {
+            candidates.back() = (quint64(1) << (satellite_count_ % 64)) - 1;
+        }
+    } else {
+        const FleetCondition& condition = query.conditions[driver];
+        candidates.assign(words, 0);
+        if (sorted_of_column_[condition.column] >= 0) {
+            const std::vector<Entry>& entries = sorted_[sorted_of_column_[condition.column]].entries;
+            auto it = std::lower_bound(entries.begin(), entries.end(), Entry{condition.min, -1});
+            for (int i = 0; i < driver_count; ++i, ++it) {
+                candidates[it->satellite / 64] |= quint64(1) << (it->satellite % 64);
+            }
+        } else {
+            const Bitmap& bitmap = *bitmaps_[bitmap_of_column_[condition.column]].bitmaps.constFind(condition.text);
+            std::copy_n(bitmap.words.begin(), std::min(words, static_cast<int>(bitmap.words.size())),
+                        candidates.begin());
+        }
+        checked[driver] = true;
+    }
+
+    // Other bitmap conditions are applied a word at a time.
+    for (int i = 0; i < conditions; ++i) {
+        const FleetCondition& condition = query.conditions[i];
+        if (checked[i] || bitmap_of_column_[condition.column] < 0) {
+            continue;
+        }
+        const BitmapIndex& index = bitmaps_[bitmap_of_column_[condition.column]];
+        auto it = index.bitmaps.constFind(condition.text);
+        if (it == index.bitmaps.constEnd()) {
+            return {};
+        }
+        for (int word = 0; word < words; ++word) {
+            candidates[word] &= word < static_cast<int>(it->words.size()) ? it->words[word] : 0;
+        }
+        checked[i] = true;
+    }
+
+    std::vector<int> satellites;
+    for (int word = 0; word < words; ++word) {
+        for (quint64 bits = candidates[word]; bits != 0; bits &= bits - 1) {
+            const int satellite = word * 64 + static_cast<int>(qCountTrailingZeroBits(bits));
+            bool match = true;
+            for (int i = 0; i < conditions && match; ++i) {
+                match = checked[i] || matches(satellite, query.conditions[i]);
+            }
+            if (match) {
+                satellites.push_back(satellite);
+            }
+        }
+    }
+    return satellites;
+}
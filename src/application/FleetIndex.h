@@ -0,0 +1,117 @@
+#pragma once
+
+#include "Fleet.h"
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <vector>
+
+// One condition of a fleet query: a numeric column within [min, max], or a
+// text or bool column equal to text (bools as "true" or "false").
+struct FleetCondition {
+    int column;
+    double min;
+    double max;
+    QString text;
+};
+
+// Satellites matching every condition.
+struct FleetQuery {
+    std::vector<FleetCondition> conditions;
+
+    bool empty() const {
+        return conditions.empty();
+    }
+};
+
+// Parses whitespace-separated terms such as
+//     status=true inclination=97..99 altitude<600 countryCode=RU
+// into a query on the schema's columns. Numeric columns take name=value,
+// name=min..max and name<value (also <=, > and >=); text and bool columns
+// take name=value.
+bool parseFleetQuery(const QString& text, const ParameterStore& schema, FleetQuery& query,
+                     QString* message = nullptr);
+
+// Secondary indexes over some columns of a fleet: numeric columns get a
+// sorted index of (value, satellite), text and bool columns a bitmap of the
+// satellites per distinct value. Both are kept up to date one cell at a time
+// as the fleet is edited. A query starts from the most selective indexed
+// condition and checks the rest on its candidates only, so selective
+// queries on 100k satellites take microseconds.
+class FleetIndex {
+    struct Entry {
+        double value;
+        int satellite;
+
+        bool operator<(const Entry& other) const {
+            return value != other.value ? value < other.value : satellite < other.satellite;
+        }
+    };
+
+    struct SortedIndex {
+        int column;
+        // Value of each satellite as indexed; NaNs are left out of entries.
+        std::vector<double> values;
+        std::vector<Entry> entries;
+    };
+
+    struct Bitmap {
+        std::vector<quint64> words;
+        int count = 0;
+    };
+
+    struct BitmapIndex {
+        int column;
+        std::vector<QString> values;
+        QHash<QString, Bitmap> bitmaps;
+    };
+
+    const Fleet* fleet_;
+
+    std::vector<SortedIndex> sorted_;
+    std::vector<BitmapIndex> bitmaps_;
+    // Position of each fleet column in sorted_ or bitmaps_, or -1.
+    std::vector<int> sorted_of_column_;
+    std::vector<int> bitmap_of_column_;
+
+    int satellite_count_ = 0;
+
+    double getNumber(int satellite, int column) const;
+
+    QString getText(int satellite, int column) const;
+
+    static void insert(SortedIndex& index, int satellite, double value);
+
+    static void erase(SortedIndex& index, int satellite);
+
+    void insert(BitmapIndex& index, int satellite, QString value);
+
+    void erase(BitmapIndex& index, int satellite);
+
+    // Number of satellites an indexed condition leaves, or -1 if the column
+    // is not indexed.
+    int estimate(const FleetCondition& condition) const;
+
+    bool matches(int satellite, const FleetCondition& condition) const;
+
+public:
+    // Indexes the named columns of the fleet, which must outlive the index.
+    // Unknown names are ignored.
+    FleetIndex(const Fleet* fleet, const QStringList& columns);
+
+    // Re-reads every indexed column.
+    void Rebuild();
+
+    // Re-reads one cell after the fleet changed it.
+    void Update(int satellite, int column);
+
+    // Follows the fleet's satellite count after satellites were added or
+    // removed at the end.
+    void UpdateSatelliteCount();
+
+    bool IsIndexed(int column) const;
+
+    // Returns the matching satellites in ascending order.
+    std::vector<int> Query(const FleetQuery& query) const;
+};
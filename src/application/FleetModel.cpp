@@ -0,0 +1,272 @@
+#include "FleetModel.h"
+#include "DefaultParameters.h"
+
+#include <algorithm>
+
+FleetModel::FleetModel(Fleet* fleet, QObject* parent) : QAbstractTableModel(parent), fleet_(fleet),
+                                                          rules_(createDefaultRules(fleet->GetSchema())) {}
+
+int FleetModel::rowCount(const QModelIndex& parent) const {
+    if (parent.isValid()) {
+        return 0;
+    }
+    return is_filtered_ ? static_cast<int>(rows_.size()) : fleet_->GetSatelliteCount();
+}
+
+int FleetModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : fleet_->GetParameterCount();
+}
+
+QVariant FleetModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || (role != Qt::DisplayRole && role != Qt::EditRole)) {
+        return {};
+    }
+    return fleet_->GetValue(satelliteAt(index.row()), index.column());
+}
+
+bool FleetModel::setData(const QModelIndex& index, const QVariant& value, int role) {
+    if (!index.isValid() || role != Qt::EditRole || rules_.IsDerived(index.column())) {
+        return false;
+    }
+
+    startHistory();
+    const int satellite = satelliteAt(index.row());
+    keepOriginalRow(satellite);
+    const QVariant old_value = fleet_->GetValue(satellite, index.column());
+    fleet_->SetValue(satellite, index.column(), value);
+    if (fleet_->GetValue(satellite, index.column()) == old_value) {
+        return true;
+    }
+
+    std::vector<int> changed;
+    rules_.Derive(*fleet_, satellite, index.column(), &changed);
+    changed.push_back(index.column());
+
+    // The edit and what it derived are one step of the history.
+    EditHistory::State state = history_.GetCurrent();
+    int left = index.column();
+    int right = index.column();
+    for (int column : changed) {
+        if (fleet_index_) {
+            fleet_index_->Update(satellite, column);
+        }
+        state.values = state.values.Set(satellite * fleet_->GetParameterCount() + column,
+                                        fleet_->GetValue(satellite, column));
+        left = std::min(left, column);
+        right = std::max(right, column);
+    }
+    history_.Push(std::move(state));
+
+    emit dataChanged(this->index(index.row(), left), this->index(index.row(), right),
+                     {Qt::DisplayRole, Qt::EditRole});
+    emit historyChanged();
+    return true;
+}
+
+QVariant FleetModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (role != Qt::DisplayRole) {
+        return {};
+    }
+    if (orientation == Qt::Horizontal) {
+        return fleet_->GetSchema().GetLabel(section);
+    }
+    return satelliteAt(section) + 1;
+}
+
+Qt::ItemFlags FleetModel::flags(const QModelIndex& index) const {
+    // Derived parameters are computed, not typed in.
+    if (index.isValid() && rules_.IsDerived(index.column())) {
+        return QAbstractTableModel::flags(index);
+    }
+    return QAbstractTableModel::flags(index) | Qt::ItemIsEditable;
+}
+
+const Fleet* FleetModel::GetFleet() const {
+    return fleet_;
+}
+
+const ParameterRules& FleetModel::GetRules() const {
+    return rules_;
+}
+
+int FleetModel::satelliteAt(int row) const {
+    return is_filtered_ ? rows_[row] : row;
+}
+
+void FleetModel::addSatellite() {
+    startHistory();
+    const int satellite = fleet_->GetSatelliteCount();
+    const int row = rowCount();
+    beginInsertRows(QModelIndex(), row, row);
+    fleet_->AddSatellite();
+    if (is_filtered_) {
+        rows_.push_back(satellite);
+    }
+    endInsertRows();
+    if (fleet_index_) {
+        fleet_index_->UpdateSatelliteCount();
+    }
+
+    // Cells of a row removed by undo are overwritten, not appended again.
+    EditHistory::State state = history_.GetCurrent();
+    for (int column = 0; column < fleet_->GetParameterCount(); ++column) {
+        const int cell = satellite * fleet_->GetParameterCount() + column;
+        QVariant value = fleet_->GetValue(satellite, column);
+        state.values = cell < state.values.size() ? state.values.Set(cell, std::move(value))
+                                                  : state.values.PushBack(std::move(value));
+    }
+    state.row_count = satellite + 1;
+    history_.Push(std::move(state));
+    emit historyChanged();
+}
+
+void FleetModel::startHistory() {
+    if (history_.IsStarted()) {
+        return;
+    }
+
+    const int satellite_count = fleet_->GetSatelliteCount();
+    original_values_.clear();
+    history_.Reset({PersistentVector<QVariant>::Filled(satellite_count * fleet_->GetParameterCount(), QVariant()),
+                    satellite_count});
+}
+
+void FleetModel::keepOriginalRow(int satellite) {
+    const int columns = fleet_->GetParameterCount();
+    const int first_cell = satellite * columns;
+    // Rows added since the start are in the history whole.
+    if (first_cell >= history_.GetCurrent().values.size() || history_.GetCurrent().values.Get(first_cell).isValid() ||
+        original_values_.contains(first_cell)) {
+        return;
+    }
+    for (int column = 0; column < columns; ++column) {
+        original_values_.insert(first_cell + column, fleet_->GetValue(satellite, column));
+    }
+}
+
+QVariant FleetModel::cellValue(const EditHistory::State& state, int cell) const {
+    const QVariant& value = state.values.Get(cell);
+    return value.isValid() ? value : original_values_.value(cell);
+}
+
+void FleetModel::applyState(const EditHistory::State& from, const EditHistory::State& to) {
+    const int columns = fleet_->GetParameterCount();
+
+    if (from.row_count != to.row_count) {
+        beginResetModel();
+        fleet_->Resize(to.row_count);
+        // Rows coming back may have been edited after they were removed.
+        for (int row = from.row_count; row < to.row_count; ++row) {
+            for (int column = 0; column < columns; ++column) {
+                fleet_->SetValue(row, column, cellValue(to, row * columns + column));
+            }
+        }
+    }
+
+    const int cells = std::min(from.row_count, to.row_count) * columns;
+    int top = to.row_count;
+    int bottom = -1;
+    int left = columns;
+    int right = -1;
+    PersistentVector<QVariant>::ForEachDifference(from.values, to.values, [&](int cell) {
+        if (cell >= cells) {
+            return;
+        }
+        const int row = cell / columns;
+        const int column = cell % columns;
+        fleet_->SetValue(row, column, cellValue(to, cell));
+        if (fleet_index_) {
+            fleet_index_->Update(row, column);
+        }
+        top = std::min(top, row);
+        bottom = std::max(bottom, row);
+        left = std::min(left, column);
+        right = std::max(right, column);
+    });
+
+    if (fleet_index_) {
+        fleet_index_->UpdateSatelliteCount();
+    }
+
+    if (from.row_count != to.row_count) {
+        // Satellites removed by the change must leave the filtered rows.
+        if (is_filtered_) {
+            rows_ = fleet_index_->Query(filter_);
+        }
+        endResetModel();
+    } else if (bottom >= 0) {
+        // top and bottom are satellites; filtered rows are refreshed whole.
+        if (is_filtered_) {
+            top = 0;
+            bottom = rowCount() - 1;
+        }
+        if (bottom >= 0) {
+            emit dataChanged(index(top, left), index(bottom, right), {Qt::DisplayRole, Qt::EditRole});
+        }
+    }
+    emit historyChanged();
+}
+
+std::vector<int> FleetModel::findSatellites(const FleetQuery& query) {
+    if (!fleet_index_) {
+        fleet_index_.reset(new FleetIndex(fleet_, defaultIndexedColumns()));
+    }
+    return fleet_index_->Query(query);
+}
+
+void FleetModel::setFilter(const FleetQuery& query) {
+    beginResetModel();
+    is_filtered_ = !query.empty();
+    filter_ = query;
+    rows_ = is_filtered_ ? findSatellites(query) : std::vector<int>();
+    endResetModel();
+}
+
+bool FleetModel::isFiltered() const {
+    return is_filtered_;
+}
+
+bool FleetModel::canUndo() const {
+    return history_.CanUndo();
+}
+
+bool FleetModel::canRedo() const {
+    return history_.CanRedo();
+}
+
+void FleetModel::undo() {
+    if (!history_.CanUndo()) {
+        return;
+    }
+    EditHistory::State from = history_.GetCurrent();
+    applyState(from, history_.Undo());
+}
+
+void FleetModel::redo() {
+    if (!history_.CanRedo()) {
+        return;
+    }
+    EditHistory::State from = history_.GetCurrent();
+    applyState(from, history_.Redo());
+}
+
+void FleetModel::setCheckpoint(const QString& name) {
+    startHistory();
+    history_.SetCheckpoint(name);
+}
+
+QStringList FleetModel::checkpointNames() const {
+    return history_.GetCheckpointNames();
+}
+
+bool FleetModel::restoreCheckpoint(const QString& name) {
+    const EditHistory::State* checkpoint = history_.GetCheckpoint(name);
+    if (!checkpoint) {
+        return false;
+    }
+
+    EditHistory::State from = history_.GetCurrent();
+    history_.Push(*checkpoint);
+    applyState(from, history_.GetCurrent());
+    return true;
+}
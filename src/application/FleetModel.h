@@ -0,0 +1,102 @@
+#pragma once
+
+#include "EditHistory.h"
+#include "Fleet.h"
+#include "FleetIndex.h"
+#include "ParameterRules.h"
+
+#include <QAbstractTableModel>
+#include <QHash>
+#include <memory>
+
+// Table model with one row per satellite and one column per parameter.
+// Every edit goes through it and is recorded in an EditHistory of the cells,
+// row by row. The history starts at the first edit with every cell unset,
+// in O(log n) memory; the old values of a row are copied only when it is
+// first edited, so neither opening nor first editing a large fleet pays for
+// the whole table. Likewise the FleetIndex behind filters is built
+// by the first query and then kept up to date by every edit. While a filter
+// is set, rows are the matching satellites only. An edit re-derives the
+// dependent columns of its row through the orbit rules, and derived columns
+// cannot be edited.
+class FleetModel : public QAbstractTableModel {
+    Q_OBJECT
+
+    Fleet* fleet_;
+
+    // Refer to the schema of fleet_.
+    ParameterRules rules_;
+
+    // Cells the history does not hold (an invalid QVariant) keep the value
+    // they had when it started, copied here row by row on first edit.
+    EditHistory history_;
+    QHash<int, QVariant> original_values_;
+
+    std::unique_ptr<FleetIndex> fleet_index_;
+
+    FleetQuery filter_;
+    bool is_filtered_ = false;
+    // Satellite shown in each row while filtered.
+    std::vector<int> rows_;
+
+    int satelliteAt(int row) const;
+
+    void startHistory();
+
+    // Copies the values of the row before its first edit.
+    void keepOriginalRow(int satellite);
+
+    QVariant cellValue(const EditHistory::State& state, int cell) const;
+
+    // Sets the cells that differ between the states.
+    void applyState(const EditHistory::State& from, const EditHistory::State& to);
+
+public:
+    explicit FleetModel(Fleet* fleet, QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole) override;
+
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    Qt::ItemFlags flags(const QModelIndex& index) const override;
+
+    const Fleet* GetFleet() const;
+
+    const ParameterRules& GetRules() const;
+
+    void addSatellite();
+
+    // Satellites matching the query, in ascending order.
+    std::vector<int> findSatellites(const FleetQuery& query);
+
+    // Shows only the satellites matching the query, or all of them for an
+    // empty one. Rows are not re-filtered as they are edited; satellites
+    // added while filtered are shown.
+    void setFilter(const FleetQuery& query);
+
+    bool isFiltered() const;
+
+    bool canUndo() const;
+
+    bool canRedo() const;
+
+    void undo();
+
+    void redo();
+
+    void setCheckpoint(const QString& name);
+
+    QStringList checkpointNames() const;
+
+    // Returns to a checkpoint as a new, undoable edit.
+    bool restoreCheckpoint(const QString& name);
+
+signals:
+    void historyChanged();
+};
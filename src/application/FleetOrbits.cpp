@@ -0,0 +1,43 @@
+#include "FleetOrbits.h"
+
+namespace {
+
+const char* const kApogee = "apogee";
+const char* const kPerigee = "perigee";
+const char* const kEccentricity = "eccentricity";
+const char* const kInclination = "inclination";
+const char* const kArgPerigee = "argPerigee";
+const char* const kMeanAnomaly = "meanAnomaly";
+
+double modifiedValue(const ParameterStore& parameters, const char* name) {
+    return parameters.GetModifiedValue(QString::fromLatin1(name)).toDouble();
+}
+
+std::vector<double> fleetColumn(const Fleet& fleet, const char* name) {
+    int column = fleet.GetSchema().Find(QString::fromLatin1(name));
+    if (column < 0 || fleet.GetSchema().GetType(column) != TYPE_PARAMETER::DoubleSpinBox) {
+        return std::vector<double>(fleet.GetSatelliteCount(), 0.0);
+    }
+    return fleet.GetDoubles(column);
+}
+
+}  // namespace
+
+OrbitalElements orbitalElements(const ParameterStore& parameters) {
+    OrbitalElements elements;
+    elements.push_back(modifiedValue(parameters, kApogee), modifiedValue(parameters, kPerigee),
+                       modifiedValue(parameters, kEccentricity), modifiedValue(parameters, kInclination),
+                       modifiedValue(parameters, kArgPerigee), modifiedValue(parameters, kMeanAnomaly));
+    return elements;
+}
+
+OrbitalElements orbitalElements(const Fleet& fleet) {
+    OrbitalElements elements;
+    elements.apogees = fleetColumn(fleet, kApogee);
+    elements.perigees = fleetColumn(fleet, kPerigee);
+    elements.eccentricities = fleetColumn(fleet, kEccentricity);
+    elements.inclinations = fleetColumn(fleet, kInclination);
+    elements.arg_perigees = fleetColumn(fleet, kArgPerigee);
+    elements.mean_anomalies = fleetColumn(fleet, kMeanAnomaly);
+    return elements;
+}
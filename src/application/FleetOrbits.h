@@ -0,0 +1,12 @@
+#pragma once
+
+#include "Fleet.h"
+#include "OrbitPropagator.h"
+#include "ParameterStore.h"
+
+// Orbital elements of the single satellite described by a parameter store,
+// taken from its modified (possibly unsaved) values.
+OrbitalElements orbitalElements(const ParameterStore& parameters);
+
+// Orbital elements of every satellite of a fleet, copied column by column.
+OrbitalElements orbitalElements(const Fleet& fleet);
@@ -0,0 +1,267 @@
+#include "FleetWindow.h"
+#include "ConfigDocument.h"
+#include "ConjunctionScreening.h"
+#include "DefaultParameters.h"
+#include "FleetColumns.h"
+#include "FleetOrbits.h"
+#include "TleCatalog.h"
+
+FleetWindow::FleetWindow(QWidget* parent, QString fleet_file, const QString& tle_file) : fleet_file_(std::move(
+    fleet_file)), fleet_(createDefaultParameters()) {
+    ConfigError error;
+    if (!fleet_.Load(fleet_file_, &error) && error.offset >= 0) {
+        qWarning("Could not load %s: %s", qPrintable(fleet_file_), qPrintable(error.toString()));
+    }
+
+    if (!tle_file.isEmpty()) {
+        importTle(tle_file);
+    }
+
+    if (fleet_.GetSatelliteCount() == 0) {
+        fleet_.AddSatellite();
+    }
+
+    validateFleet();
+
+    main_window_ = new QWidget(parent);
+    main_layout_ = new QVBoxLayout();
+    filter_edit_ = new QLineEdit();
+    filter_label_ = new QLabel();
+    table_view_ = new QTableView();
+    model_ = new FleetModel(&fleet_, table_view_);
+    delegate_ = new FleetDelegate(&fleet_, table_view_);
+    add_button_ = new QPushButton("Add satellite");
+    undo_button_ = new QPushButton("Undo");
+    redo_button_ = new QPushButton("Redo");
+    checkpoint_button_ = new QPushButton("Checkpoint...");
+    restore_button_ = new QPushButton("Restore...");
+    conjunctions_button_ = new QPushButton("Conjunctions...");
+    export_button_ = new QPushButton("Export columns...");
+    save_button_ = new QPushButton("Save");
+
+    main_window_->resize(kWeightMainWindow, kHeightMainWindow);
+    main_window_->setWindowTitle(kNameMainWindow);
+
+    // Fixed row heights keep the view from measuring every row of the fleet.
+    table_view_->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    table_view_->verticalHeader()->setDefaultSectionSize(kRowHeight);
+    table_view_->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
+    table_view_->setModel(model_);
+    table_view_->setItemDelegate(delegate_);
+
+    filter_edit_->setPlaceholderText("Filter, e.g. status=true inclination=97..99 altitude<600");
+    auto* filter_layout = new QHBoxLayout();
+    filter_layout->addWidget(filter_edit_);
+    filter_layout->addWidget(filter_label_);
+
+    auto* buttons_layout = new QHBoxLayout();
+    buttons_layout->addStretch();
+    buttons_layout->addWidget(add_button_);
+    buttons_layout->addWidget(undo_button_);
+    buttons_layout->addWidget(redo_button_);
+    buttons_layout->addWidget(checkpoint_button_);
+    buttons_layout->addWidget(restore_button_);
+    buttons_layout->addWidget(conjunctions_button_);
+    buttons_layout->addWidget(export_button_);
+    buttons_layout->addWidget(save_button_);
+
+    main_layout_->addLayout(filter_layout);
+    main_layout_->addWidget(table_view_);
+    main_layout_->addLayout(buttons_layout);
+    main_window_->setLayout(main_layout_);
+
+    QObject::connect(filter_edit_, &QLineEdit::textChanged, [&](const QString& text) {
+        applyFilter(text);
+    });
+
+    QObject::connect(add_button_, &QPushButton::clicked, [&]() {
+        model_->addSatellite();
+        table_view_->scrollToBottom();
+    });
+
+    QObject::connect(save_button_, &QPushButton::clicked, [&]() {
+        saveFleet(true);
+    });
+
+    QObject::connect(undo_button_, &QPushButton::clicked, [&]() {
+        model_->undo();
+    });
+    QObject::connect(redo_button_, &QPushButton::clicked, [&]() {
+        model_->redo();
+    });
+    QObject::connect(new QShortcut(QKeySequence::Undo, main_window_), &QShortcut::activated, [&]() {
+        model_->undo();
+    });
+    QObject::connect(new QShortcut(QKeySequence::Redo, main_window_), &QShortcut::activated, [&]() {
+        model_->redo();
+    });
+    QObject::connect(checkpoint_button_, &QPushButton::clicked, [&]() {
+        bool ok = false;
+        QString name = QInputDialog::getText(main_window_, "Checkpoint", "Name:", QLineEdit::Normal, QString(), &ok);
+        if (ok && !name.isEmpty()) {
+            model_->setCheckpoint(name);
+        }
+    });
+    QObject::connect(restore_button_, &QPushButton::clicked, [&]() {
+        QStringList names = model_->checkpointNames();
+        if (names.isEmpty()) {
+            return;
+        }
+        bool ok = false;
+        QString name = QInputDialog::getItem(main_window_, "Restore checkpoint", "Checkpoint:", names, 0, false, &ok);
+        if (ok) {
+            model_->restoreCheckpoint(name);
+        }
+    });
+    QObject::connect(conjunctions_button_, &QPushButton::clicked, [&]() {
+        screenConjunctions();
+    });
+    QObject::connect(export_button_, &QPushButton::clicked, [&]() {
+        bool ok = false;
+        QString file = QInputDialog::getText(main_window_, "Export columns", "File:", QLineEdit::Normal,
+                                             QFileInfo(fleet_file_).completeBaseName() + ".columns", &ok);
+        if (ok && !file.isEmpty()) {
+            exportColumns(file);
+        }
+    });
+    QObject::connect(model_, &FleetModel::historyChanged, main_window_, [&]() {
+        updateHistoryButtons();
+        updateFilterLabel();
+    });
+    updateHistoryButtons();
+    updateFilterLabel();
+}
+
+void FleetWindow::screenConjunctions() {
+    ScreeningOptions options;
+    const std::vector<CloseApproach> approaches = ::screenConjunctions(orbitalElements(fleet_), options);
+    const double hours = options.duration / 3600.0;
+
+    QString text;
+    if (approaches.empty()) {
+        text = QString("No satellites come within %1 km of each other in the next %2 h.")
+                   .arg(options.threshold).arg(hours);
+    } else {
+        text = QString("%1 close approaches within %2 km in the next %3 h, closest first:\n")
+                   .arg(approaches.size()).arg(options.threshold).arg(hours);
+    }
+    for (size_t i = 0; i < approaches.size() && i < kMaxReportedConjunctions; ++i) {
+        const CloseApproach& approach = approaches[i];
+        text += QString("\nsatellites %1 and %2: %3 km at +%4 s").arg(approach.first + 1).arg(approach.second + 1)
+                    .arg(approach.distance, 0, 'f', 3).arg(approach.time, 0, 'f', 0);
+    }
+
+    showReport("Conjunctions", text);
+}
+
+void FleetWindow::updateHistoryButtons() {
+    undo_button_->setEnabled(model_->canUndo());
+    redo_button_->setEnabled(model_->canRedo());
+}
+
+void FleetWindow::applyFilter(const QString& text) {
+    FleetQuery query;
+    QString message;
+    if (!parseFleetQuery(text, fleet_.GetSchema(), query, &message)) {
+        filter_label_->setText(message);
+        return;
+    }
+    model_->setFilter(query);
+    updateFilterLabel();
+}
+
+void FleetWindow::updateFilterLabel() {
+    if (model_->isFiltered()) {
+        filter_label_->setText(QString("%1 of %2 satellites").arg(model_->rowCount()).arg(fleet_.GetSatelliteCount()));
+    } else {
+        filter_label_->setText(QString("%1 satellites").arg(fleet_.GetSatelliteCount()));
+    }
+}
+
+FleetWindow::~FleetWindow() {
+    saveFleet();
+
+    delete main_window_;
+}
+
+void FleetWindow::saveFleet(bool is_save_button) {
+    const std::vector<RuleViolation> violations = model_->GetRules().Validate(fleet_);
+    QString message;
+    QString text;
+    if (violations.empty()) {
+        if (fleet_.Save(fleet_file_, &message)) {
+            return;
+        }
+        text = QString("Could not save %1: %2\n").arg(fleet_file_, message);
+    } else {
+        text = "The fleet has not been saved:\n" + describeViolations(violations);
+    }
+    if (is_save_button) {
+        showReport("Saving...", text);
+        return;
+    }
+
+    // Closing the window must not lose the edits.
+    const QString unsaved_file = ConfigDocument::unsavedFileFor(fleet_file_);
+    if (fleet_.Save(unsaved_file, &message)) {
+        text += "The edited fleet is kept in " + unsaved_file;
+    } else {
+        text += QString("Could not keep the edited fleet in %1: %2").arg(unsaved_file, message);
+    }
+    qWarning("%s", qPrintable(text));
+}
+
+void FleetWindow::importTle(const QString& tle_file) {
+    std::vector<TleError> errors;
+    const int count = fleet_.GetSatelliteCount();
+
+    bool ok = importTleCatalog(tle_file, fleet_, &errors);
+
+    for (size_t i = 0; i < errors.size() && i < kMaxReportedTleErrors; ++i) {
+        qWarning("%s: %s", qPrintable(tle_file), qPrintable(errors[i].toString()));
+    }
+    if (errors.size() > kMaxReportedTleErrors) {
+        qWarning("%s: %d more skipped records", qPrintable(tle_file),
+                 static_cast<int>(errors.size()) - kMaxReportedTleErrors);
+    }
+    if (ok) {
+        qInfo("Imported %d satellites from %s", fleet_.GetSatelliteCount() - count, qPrintable(tle_file));
+    }
+}
+
+void FleetWindow::exportColumns(const QString& file) {
+    QString message;
+    if (!exportFleetColumns(fleet_, file, &message)) {
+        qWarning("%s", qPrintable(message));
+        return;
+    }
+    qInfo("Exported %d satellites to %s", fleet_.GetSatelliteCount(), qPrintable(file));
+}
+
+void FleetWindow::validateFleet() {
+    std::vector<RuleViolation> violations = createDefaultRules(fleet_.GetSchema()).Validate(fleet_);
+    if (!violations.empty()) {
+        qWarning("%s:\n%s", qPrintable(fleet_file_), qPrintable(describeViolations(violations)));
+    }
+}
+
+QString FleetWindow::describeViolations(const std::vector<RuleViolation>& violations) const {
+    QString text;
+    for (size_t i = 0; i < violations.size() && i < kMaxReportedViolations; ++i) {
+        text += QString("satellite %1: %2\n").arg(violations[i].satellite + 1).arg(violations[i].message);
+    }
+    if (violations.size() > kMaxReportedViolations) {
+        text += QString("%1 more rule violations\n").arg(static_cast<int>(violations.size()) - kMaxReportedViolations);
+    }
+    return text;
+}
+
+void FleetWindow::showReport(const QString& title, const QString& text) {
+    auto* message_box = new QMessageBox(QMessageBox::Information, title, text, QMessageBox::Ok, main_window_);
+    message_box->setAttribute(Qt::WA_DeleteOnClose);
+    message_box->open();
+}
+
+void FleetWindow::show() {
+    main_window_->show();
+}
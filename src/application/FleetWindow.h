@@ -0,0 +1,89 @@
+#pragma once
+
+#include "Fleet.h"
+#include "FleetDelegate.h"
+#include "FleetModel.h"
+
+#include <QBoxLayout>
+#include <QFileInfo>
+#include <QHeaderView>
+#include <QInputDialog>
+#include <QLabel>
+#include <QLineEdit>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QShortcut>
+#include <QTableView>
+#include <QWidget>
+
+// Fleet mode: every satellite of a fleet file in a single QTableView. Editors
+// are created by FleetDelegate on demand, so memory follows the viewport.
+class FleetWindow {
+private:
+    QString fleet_file_;
+
+    Fleet fleet_;
+
+    QWidget* main_window_;
+    QVBoxLayout* main_layout_;
+    QLineEdit* filter_edit_;
+    QLabel* filter_label_;
+    QTableView* table_view_;
+    FleetModel* model_;
+    FleetDelegate* delegate_;
+
+    QPushButton* add_button_;
+    QPushButton* undo_button_;
+    QPushButton* redo_button_;
+    QPushButton* checkpoint_button_;
+    QPushButton* restore_button_;
+    QPushButton* conjunctions_button_;
+    QPushButton* export_button_;
+    QPushButton* save_button_;
+
+    static const int kWeightMainWindow = 1200;
+    static const int kHeightMainWindow = 800;
+    static const int kRowHeight = 25;
+    static const int kMaxReportedTleErrors = 20;
+    static const int kMaxReportedViolations = 20;
+    static const int kMaxReportedConjunctions = 50;
+
+    const QString kNameMainWindow = "Satellite Fleet";
+
+    // One line per violation, at most kMaxReportedViolations of them.
+    QString describeViolations(const std::vector<RuleViolation>& violations) const;
+
+    void showReport(const QString& title, const QString& text);
+
+public:
+    // A non-empty tle_file is imported after the fleet file is loaded.
+    explicit FleetWindow(QWidget* parent = nullptr, QString fleet_file = "fleet.json", const QString& tle_file = "");
+
+    ~FleetWindow();
+
+    // Saves the fleet unless a satellite breaks the orbit rules. Then the
+    // save button shows the violations, while the save on exit writes the
+    // fleet to ConfigDocument::unsavedFileFor() instead.
+    void saveFleet(bool is_save_button = false);
+
+    void importTle(const QString& tle_file);
+
+    // Writes the fleet as chunked columns for analysis, see FleetColumns.h.
+    void exportColumns(const QString& file);
+
+    // Checks every satellite against the orbit rules and logs violations.
+    void validateFleet();
+
+    // Lists the closest approaches between satellites over the next day.
+    void screenConjunctions();
+
+    void updateHistoryButtons();
+
+    // Shows the satellites matching a query typed into the filter bar, see
+    // parseFleetQuery(). An invalid query keeps the previous filter.
+    void applyFilter(const QString& text);
+
+    void updateFilterLabel();
+
+    void show();
+};
@@ -0,0 +1,105 @@
+#include "NameIndex.h"
+
+#include <algorithm>
+
+namespace {
+
+const uint kFnvOffset = 2166136261u;
+const uint kFnvPrime = 16777619u;
+
+}  // namespace
+
+uint NameIndex::hashName(const QString& name) {
+    uint hash = kFnvOffset;
+    for (const QChar& c : name) {
+        hash = (hash ^ c.unicode()) * kFnvPrime;
+    }
+    return hash;
+}
+
+void NameIndex::grow() {
+    std::vector<Entry> entries(std::max<size_t>(kMinCapacity, entries_.size() * 2));
+    const size_t mask = entries.size() - 1;
+
+    for (auto& entry : entries_) {
+        if (entry.slot < 0) {
+            continue;
+        }
+        size_t position = entry.hash & mask;
+        while (entries[position].slot >= 0) {
+            position = (position + 1) & mask;
+        }
+        entries[position] = std::move(entry);
+    }
+    entries_.swap(entries);
+}
+
+int NameIndex::find(uint hash, const QString& name) const {
+    if (entries_.empty()) {
+        return -1;
+    }
+    const size_t mask = entries_.size() - 1;
+    for (size_t position = hash & mask; entries_[position].slot >= 0; position = (position + 1) & mask) {
+        if (entries_[position].hash == hash && entries_[position].name == name) {
+            return entries_[position].slot;
+        }
+    }
+    return -1;
+}
+
+void NameIndex::Insert(const QString& name, int slot) {
+    // Keeps the load factor at or below one half.
+    if (static_cast<size_t>(count_ + 1) * 2 > entries_.size()) {
+        grow();
+    }
+
+    const uint hash = hashName(name);
+    const size_t mask = entries_.size() - 1;
+    size_t position = hash & mask;
+    while (entries_[position].slot >= 0) {
+        if (entries_[position].hash == hash && entries_[position].name == name) {
+            entries_[position].slot = slot;
+            return;
+        }
+        position = (position + 1) & mask;
+    }
+
+    entries_[position].hash = hash;
+    entries_[position].slot = slot;
+    entries_[position].name = name;
+    ++count_;
+}
+
+int NameIndex::Find(const QString& name) const {
+    return find(hashName(name), name);
+}
+
+int NameIndex::Find(const char* utf8, int size) const {
+    // ASCII bytes hash the same as their UTF-16 code units.
+    uint hash = kFnvOffset;
+    for (int i = 0; i < size; ++i) {
+        if (static_cast<unsigned char>(utf8[i]) >= 0x80) {
+            return Find(QString::fromUtf8(utf8, size));
+        }
+        hash = (hash ^ static_cast<unsigned char>(utf8[i])) * kFnvPrime;
+    }
+
+    if (entries_.empty()) {
+        return -1;
+    }
+    const size_t mask = entries_.size() - 1;
+    for (size_t position = hash & mask; entries_[position].slot >= 0; position = (position + 1) & mask) {
+        const Entry& entry = entries_[position];
+        if (entry.hash != hash || entry.name.size() != size) {
+            continue;
+        }
+        int i = 0;
+        while (i < size && entry.name.at(i) == QLatin1Char(utf8[i])) {
+            ++i;
+        }
+        if (i == size) {
+            return entry.slot;
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <QString>
+#include <vector>
+
+// Open-addressing hash table from parameter name to slot. Lookups cost one
+// hash and usually one probe, independent of the number of parameters, and
+// UTF-8 keys straight from a config file are matched without building a
+// QString first.
+class NameIndex {
+    struct Entry {
+        uint hash = 0;
+        int slot = -1;
+        QString name;
+    };
+
+    std::vector<Entry> entries_;
+    int count_ = 0;
+
+    static const uint kMinCapacity = 16;
+
+    void grow();
+
+    int find(uint hash, const QString& name) const;
+
+public:
+    static uint hashName(const QString& name);
+
+    void Insert(const QString& name, int slot);
+
+    // Returns the slot of the name or -1.
+    int Find(const QString& name) const;
+
+    int Find(const char* utf8, int size) const;
+};
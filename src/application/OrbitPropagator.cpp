@@ -0,0 +1,182 @@
+#include "OrbitPropagator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace {
+
+const double kPi = 3.14159265358979323846;
+const double kTwoPi = 2.0 * kPi;
+const double kHalfPi = 0.5 * kPi;
+const double kDegToRad = kPi / 180.0;
+
+// Sine for |x| <= 3*pi/2, reflected into [-pi/2, pi/2] and evaluated with a
+// degree-13 Taylor polynomial (error below 1e-9). No branches or calls, so
+// loops that use it vectorize.
+inline double fastSin(double x) {
+    x = x > kHalfPi ? kPi - x : x;
+    x = x < -kHalfPi ? -kPi - x : x;
+    const double x2 = x * x;
+    return x * (1.0 + x2 * (-1.0 / 6 + x2 * (1.0 / 120 + x2 * (-1.0 / 5040 + x2 * (1.0 / 362880 +
+           x2 * (-1.0 / 39916800 + x2 * (1.0 / 6227020800.0)))))));
+}
+
+// Cosine for |x| <= pi + 1 (cos is even, so |x| is shifted into range).
+inline double fastCos(double x) {
+    return fastSin(kHalfPi - std::abs(x));
+}
+
+}  // namespace
+
+constexpr double OrbitPropagator::kEarthRadius;
+constexpr double OrbitPropagator::kEarthMu;
+constexpr double OrbitPropagator::kMaxEccentricity;
+
+size_t OrbitalElements::size() const {
+    return apogees.size();
+}
+
+void OrbitalElements::push_back(double apogee, double perigee, double eccentricity, double inclination,
+                                double arg_perigee, double mean_anomaly) {
+    apogees.push_back(apogee);
+    perigees.push_back(perigee);
+    eccentricities.push_back(eccentricity);
+    inclinations.push_back(inclination);
+    arg_perigees.push_back(arg_perigee);
+    mean_anomalies.push_back(mean_anomaly);
+}
+
+OrbitPropagator::OrbitPropagator(const OrbitalElements& elements) {
+    const size_t count = elements.size();
+    semi_major_axes_.resize(count);
+    eccentricities_.resize(count);
+    minor_factors_.resize(count);
+    mean_motions_.resize(count);
+    mean_anomalies_.resize(count);
+    cos_arg_perigees_.resize(count);
+    sin_arg_perigees_.resize(count);
+    cos_inclinations_.resize(count);
+    sin_inclinations_.resize(count);
+
+    for (size_t i = 0; i < count; ++i) {
+        const double a = kEarthRadius + 0.5 * (elements.apogees[i] + elements.perigees[i]);
+        const double e = std::min(std::max(elements.eccentricities[i], 0.0), kMaxEccentricity);
+        const double inclination = elements.inclinations[i] * kDegToRad;
+        const double arg_perigee = elements.arg_perigees[i] * kDegToRad;
+
+        semi_major_axes_[i] = a;
+        eccentricities_[i] = e;
+        minor_factors_[i] = a * std::sqrt(1.0 - e * e);
+        mean_motions_[i] = std::sqrt(kEarthMu / (a * a * a));
+        mean_anomalies_[i] = elements.mean_anomalies[i] * kDegToRad;
+        cos_arg_perigees_[i] = std::cos(arg_perigee);
+        sin_arg_perigees_[i] = std::sin(arg_perigee);
+        cos_inclinations_[i] = std::cos(inclination);
+        sin_inclinations_[i] = std::sin(inclination);
+    }
+}
+
+size_t OrbitPropagator::size() const {
+    return semi_major_axes_.size();
+}
+
+double OrbitPropagator::GetPeriod(size_t satellite) const {
+    return kTwoPi / mean_motions_[satellite];
+}
+
+void OrbitPropagator::propagateRange(const std::vector<double>& times, size_t begin, size_t end,
+                                     PositionGrid& grid) const {
+    const size_t count = size();
+
+    // Satellites are processed kLanes at a time; every loop below is a
+    // straight-line loop over the lanes, which the compiler turns into SIMD.
+    // Results go through lane arrays so the loops need no aliasing checks.
+    const size_t kLanes = 16;
+
+    for (size_t epoch = 0; epoch < times.size(); ++epoch) {
+        const double t = times[epoch];
+
+        for (size_t first = begin; first < end; first += kLanes) {
+            const size_t lanes = std::min(kLanes, end - first);
+            double m[kLanes];
+            double anomaly[kLanes];
+            double lane_x[kLanes];
+            double lane_y[kLanes];
+            double lane_z[kLanes];
+            const double* a = semi_major_axes_.data() + first;
+            const double* e = eccentricities_.data() + first;
+            const double* b = minor_factors_.data() + first;
+            const double* n = mean_motions_.data() + first;
+            const double* m0 = mean_anomalies_.data() + first;
+            const double* cw = cos_arg_perigees_.data() + first;
+            const double* sw = sin_arg_perigees_.data() + first;
+            const double* ci = cos_inclinations_.data() + first;
+            const double* si = sin_inclinations_.data() + first;
+            double* x = grid.x.data() + epoch * count + first;
+            double* y = grid.y.data() + epoch * count + first;
+            double* z = grid.z.data() + epoch * count + first;
+
+            // Mean anomaly reduced to [-pi, pi]; the eccentric anomaly then
+            // stays within [-pi - 1, pi + 1], inside the fastSin range.
+            for (size_t i = 0; i < lanes; ++i) {
+                const double turns = (m0[i] + n[i] * t) * (1.0 / kTwoPi) + 0.5;
+                double whole = static_cast<double>(static_cast<int>(turns));
+                whole -= whole > turns ? 1.0 : 0.0;
+                m[i] = kTwoPi * (turns - whole) - kPi;
+                anomaly[i] = m[i] + e[i] * fastSin(m[i]);
+            }
+
+            for (int k = 0; k < kNewtonIterations; ++k) {
+                for (size_t i = 0; i < lanes; ++i) {
+                    double value = anomaly[i];
+                    value -= (value - e[i] * fastSin(value) - m[i]) / (1.0 - e[i] * fastCos(value));
+                    value = value < -kPi - 1.0 ? -kPi - 1.0 : value;
+                    anomaly[i] = value > kPi + 1.0 ? kPi + 1.0 : value;
+                }
+            }
+
+            for (size_t i = 0; i < lanes; ++i) {
+                const double px = a[i] * (fastCos(anomaly[i]) - e[i]);
+                const double py = b[i] * fastSin(anomaly[i]);
+
+                const double in_plane = sw[i] * px + cw[i] * py;
+                lane_x[i] = cw[i] * px - sw[i] * py;
+                lane_y[i] = ci[i] * in_plane;
+                lane_z[i] = si[i] * in_plane;
+            }
+            std::copy(lane_x, lane_x + lanes, x);
+            std::copy(lane_y, lane_y + lanes, y);
+            std::copy(lane_z, lane_z + lanes, z);
+        }
+    }
+}
+
+void OrbitPropagator::Propagate(const std::vector<double>& times, PositionGrid& grid, int thread_count) const {
+    const size_t count = size();
+    grid.satellite_count = count;
+    grid.epoch_count = times.size();
+    grid.x.resize(count * times.size());
+    grid.y.resize(count * times.size());
+    grid.z.resize(count * times.size());
+
+    if (thread_count <= 0) {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // Chunks are multiples of 64 satellites so threads never share a cache line.
+    const size_t kAlignment = 64;
+    size_t chunk = (count + thread_count - 1) / thread_count;
+    chunk = (chunk + kAlignment - 1) / kAlignment * kAlignment;
+
+    std::vector<std::thread> threads;
+    for (size_t begin = chunk; begin < count; begin += chunk) {
+        threads.emplace_back([this, &times, &grid, begin, chunk, count]() {
+            propagateRange(times, begin, std::min(begin + chunk, count), grid);
+        });
+    }
+    propagateRange(times, 0, std::min(chunk, count), grid);
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
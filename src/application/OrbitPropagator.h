@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Classical orbital elements of many satellites, one column per element.
+// Angles are in degrees and distances in km, as in the parameter store.
+struct OrbitalElements {
+    std::vector<double> apogees;
+    std::vector<double> perigees;
+    std::vector<double> eccentricities;
+    std::vector<double> inclinations;
+    std::vector<double> arg_perigees;
+    std::vector<double> mean_anomalies;
+
+    size_t size() const;
+
+    void push_back(double apogee, double perigee, double eccentricity, double inclination, double arg_perigee,
+                   double mean_anomaly);
+};
+
+// Positions of every satellite at every epoch in an inertial frame (km),
+// epoch-major: the satellite s at epoch e is at index e * satellite_count + s.
+struct PositionGrid {
+    size_t satellite_count = 0;
+    size_t epoch_count = 0;
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> z;
+};
+
+// Two-body (Keplerian) propagation of a whole fleet over a time grid. The
+// Kepler equation is solved with a fixed number of Newton steps and
+// branch-free trigonometry, so the loop over satellites vectorizes; the
+// satellites are split between threads. The right ascension of the ascending
+// node is not stored by the app and is taken as zero.
+class OrbitPropagator {
+    // Per-satellite constants derived from the elements.
+    std::vector<double> semi_major_axes_;
+    std::vector<double> eccentricities_;
+    std::vector<double> minor_factors_;
+    std::vector<double> mean_motions_;
+    std::vector<double> mean_anomalies_;
+    std::vector<double> cos_arg_perigees_;
+    std::vector<double> sin_arg_perigees_;
+    std::vector<double> cos_inclinations_;
+    std::vector<double> sin_inclinations_;
+
+    void propagateRange(const std::vector<double>& times, size_t begin, size_t end, PositionGrid& grid) const;
+
+public:
+    static constexpr double kEarthRadius = 6378.137;
+    static constexpr double kEarthMu = 398600.4418;
+    static constexpr double kMaxEccentricity = 0.99;
+    static const int kNewtonIterations = 6;
+
+    explicit OrbitPropagator(const OrbitalElements& elements);
+
+    size_t size() const;
+
+    // Orbital period of one satellite (s).
+    double GetPeriod(size_t satellite) const;
+
+    // Fills grid with the positions at the given offsets (s) from the epoch
+    // of the elements. thread_count 0 means one thread per core.
+    void Propagate(const std::vector<double>& times, PositionGrid& grid, int thread_count = 0) const;
+};
@@ -0,0 +1,288 @@
+#include "ParameterRules.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+const double ParameterRules::kDerivedTolerance = 1e-6;
+
+ParameterRules::ParameterRules(const ParameterStore& schema) : schema_(&schema),
+                                                                dependents_(schema.size()) {}
+
+bool ParameterRules::resolve(const std::vector<QString>& names, std::vector<int>& resolved) const {
+    if (names.size() > static_cast<size_t>(kMaxInputs)) {
+        return false;
+    }
+    for (const QString& name : names) {
+        int slot = schema_->Find(name);
+        if (slot < 0) {
+            return false;
+        }
+        resolved.push_back(slot);
+    }
+    return true;
+}
+
+int ParameterRules::addRule(Rule rule) {
+    const int index = static_cast<int>(rules_.size());
+    for (int slot : rule.inputs) {
+        dependents_[slot].push_back(index);
+    }
+    rules_.push_back(std::move(rule));
+    dirty_.push_back(true);
+    violated_.push_back(false);
+    sortRules();
+    return index;
+}
+
+// Kahn's algorithm: a derivation runs before every rule reading its output.
+// Rules caught in a cycle keep their declaration order at the end.
+void ParameterRules::sortRules() {
+    std::vector<int> pending(rules_.size(), 0);
+    for (size_t i = 0; i < rules_.size(); ++i) {
+        for (const Rule& writer : rules_) {
+            if (writer.output >= 0) {
+                pending[i] += std::count(rules_[i].inputs.begin(), rules_[i].inputs.end(), writer.output);
+            }
+        }
+    }
+
+    order_.clear();
+    for (size_t i = 0; i < rules_.size(); ++i) {
+        if (pending[i] == 0) {
+            order_.push_back(static_cast<int>(i));
+        }
+    }
+    for (size_t next = 0; next < order_.size(); ++next) {
+        const Rule& rule = rules_[order_[next]];
+        if (rule.output < 0) {
+            continue;
+        }
+        for (int dependent : dependents_[rule.output]) {
+            if (--pending[dependent] == 0) {
+                order_.push_back(dependent);
+            }
+        }
+    }
+
+    if (order_.size() != rules_.size()) {
+        qWarning("Parameter rules have a cyclic dependency");
+        for (size_t i = 0; i < rules_.size(); ++i) {
+            if (pending[i] > 0) {
+                order_.push_back(static_cast<int>(i));
+            }
+        }
+    }
+}
+
+bool ParameterRules::AddCheck(const std::vector<QString>& inputs, QString message, Check check) {
+    Rule rule;
+    if (!resolve(inputs, rule.inputs)) {
+        return false;
+    }
+    rule.check = std::move(check);
+    rule.message = std::move(message);
+    addRule(std::move(rule));
+    return true;
+}
+
+bool ParameterRules::AddDerivation(const std::vector<QString>& inputs, const QString& output,
+                                   Derivation derive) {
+    Rule rule;
+    rule.output = schema_->Find(output);
+    if (!resolve(inputs, rule.inputs) || rule.output < 0) {
+        return false;
+    }
+    rule.derive = std::move(derive);
+    rule.message = QString("%1 does not follow from %2").arg(output).arg(inputs.empty() ? QString() : inputs[0]);
+    for (size_t i = 1; i < inputs.size(); ++i) {
+        rule.message += (i + 1 == inputs.size() ? " and " : ", ") + inputs[i];
+    }
+    addRule(std::move(rule));
+    return true;
+}
+
+bool ParameterRules::IsDerived(int slot) const {
+    return std::any_of(rules_.begin(), rules_.end(), [slot](const Rule& rule) {
+        return rule.output == slot;
+    });
+}
+
+void ParameterRules::Invalidate(int slot) {
+    for (int dependent : dependents_[slot]) {
+        if (dirty_[dependent]) {
+            continue;
+        }
+        dirty_[dependent] = true;
+        if (rules_[dependent].output >= 0) {
+            Invalidate(rules_[dependent].output);
+        }
+    }
+}
+
+void ParameterRules::InvalidateAll() {
+    std::fill(dirty_.begin(), dirty_.end(), true);
+}
+
+void ParameterRules::Update(ParameterStore& parameters, std::vector<int>* changed) {
+    double inputs[kMaxInputs];
+
+    for (int index : order_) {
+        if (!dirty_[index]) {
+            continue;
+        }
+        dirty_[index] = false;
+
+        const Rule& rule = rules_[index];
+        for (size_t i = 0; i < rule.inputs.size(); ++i) {
+            inputs[i] = parameters.GetModifiedValue(rule.inputs[i]).toDouble();
+        }
+
+        if (rule.output < 0) {
+            violated_[index] = !rule.check(inputs);
+            continue;
+        }
+
+        const double value = rule.derive(inputs);
+        if (parameters.GetModifiedValue(rule.output).toDouble() != value) {
+            parameters.SetModifiedValue(rule.output, value);
+            if (changed) {
+                changed->push_back(rule.output);
+            }
+        }
+    }
+}
+
+std::vector<RuleViolation> ParameterRules::GetViolations() const {
+    std::vector<RuleViolation> violations;
+    for (size_t i = 0; i < rules_.size(); ++i) {
+        if (violated_[i]) {
+            violations.push_back({-1, rules_[i].message});
+        }
+    }
+    return violations;
+}
+
+void ParameterRules::Derive(Fleet& fleet) const {
+    const ParameterStore& schema = fleet.GetSchema();
+    // As in Validate(), double columns are read and written directly.
+    auto read = [&](int slot, int satellite) {
+        if (schema.GetType(slot) == TYPE_PARAMETER::DoubleSpinBox) {
+            return fleet.GetDoubles(slot)[satellite];
+        }
+        return fleet.GetValue(satellite, slot).toDouble();
+    };
+
+    double inputs[kMaxInputs];
+    for (int index : order_) {
+        const Rule& rule = rules_[index];
+        if (rule.output < 0) {
+            continue;
+        }
+        const bool is_double = schema.GetType(rule.output) == TYPE_PARAMETER::DoubleSpinBox;
+        for (int satellite = 0; satellite < fleet.GetSatelliteCount(); ++satellite) {
+            for (size_t i = 0; i < rule.inputs.size(); ++i) {
+                inputs[i] = read(rule.inputs[i], satellite);
+            }
+            const double value = rule.derive(inputs);
+            if (is_double) {
+                fleet.GetDoubles(rule.output)[satellite] = value;
+            } else {
+                fleet.SetValue(satellite, rule.output, value);
+            }
+        }
+    }
+}
+
+void ParameterRules::Derive(Fleet& fleet, int satellite, int column, std::vector<int>* changed) const {
+    // Columns edited or re-derived so far; rules run in dependency order, so
+    // one pass reaches every dependent.
+    std::vector<char> edited(schema_->size(), false);
+    edited[column] = true;
+
+    double inputs[kMaxInputs];
+    for (int index : order_) {
+        const Rule& rule = rules_[index];
+        if (rule.output < 0 || std::none_of(rule.inputs.begin(), rule.inputs.end(), [&](int input) {
+                return edited[input];
+            })) {
+            continue;
+        }
+        for (size_t i = 0; i < rule.inputs.size(); ++i) {
+            inputs[i] = fleet.GetValue(satellite, rule.inputs[i]).toDouble();
+        }
+
+        const double value = rule.derive(inputs);
+        if (fleet.GetValue(satellite, rule.output).toDouble() != value) {
+            fleet.SetValue(satellite, rule.output, value);
+            edited[rule.output] = true;
+            if (changed) {
+                changed->push_back(rule.output);
+            }
+        }
+    }
+}
+
+std::vector<RuleViolation> ParameterRules::Validate(const Fleet& fleet, int thread_count) const {
+    const int satellite_count = fleet.GetSatelliteCount();
+
+    // Every input is read from its column directly; only non-double
+    // parameters go through QVariant.
+    auto read = [&fleet](int slot, int satellite) {
+        if (fleet.GetSchema().GetType(slot) == TYPE_PARAMETER::DoubleSpinBox) {
+            return fleet.GetDoubles(slot)[satellite];
+        }
+        return fleet.GetValue(satellite, slot).toDouble();
+    };
+
+    auto validateRange = [&](int begin, int end, std::vector<std::pair<int, int>>& found) {
+        double inputs[kMaxInputs];
+        for (int satellite = begin; satellite < end; ++satellite) {
+            for (size_t index = 0; index < rules_.size(); ++index) {
+                const Rule& rule = rules_[index];
+                for (size_t i = 0; i < rule.inputs.size(); ++i) {
+                    inputs[i] = read(rule.inputs[i], satellite);
+                }
+
+                bool ok = true;
+                if (rule.output < 0) {
+                    ok = rule.check(inputs);
+                } else {
+                    const double expected = rule.derive(inputs);
+                    const double actual = read(rule.output, satellite);
+                    ok = std::abs(actual - expected) <= kDerivedTolerance * std::max(1.0, std::abs(expected));
+                }
+                if (!ok) {
+                    found.push_back({satellite, static_cast<int>(index)});
+                }
+            }
+        }
+    };
+
+    if (thread_count <= 0) {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    thread_count = std::max(1, std::min(thread_count, satellite_count));
+    const int chunk = (satellite_count + thread_count - 1) / thread_count;
+
+    std::vector<std::vector<std::pair<int, int>>> found(thread_count);
+    std::vector<std::thread> threads;
+    for (int i = 1; i < thread_count; ++i) {
+        threads.emplace_back([&, i]() {
+            validateRange(std::min(i * chunk, satellite_count), std::min((i + 1) * chunk, satellite_count),
+                          found[i]);
+        });
+    }
+    validateRange(0, std::min(chunk, satellite_count), found[0]);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::vector<RuleViolation> violations;
+    for (const auto& part : found) {
+        for (const auto& violation : part) {
+            violations.push_back({violation.first, rules_[violation.second].message});
+        }
+    }
+    return violations;
+}
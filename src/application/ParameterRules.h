@@ -0,0 +1,87 @@
+#pragma once
+
+#include "Fleet.h"
+#include "ParameterStore.h"
+
+#include <QString>
+#include <functional>
+#include <vector>
+
+struct RuleViolation {
+    // Fleet row of the violation, -1 for a single parameter store.
+    int satellite = -1;
+    QString message;
+};
+
+// Cross-field checks and derived parameters over numeric parameters. Each
+// rule declares the slots it reads; an edit only marks the rules that depend
+// on the edited slot (and, through derived slots, their dependents) dirty,
+// and Update() re-evaluates just those, in dependency order.
+class ParameterRules {
+public:
+    static const int kMaxInputs = 8;
+
+    typedef std::function<bool(const double* inputs)> Check;
+    typedef std::function<double(const double* inputs)> Derivation;
+
+private:
+    struct Rule {
+        std::vector<int> inputs;
+        // Slot written by a derivation, -1 for a check.
+        int output = -1;
+        Check check;
+        Derivation derive;
+        QString message;
+    };
+
+    const ParameterStore* schema_;
+
+    std::vector<Rule> rules_;
+    // Rules reading each slot.
+    std::vector<std::vector<int>> dependents_;
+    std::vector<int> order_;
+    std::vector<char> dirty_;
+    std::vector<char> violated_;
+
+    static const double kDerivedTolerance;
+
+    bool resolve(const std::vector<QString>& names, std::vector<int>& resolved) const;
+
+    int addRule(Rule rule);
+
+    void sortRules();
+
+public:
+    // Names are resolved against the schema, which must outlive the rules.
+    explicit ParameterRules(const ParameterStore& schema);
+
+    // Returns false if a name is unknown or there are too many inputs.
+    bool AddCheck(const std::vector<QString>& inputs, QString message, Check check);
+
+    bool AddDerivation(const std::vector<QString>& inputs, const QString& output, Derivation derive);
+
+    bool IsDerived(int slot) const;
+
+    void Invalidate(int slot);
+
+    void InvalidateAll();
+
+    // Re-evaluates the dirty rules against the modified values, writing
+    // derived values back. Slots whose value changed are appended to changed.
+    void Update(ParameterStore& parameters, std::vector<int>* changed = nullptr);
+
+    // Violations found by the last Update().
+    std::vector<RuleViolation> GetViolations() const;
+
+    // Recomputes the derived columns of every satellite from their inputs.
+    void Derive(Fleet& fleet) const;
+
+    // Re-derives the columns of one satellite that depend, directly or
+    // through other derived columns, on an edited column. Columns whose value
+    // changed are appended to changed.
+    void Derive(Fleet& fleet, int satellite, int column, std::vector<int>* changed = nullptr) const;
+
+    // Checks every satellite of a fleet, including that derived columns match
+    // their inputs. Satellites are split between threads.
+    std::vector<RuleViolation> Validate(const Fleet& fleet, int thread_count = 0) const;
+};
@@ -0,0 +1,163 @@
+#include "ParameterSchema.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonParseError>
+#include <QSet>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+bool fail(QString* message, const QString& text) {
+    if (message != nullptr) {
+        *message = text;
+    }
+    return false;
+}
+
+bool isIdentifier(const QString& name) {
+    if (name.isEmpty() || name[0].isDigit()) {
+        return false;
+    }
+    for (const QChar c : name) {
+        if (c.unicode() > 127 || !(c.isLetterOrNumber() || c == '_')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool parseType(const QString& name, TYPE_PARAMETER& type) {
+    if (name == "text") {
+        type = TYPE_PARAMETER::LineEdit;
+    } else if (name == "bool") {
+        type = TYPE_PARAMETER::CheckBox;
+    } else if (name == "int") {
+        type = TYPE_PARAMETER::SpinBox;
+    } else if (name == "double") {
+        type = TYPE_PARAMETER::DoubleSpinBox;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// A number member, or fallback when it is omitted.
+bool readNumber(const QJsonObject& object, const QString& key, double fallback, double& value) {
+    if (!object.contains(key)) {
+        value = fallback;
+        return true;
+    }
+    const QJsonValue member = object.value(key);
+    value = member.toDouble();
+    return member.isDouble();
+}
+
+bool parseParameter(const QJsonObject& object, ParameterDefinition& parameter, QString* message) {
+    parameter.name = object.value("name").toString();
+    if (!isIdentifier(parameter.name)) {
+        return fail(message, QString("\"%1\" is not a parameter name.").arg(parameter.name));
+    }
+    if (!parseType(object.value("type").toString(), parameter.type)) {
+        return fail(message, QString("%1 has no type text, bool, int or double.").arg(parameter.name));
+    }
+    parameter.label = object.value("label").toString();
+    parameter.placeholder.clear();
+    parameter.text.clear();
+    parameter.min = 0.0;
+    parameter.max = 0.0;
+    parameter.step = 0.0;
+    parameter.value = 0.0;
+
+    switch (parameter.type) {
+        case TYPE_PARAMETER::LineEdit:
+            parameter.placeholder = object.value("placeholder").toString();
+            parameter.text = object.value("default").toString();
+            return true;
+        case TYPE_PARAMETER::CheckBox:
+            parameter.value = object.value("default").toBool() ? 1.0 : 0.0;
+            return true;
+        case TYPE_PARAMETER::SpinBox:
+        case TYPE_PARAMETER::DoubleSpinBox:
+            break;
+    }
+
+    const bool integer = parameter.type == TYPE_PARAMETER::SpinBox;
+    const double lowest = integer ? std::numeric_limits<int>::min() : std::numeric_limits<double>::lowest();
+    const double highest = integer ? std::numeric_limits<int>::max() : std::numeric_limits<double>::max();
+    // A fresh spin box steps by 1 and starts at 0 clamped into its range.
+    if (!readNumber(object, "min", lowest, parameter.min) || !readNumber(object, "max", highest, parameter.max) ||
+        !readNumber(object, "step", 1.0, parameter.step) ||
+        !readNumber(object, "default", std::min(std::max(0.0, parameter.min), parameter.max), parameter.value)) {
+        return fail(message, QString("%1 has a bound, step or default that is not a number.").arg(parameter.name));
+    }
+    if (integer) {
+        for (double number : {parameter.min, parameter.max, parameter.step, parameter.value}) {
+            if (number != std::floor(number) || number < lowest || number > highest) {
+                return fail(message, QString("%1 has a bound, step or default that is not an int.")
+                    .arg(parameter.name));
+            }
+        }
+    }
+    if (!(parameter.min <= parameter.value && parameter.value <= parameter.max) || !(parameter.step > 0.0)) {
+        return fail(message, QString("%1 has its default outside [min, max] or a step that is not positive.")
+            .arg(parameter.name));
+    }
+    return true;
+}
+
+}  // namespace
+
+bool parseParameterSchema(const QByteArray& json, ParameterSchema& schema, QString* message) {
+    QJsonParseError error;
+    const QJsonDocument document = QJsonDocument::fromJson(json, &error);
+    if (error.error != QJsonParseError::NoError) {
+        return fail(message, QString("%1 at offset %2.").arg(error.errorString()).arg(error.offset));
+    }
+    const QJsonObject root = document.object();
+    schema.name = root.value("name").toString();
+    if (!isIdentifier(schema.name)) {
+        return fail(message, QString("\"%1\" is not a schema name.").arg(schema.name));
+    }
+    schema.parameters.clear();
+    schema.sections.clear();
+
+    QSet<QString> names;
+    for (const QJsonValue section : root.value("sections").toArray()) {
+        const QJsonObject object = section.toObject();
+        schema.sections.push_back({object.value("title").toString(), static_cast<int>(schema.parameters.size())});
+        for (const QJsonValue value : object.value("parameters").toArray()) {
+            ParameterDefinition parameter;
+            if (!parseParameter(value.toObject(), parameter, message)) {
+                return false;
+            }
+            if (names.contains(parameter.name)) {
+                return fail(message, QString("%1 is defined twice.").arg(parameter.name));
+            }
+            names.insert(parameter.name);
+            schema.parameters.push_back(std::move(parameter));
+        }
+    }
+    if (schema.parameters.empty()) {
+        return fail(message, QString("%1 defines no parameters.").arg(schema.name));
+    }
+    return true;
+}
+
+bool loadParameterSchema(const QString& file_name, ParameterSchema& schema, QString* message) {
+    QFile file(file_name);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return fail(message, QString("%1: %2").arg(file_name, file.errorString()));
+    }
+    if (!parseParameterSchema(file.readAll(), schema, message)) {
+        if (message != nullptr) {
+            *message = QString("%1: %2").arg(file_name, *message);
+        }
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Parameters.h"
+
+#include <QByteArray>
+#include <QString>
+#include <vector>
+
+// One parameter of a schema as a constexpr table entry, emitted by
+// QtAppTask-schemac. Numbers are doubles for every type: a CheckBox default
+// is 0 or 1, SpinBox bounds are whole numbers. A LineEdit has placeholder
+// and text instead.
+struct ParameterDescriptor {
+    const char* name;
+    TYPE_PARAMETER type;
+    const char* label;
+    const char* placeholder;
+    const char* text;
+    double min;
+    double max;
+    double step;
+    double value;
+};
+
+// Parameters from slot begin on belong to the section.
+struct SectionDescriptor {
+    const char* title;
+    int begin;
+};
+
+// The same, loaded at runtime.
+struct ParameterDefinition {
+    QString name;
+    TYPE_PARAMETER type;
+    QString label;
+    QString placeholder;
+    QString text;
+    double min;
+    double max;
+    double step;
+    double value;
+};
+
+struct SectionDefinition {
+    QString title;
+    int begin;
+};
+
+// Parameter set of one kind of satellite, as read from a schema file:
+//
+//     {"name": "Satellite", "sections": [{"title": "Orbit", "parameters": [
+//         {"name": "apogee", "type": "double", "label": "Apogee (km):",
+//          "min": 1000, "step": 0.01, "default": 1000}, ...]}, ...]}
+//
+// Types are "text" (with "placeholder"), "bool", "int" and "double". An
+// omitted "min" or "max" leaves that side unbounded; "comment" is ignored.
+struct ParameterSchema {
+    QString name;
+    std::vector<ParameterDefinition> parameters;
+    std::vector<SectionDefinition> sections;
+};
+
+// Checks names (unique C++ identifiers, so the generator can turn them into
+// types), types, and that each default is within its bounds.
+bool parseParameterSchema(const QByteArray& json, ParameterSchema& schema, QString* message = nullptr);
+
+bool loadParameterSchema(const QString& file_name, ParameterSchema& schema, QString* message = nullptr);
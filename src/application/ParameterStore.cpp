@@ -0,0 +1,232 @@
+#include "ParameterStore.h"
+#include "StringPool.h"
+
+constexpr TYPE_PARAMETER LineEditColumn::kType;
+constexpr TYPE_PARAMETER CheckBoxColumn::kType;
+
+int ParameterStore::addSlot(TYPE_PARAMETER type, int index, const QString& name) {
+    slots_.push_back({type, index});
+    index_.Insert(name, size() - 1);
+    Visit(size() - 1, [&](auto& column, int) {
+        column.store_slots.push_back(size() - 1);
+    });
+
+    if (sections_.empty()) {
+        sections_.push_back({QString(), 0, 0});
+    }
+    sections_.back().end = size();
+    return size() - 1;
+}
+
+int ParameterStore::AddLineEdit(QString name, QString original_text, QString data, QString label) {
+    name = StringPool::Intern(name);
+    line_edits_.Append(name, StringPool::Intern(original_text), std::move(data), StringPool::Intern(label));
+    return addSlot(TYPE_PARAMETER::LineEdit, line_edits_.size() - 1, name);
+}
+
+int ParameterStore::AddCheckBox(QString name, QString label, bool status) {
+    name = StringPool::Intern(name);
+    check_boxes_.Append(name, StringPool::Intern(label), status);
+    return addSlot(TYPE_PARAMETER::CheckBox, check_boxes_.size() - 1, name);
+}
+
+int ParameterStore::AddSpinBox(QString name, QString label, int min, int max, int start_value, int step) {
+    name = StringPool::Intern(name);
+    int_spin_boxes_.Append(name, StringPool::Intern(label), min, max, start_value, step);
+    return addSlot(TYPE_PARAMETER::SpinBox, int_spin_boxes_.size() - 1, name);
+}
+
+int ParameterStore::AddSpinBox(QString name, QString label, double min, double max, double start_value,
+                               double step) {
+    name = StringPool::Intern(name);
+    double_spin_boxes_.Append(name, StringPool::Intern(label), min, max, start_value, step);
+    return addSlot(TYPE_PARAMETER::DoubleSpinBox, double_spin_boxes_.size() - 1, name);
+}
+
+int ParameterStore::Add(const LineEditParameter& parameter) {
+    return AddLineEdit(parameter.GetName(), parameter.GetOriginalText(), parameter.GetValue(), parameter.GetLabel());
+}
+
+int ParameterStore::Add(const CheckBoxParameter& parameter) {
+    return AddCheckBox(parameter.GetName(), parameter.GetLabel(), parameter.GetValue());
+}
+
+int ParameterStore::Add(const SpinBoxParameter<int>& parameter) {
+    return AddSpinBox(parameter.GetName(), parameter.GetLabel(), parameter.GetMin(), parameter.GetMax(),
+                      parameter.GetValue(), parameter.GetStep());
+}
+
+int ParameterStore::Add(const SpinBoxParameter<double>& parameter) {
+    return AddSpinBox(parameter.GetName(), parameter.GetLabel(), parameter.GetMin(), parameter.GetMax(),
+                      parameter.GetValue(), parameter.GetStep());
+}
+
+int ParameterStore::size() const {
+    return static_cast<int>(slots_.size());
+}
+
+void ParameterStore::BeginSection(const QString& title) {
+    if (!sections_.empty() && sections_.back().begin == sections_.back().end) {
+        sections_.back().title = StringPool::Intern(title);
+        return;
+    }
+    sections_.push_back({StringPool::Intern(title), size(), size()});
+}
+
+const std::vector<ParameterSection>& ParameterStore::GetSections() const {
+    return sections_;
+}
+
+const ParameterSlot& ParameterStore::GetSlot(int slot) const {
+    return slots_[slot];
+}
+
+TYPE_PARAMETER ParameterStore::GetType(int slot) const {
+    return slots_[slot].type;
+}
+
+const QString& ParameterStore::GetName(int slot) const {
+    return Visit(slot, [](const auto& column, int index) -> const QString& {
+        return column.names[index];
+    });
+}
+
+const QString& ParameterStore::GetLabel(int slot) const {
+    return Visit(slot, [](const auto& column, int index) -> const QString& {
+        return column.labels[index];
+    });
+}
+
+int ParameterStore::Find(const QString& name) const {
+    return index_.Find(name);
+}
+
+int ParameterStore::Find(const char* utf8, int size) const {
+    return index_.Find(utf8, size);
+}
+
+QVariant ParameterStore::GetValue(int slot) const {
+    return Visit(slot, [](const auto& column, int index) {
+        return QVariant(column.GetValue(index));
+    });
+}
+
+QVariant ParameterStore::GetModifiedValue(int slot) const {
+    return Visit(slot, [](const auto& column, int index) {
+        return QVariant(column.GetModifiedValue(index));
+    });
+}
+
+bool ParameterStore::IsInRange(int slot, double value) const {
+    const ParameterSlot& position = slots_[slot];
+    switch (position.type) {
+        case TYPE_PARAMETER::SpinBox:
+            return value >= int_spin_boxes_.mins[position.index] && value <= int_spin_boxes_.maxs[position.index];
+        case TYPE_PARAMETER::DoubleSpinBox:
+            return value >= double_spin_boxes_.mins[position.index] &&
+                   value <= double_spin_boxes_.maxs[position.index];
+        default:
+            return true;
+    }
+}
+
+void ParameterStore::Apply(int slot, const QVariant& value) {
+    const ParameterSlot& position = slots_[slot];
+    switch (position.type) {
+        case TYPE_PARAMETER::LineEdit:
+            line_edits_.SetValue(position.index, value.toString());
+            line_edits_.SetModifiedValue(position.index, value.toString());
+            break;
+        case TYPE_PARAMETER::CheckBox:
+            check_boxes_.SetValue(position.index, value.toBool());
+            check_boxes_.SetModifiedValue(position.index, value.toBool());
+            break;
+        case TYPE_PARAMETER::SpinBox:
+            int_spin_boxes_.SetValue(position.index, value.toInt());
+            int_spin_boxes_.SetModifiedValue(position.index, value.toInt());
+            break;
+        case TYPE_PARAMETER::DoubleSpinBox:
+            double_spin_boxes_.SetValue(position.index, value.toDouble());
+            double_spin_boxes_.SetModifiedValue(position.index, value.toDouble());
+            break;
+    }
+}
+
+void ParameterStore::SetValue(int slot, const QVariant& value) {
+    const ParameterSlot& position = slots_[slot];
+    switch (position.type) {
+        case TYPE_PARAMETER::LineEdit:
+            line_edits_.SetValue(position.index, value.toString());
+            break;
+        case TYPE_PARAMETER::CheckBox:
+            check_boxes_.SetValue(position.index, value.toBool());
+            break;
+        case TYPE_PARAMETER::SpinBox:
+            int_spin_boxes_.SetValue(position.index, value.toInt());
+            break;
+        case TYPE_PARAMETER::DoubleSpinBox:
+            double_spin_boxes_.SetValue(position.index, value.toDouble());
+            break;
+    }
+}
+
+void ParameterStore::SetModifiedValue(int slot, const QVariant& value) {
+    const ParameterSlot& position = slots_[slot];
+    switch (position.type) {
+        case TYPE_PARAMETER::LineEdit:
+            line_edits_.SetModifiedValue(position.index, value.toString());
+            break;
+        case TYPE_PARAMETER::CheckBox:
+            check_boxes_.SetModifiedValue(position.index, value.toBool());
+            break;
+        case TYPE_PARAMETER::SpinBox:
+            int_spin_boxes_.SetModifiedValue(position.index, value.toInt());
+            break;
+        case TYPE_PARAMETER::DoubleSpinBox:
+            double_spin_boxes_.SetModifiedValue(position.index, value.toDouble());
+            break;
+    }
+}
+
+QVariant ParameterStore::GetValue(const QString& name) const {
+    int slot = Find(name);
+    return slot < 0 ? QVariant() : GetValue(slot);
+}
+
+QVariant ParameterStore::GetModifiedValue(const QString& name) const {
+    int slot = Find(name);
+    return slot < 0 ? QVariant() : GetModifiedValue(slot);
+}
+
+bool ParameterStore::SetModifiedValue(const QString& name, const QVariant& value) {
+    int slot = Find(name);
+    if (slot < 0) {
+        return false;
+    }
+    SetModifiedValue(slot, value);
+    return true;
+}
+
+int ParameterStore::CountChanged() const {
+    int count = 0;
+    VisitColumns([&](const auto& column) {
+        count += column.CountChanged();
+    });
+    return count;
+}
+
+const LineEditColumn& ParameterStore::GetLineEdits() const {
+    return line_edits_;
+}
+
+const CheckBoxColumn& ParameterStore::GetCheckBoxes() const {
+    return check_boxes_;
+}
+
+const IntSpinBoxColumn& ParameterStore::GetIntSpinBoxes() const {
+    return int_spin_boxes_;
+}
+
+const DoubleSpinBoxColumn& ParameterStore::GetDoubleSpinBoxes() const {
+    return double_spin_boxes_;
+}
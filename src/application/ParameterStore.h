@@ -0,0 +1,347 @@
+#pragma once
+
+#include "NameIndex.h"
+#include "Parameters.h"
+
+#include <QString>
+#include <QVariant>
+#include <vector>
+
+// Stored and modified values of every parameter of one kind, kept as
+// parallel contiguous arrays. S is the storage type when it differs from the
+// value type (bools are kept as chars so the column stays addressable).
+template<typename T, typename S = T>
+struct ParameterColumn {
+    std::vector<QString> names;
+    std::vector<QString> labels;
+    std::vector<S> values;
+    std::vector<S> modified_values;
+    // Slot of each entry in its ParameterStore.
+    std::vector<int> store_slots;
+
+    int size() const {
+        return static_cast<int>(values.size());
+    }
+
+    T GetValue(int index) const {
+        return static_cast<T>(values[index]);
+    }
+
+    void SetValue(int index, T value) {
+        values[index] = static_cast<S>(std::move(value));
+    }
+
+    T GetModifiedValue(int index) const {
+        return static_cast<T>(modified_values[index]);
+    }
+
+    void SetModifiedValue(int index, T value) {
+        modified_values[index] = static_cast<S>(std::move(value));
+    }
+
+    bool isChanged(int index) const {
+        return values[index] != modified_values[index];
+    }
+
+    // Makes the modified value the stored one.
+    void Commit(int index) {
+        values[index] = modified_values[index];
+    }
+
+    int CountChanged() const {
+        int count = 0;
+        for (size_t i = 0; i < values.size(); ++i) {
+            count += values[i] != modified_values[i];
+        }
+        return count;
+    }
+
+protected:
+    void append(QString name, QString label, T value) {
+        names.push_back(std::move(name));
+        labels.push_back(std::move(label));
+        values.push_back(static_cast<S>(value));
+        modified_values.push_back(static_cast<S>(std::move(value)));
+    }
+};
+
+struct LineEditColumn : ParameterColumn<QString> {
+    static constexpr TYPE_PARAMETER kType = TYPE_PARAMETER::LineEdit;
+
+    std::vector<QString> original_texts;
+
+    void Append(QString name, QString original_text, QString data, QString label) {
+        append(std::move(name), std::move(label), std::move(data));
+        original_texts.push_back(std::move(original_text));
+    }
+};
+
+struct CheckBoxColumn : ParameterColumn<bool, char> {
+    static constexpr TYPE_PARAMETER kType = TYPE_PARAMETER::CheckBox;
+
+    void Append(QString name, QString label, bool status) {
+        append(std::move(name), std::move(label), status);
+    }
+};
+
+template<typename T, TYPE_PARAMETER Type>
+struct SpinBoxColumn : ParameterColumn<T> {
+    static constexpr TYPE_PARAMETER kType = Type;
+
+    std::vector<T> mins;
+    std::vector<T> maxs;
+    std::vector<T> steps;
+
+    void Append(QString name, QString label, T min, T max, T start_value, T step) {
+        this->append(std::move(name), std::move(label), start_value);
+        mins.push_back(min);
+        maxs.push_back(max);
+        steps.push_back(step);
+    }
+};
+
+template<typename T, TYPE_PARAMETER Type>
+constexpr TYPE_PARAMETER SpinBoxColumn<T, Type>::kType;
+
+typedef SpinBoxColumn<int, TYPE_PARAMETER::SpinBox> IntSpinBoxColumn;
+typedef SpinBoxColumn<double, TYPE_PARAMETER::DoubleSpinBox> DoubleSpinBoxColumn;
+
+// Position of a parameter: its kind and its index inside that kind's column.
+struct ParameterSlot {
+    TYPE_PARAMETER type;
+    int index;
+};
+
+// Consecutive slots [begin, end) shown together under one title.
+struct ParameterSection {
+    QString title;
+    int begin;
+    int end;
+};
+
+// All parameters of one configuration, one contiguous column per kind.
+// Parameters are addressed by slot (their position in declaration order) or
+// by name through a hash index. Names, labels and placeholders are interned
+// in StringPool, so every store of the same schema shares them.
+// Visitors are called with the concrete column type, so per-kind code is
+// chosen at compile time instead of through dynamic_cast.
+class ParameterStore {
+    LineEditColumn line_edits_;
+    CheckBoxColumn check_boxes_;
+    IntSpinBoxColumn int_spin_boxes_;
+    DoubleSpinBoxColumn double_spin_boxes_;
+
+    std::vector<ParameterSlot> slots_;
+
+    std::vector<ParameterSection> sections_;
+
+    NameIndex index_;
+
+    int addSlot(TYPE_PARAMETER type, int index, const QString& name);
+
+public:
+    // Constructs a parameter in place, moving the strings into the columns.
+    int AddLineEdit(QString name, QString original_text, QString data, QString label);
+
+    int AddCheckBox(QString name, QString label, bool status = false);
+
+    int AddSpinBox(QString name, QString label, int min, int max, int start_value, int step);
+
+    int AddSpinBox(QString name, QString label, double min, double max, double start_value, double step);
+
+    int Add(const LineEditParameter& parameter);
+
+    int Add(const CheckBoxParameter& parameter);
+
+    int Add(const SpinBoxParameter<int>& parameter);
+
+    int Add(const SpinBoxParameter<double>& parameter);
+
+    int size() const;
+
+    // Parameters added from now on belong to a new section. Parameters added
+    // before the first call form an untitled section.
+    void BeginSection(const QString& title);
+
+    const std::vector<ParameterSection>& GetSections() const;
+
+    const ParameterSlot& GetSlot(int slot) const;
+
+    TYPE_PARAMETER GetType(int slot) const;
+
+    const QString& GetName(int slot) const;
+
+    const QString& GetLabel(int slot) const;
+
+    // Returns the slot of the named parameter or -1.
+    int Find(const QString& name) const;
+
+    int Find(const char* utf8, int size) const;
+
+    QVariant GetValue(int slot) const;
+
+    QVariant GetModifiedValue(int slot) const;
+
+    // Whether a number lies within [min, max] of an int or double slot; NaN
+    // does not. Text and bool slots have no bounds.
+    bool IsInRange(int slot, double value) const;
+
+    // Sets both the stored and the modified value.
+    void Apply(int slot, const QVariant& value);
+
+    // Sets the stored value only, keeping an unsaved modification.
+    void SetValue(int slot, const QVariant& value);
+
+    void SetModifiedValue(int slot, const QVariant& value);
+
+    // Returns an invalid QVariant for an unknown name.
+    QVariant GetValue(const QString& name) const;
+
+    QVariant GetModifiedValue(const QString& name) const;
+
+    // Returns false for an unknown name.
+    bool SetModifiedValue(const QString& name, const QVariant& value);
+
+    int CountChanged() const;
+
+    const LineEditColumn& GetLineEdits() const;
+
+    const CheckBoxColumn& GetCheckBoxes() const;
+
+    const IntSpinBoxColumn& GetIntSpinBoxes() const;
+
+    const DoubleSpinBoxColumn& GetDoubleSpinBoxes() const;
+
+    // The column of one kind, chosen at compile time.
+    template<typename Column>
+    const Column& GetColumn() const;
+
+    template<typename Column>
+    Column& GetColumn();
+
+    // Calls visitor(column) once per kind.
+    template<typename Visitor>
+    void VisitColumns(Visitor&& visitor) {
+        visitor(line_edits_);
+        visitor(int_spin_boxes_);
+        visitor(double_spin_boxes_);
+        visitor(check_boxes_);
+    }
+
+    template<typename Visitor>
+    void VisitColumns(Visitor&& visitor) const {
+        visitor(line_edits_);
+        visitor(int_spin_boxes_);
+        visitor(double_spin_boxes_);
+        visitor(check_boxes_);
+    }
+
+    // Calls visitor(column, index) for one parameter.
+    template<typename Visitor>
+    decltype(auto) Visit(int slot, Visitor&& visitor) {
+        const ParameterSlot& position = slots_[slot];
+        switch (position.type) {
+            case TYPE_PARAMETER::LineEdit:
+                return visitor(line_edits_, position.index);
+            case TYPE_PARAMETER::CheckBox:
+                return visitor(check_boxes_, position.index);
+            case TYPE_PARAMETER::SpinBox:
+                return visitor(int_spin_boxes_, position.index);
+            case TYPE_PARAMETER::DoubleSpinBox:
+                break;
+        }
+        return visitor(double_spin_boxes_, position.index);
+    }
+
+    template<typename Visitor>
+    decltype(auto) Visit(int slot, Visitor&& visitor) const {
+        const ParameterSlot& position = slots_[slot];
+        switch (position.type) {
+            case TYPE_PARAMETER::LineEdit:
+                return visitor(line_edits_, position.index);
+            case TYPE_PARAMETER::CheckBox:
+                return visitor(check_boxes_, position.index);
+            case TYPE_PARAMETER::SpinBox:
+                return visitor(int_spin_boxes_, position.index);
+            case TYPE_PARAMETER::DoubleSpinBox:
+                break;
+        }
+        return visitor(double_spin_boxes_, position.index);
+    }
+
+    // Calls visitor(column, index) for every parameter in declaration order.
+    template<typename Visitor>
+    void VisitAll(Visitor&& visitor) {
+        for (int slot = 0; slot < size(); ++slot) {
+            Visit(slot, visitor);
+        }
+    }
+
+    template<typename Visitor>
+    void VisitAll(Visitor&& visitor) const {
+        for (int slot = 0; slot < size(); ++slot) {
+            Visit(slot, visitor);
+        }
+    }
+};
+
+template<>
+inline const LineEditColumn& ParameterStore::GetColumn<LineEditColumn>() const {
+    return line_edits_;
+}
+
+template<>
+inline const CheckBoxColumn& ParameterStore::GetColumn<CheckBoxColumn>() const {
+    return check_boxes_;
+}
+
+template<>
+inline const IntSpinBoxColumn& ParameterStore::GetColumn<IntSpinBoxColumn>() const {
+    return int_spin_boxes_;
+}
+
+template<>
+inline const DoubleSpinBoxColumn& ParameterStore::GetColumn<DoubleSpinBoxColumn>() const {
+    return double_spin_boxes_;
+}
+
+template<>
+inline LineEditColumn& ParameterStore::GetColumn<LineEditColumn>() {
+    return line_edits_;
+}
+
+template<>
+inline CheckBoxColumn& ParameterStore::GetColumn<CheckBoxColumn>() {
+    return check_boxes_;
+}
+
+template<>
+inline IntSpinBoxColumn& ParameterStore::GetColumn<IntSpinBoxColumn>() {
+    return int_spin_boxes_;
+}
+
+template<>
+inline DoubleSpinBoxColumn& ParameterStore::GetColumn<DoubleSpinBoxColumn>() {
+    return double_spin_boxes_;
+}
+
+// Access to a parameter whose column and index are known at compile time,
+// i.e. a field of a generated schema, without the slot lookup or QVariant:
+//
+//     double apogee = getParameterValue<SatelliteSchema::Apogee>(parameters);
+//
+// Only valid on a store built from that schema (see SatelliteSchema::Matches).
+template<typename Field>
+auto getParameterValue(const ParameterStore& parameters) {
+    return parameters.GetColumn<typename Field::Column>().GetValue(Field::kIndex);
+}
+
+template<typename Field>
+auto getModifiedParameterValue(const ParameterStore& parameters) {
+    return parameters.GetColumn<typename Field::Column>().GetModifiedValue(Field::kIndex);
+}
+
+template<typename Field, typename T>
+void setModifiedParameterValue(ParameterStore& parameters, T value) {
+    parameters.GetColumn<typename Field::Column>().SetModifiedValue(Field::kIndex, std::move(value));
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+// Immutable vector stored as a 32-way trie of shared nodes. Set() and
+// PushBack() copy only the path to the changed leaf (O(log32 n) nodes) and
+// share every other node with the original, so many versions of a large
+// vector cost little more than one. Versions derived from each other can be
+// diffed by skipping the subtrees they share.
+template<typename T>
+class PersistentVector {
+    static const int kBits = 5;
+    static const int kWidth = 1 << kBits;
+    static const int kMask = kWidth - 1;
+
+    // Inner nodes hold children, leaves hold values.
+    struct Node {
+        std::vector<std::shared_ptr<const Node>> children;
+        std::vector<T> values;
+    };
+
+    typedef std::shared_ptr<const Node> NodePtr;
+
+    NodePtr root_;
+    int size_ = 0;
+    // Index bits below the root level; 0 when the root is a leaf.
+    int shift_ = 0;
+
+    PersistentVector(NodePtr root, int size, int shift) : root_(std::move(root)), size_(size), shift_(shift) {}
+
+    static NodePtr set(const NodePtr& node, int shift, int index, T value) {
+        auto copy = std::make_shared<Node>(*node);
+        if (shift == 0) {
+            copy->values[index & kMask] = std::move(value);
+        } else {
+            auto& child = copy->children[(index >> shift) & kMask];
+            child = set(child, shift - kBits, index, std::move(value));
+        }
+        return copy;
+    }
+
+    static NodePtr push(const NodePtr& node, int shift, int index, T value) {
+        auto copy = node ? std::make_shared<Node>(*node) : std::make_shared<Node>();
+        if (shift == 0) {
+            copy->values.push_back(std::move(value));
+        } else {
+            const size_t position = (index >> shift) & kMask;
+            if (position == copy->children.size()) {
+                copy->children.emplace_back();
+            }
+            copy->children[position] = push(copy->children[position], shift - kBits, index, std::move(value));
+        }
+        return copy;
+    }
+
+    // Subtree of count copies of value (at most kWidth << shift); its full
+    // children are one shared node.
+    static NodePtr filled(int shift, int count, const T& value) {
+        auto node = std::make_shared<Node>();
+        if (shift == 0) {
+            node->values.assign(count, value);
+            return node;
+        }
+        const int capacity = 1 << shift;
+        NodePtr full;
+        for (int begin = 0; begin < count; begin += capacity) {
+            if (count - begin < capacity) {
+                node->children.push_back(filled(shift - kBits, count - begin, value));
+            } else {
+                if (!full) {
+                    full = filled(shift - kBits, capacity, value);
+                }
+                node->children.push_back(full);
+            }
+        }
+        return node;
+    }
+
+    template<typename Function>
+    static void diff(const Node* a, const Node* b, int shift, int base, int limit, Function& function) {
+        if (a == b || base >= limit) {
+            return;
+        }
+        if (shift == 0) {
+            const int count = std::min(limit - base, static_cast<int>(std::min(a->values.size(), b->values.size())));
+            for (int i = 0; i < count; ++i) {
+                if (a->values[i] != b->values[i]) {
+                    function(base + i);
+                }
+            }
+            return;
+        }
+        const size_t count = std::min(a->children.size(), b->children.size());
+        for (size_t i = 0; i < count; ++i) {
+            diff(a->children[i].get(), b->children[i].get(), shift - kBits, base + (static_cast<int>(i) << shift),
+                 limit, function);
+        }
+    }
+
+public:
+    PersistentVector() = default;
+
+    // Builds the trie bottom-up in O(n).
+    static PersistentVector FromVector(const std::vector<T>& values) {
+        if (values.empty()) {
+            return PersistentVector();
+        }
+
+        std::vector<NodePtr> level;
+        for (size_t begin = 0; begin < values.size(); begin += kWidth) {
+            auto leaf = std::make_shared<Node>();
+            leaf->values.assign(values.begin() + begin, values.begin() + std::min(values.size(), begin + kWidth));
+            level.push_back(std::move(leaf));
+        }
+
+        int shift = 0;
+        while (level.size() > 1) {
+            std::vector<NodePtr> parents;
+            for (size_t begin = 0; begin < level.size(); begin += kWidth) {
+                auto parent = std::make_shared<Node>();
+                parent->children.assign(level.begin() + begin, level.begin() + std::min(level.size(), begin + kWidth));
+                parents.push_back(std::move(parent));
+            }
+            level = std::move(parents);
+            shift += kBits;
+        }
+        return PersistentVector(level.front(), static_cast<int>(values.size()), shift);
+    }
+
+    // size copies of value in O(log n) nodes, since identical full subtrees
+    // are shared.
+    static PersistentVector Filled(int size, const T& value) {
+        if (size <= 0) {
+            return PersistentVector();
+        }
+        int shift = 0;
+        while ((kWidth << shift) < size) {
+            shift += kBits;
+        }
+        return PersistentVector(filled(shift, size, value), size, shift);
+    }
+
+    int size() const {
+        return size_;
+    }
+
+    const T& Get(int index) const {
+        const Node* node = root_.get();
+        for (int shift = shift_; shift > 0; shift -= kBits) {
+            node = node->children[(index >> shift) & kMask].get();
+        }
+        return node->values[index & kMask];
+    }
+
+    PersistentVector Set(int index, T value) const {
+        return PersistentVector(set(root_, shift_, index, std::move(value)), size_, shift_);
+    }
+
+    PersistentVector PushBack(T value) const {
+        if (!root_) {
+            auto leaf = std::make_shared<Node>();
+            leaf->values.push_back(std::move(value));
+            return PersistentVector(std::move(leaf), 1, 0);
+        }
+
+        NodePtr root = root_;
+        int shift = shift_;
+        // A full trie grows a level, with the old root as the first child.
+        if (size_ == (kWidth << shift_)) {
+            auto grown = std::make_shared<Node>();
+            grown->children.push_back(root_);
+            root = std::move(grown);
+            shift += kBits;
+        }
+        return PersistentVector(push(root, shift, size_, std::move(value)), size_ + 1, shift);
+    }
+
+    // Calls function(index) for every index whose value may differ between
+    // the versions: those in both that compare unequal, then those in only
+    // one of them. Shared subtrees are skipped, so versions a few edits
+    // apart are compared in O(edits * log n).
+    template<typename Function>
+    static void ForEachDifference(const PersistentVector& a, const PersistentVector& b, Function function) {
+        const int common = std::min(a.size_, b.size_);
+        if (common > 0) {
+            // The shallower trie matches the first subtree of the deeper one.
+            const Node* a_node = a.root_.get();
+            const Node* b_node = b.root_.get();
+            for (int shift = a.shift_; shift > b.shift_; shift -= kBits) {
+                a_node = a_node->children.front().get();
+            }
+            for (int shift = b.shift_; shift > a.shift_; shift -= kBits) {
+                b_node = b_node->children.front().get();
+            }
+            diff(a_node, b_node, std::min(a.shift_, b.shift_), 0, common, function);
+        }
+        for (int i = common; i < std::max(a.size_, b.size_); ++i) {
+            function(i);
+        }
+    }
+};
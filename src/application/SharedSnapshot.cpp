@@ -0,0 +1,10 @@
+#include "SharedSnapshot.h"
+
+#include <QFileInfo>
+
+QString sharedSnapshotKey(const QString& config_file) {
+    const QFileInfo info(config_file);
+    // canonicalFilePath() is empty until the file exists.
+    const QString path = info.exists() ? info.canonicalFilePath() : info.absoluteFilePath();
+    return "QtAppTask:" + path;
+}
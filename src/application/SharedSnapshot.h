@@ -0,0 +1,71 @@
+#pragma once
+
+#include <QString>
+
+#include <atomic>
+#include <cstdint>
+
+// Layout of the stored parameter values the application publishes in shared
+// memory for other local processes: the values of the config as saved, which
+// unsaved edits and live telemetry do not change. The segment is a
+// SharedSnapshotHeader followed, at offset kEntriesOffset, by one
+// SharedSnapshotEntry per parameter slot in declaration order. Only the
+// values change while the segment exists; the slot count and names are fixed
+// when it is created.
+//
+// Readers never lock: the writer makes sequence odd before touching the
+// entries and even again afterwards, so a read that saw the same even
+// sequence before and after copying the entries saw a consistent state.
+
+struct SharedSnapshotHeader {
+    static const std::uint32_t kMagic = 0x51545053;  // "SPTQ"
+    // Bumped on every change of the structs below.
+    static const std::uint32_t kLayoutVersion = 1;
+
+    // kMagic once the segment is initialized, stored last.
+    std::atomic<std::uint32_t> magic;
+    std::uint32_t layout_version;
+    std::uint32_t parameter_count;
+    std::uint32_t entry_size;
+    // Odd while the writer changes the entries.
+    std::atomic<std::uint64_t> sequence;
+    // Number of updates published, read like the entries.
+    std::uint64_t generation;
+};
+
+struct SharedSnapshotEntry {
+    enum Type : std::uint32_t {
+        Text = 0,
+        Bool = 1,
+        Int = 2,
+        Double = 3
+    };
+
+    static const int kNameSize = 48;
+    static const int kTextSize = 128;
+
+    // UTF-8, NUL-terminated; longer names are cut at a character boundary.
+    char name[kNameSize];
+    std::uint32_t type;
+    // Bytes used in text, at most kTextSize.
+    std::uint32_t text_size;
+    // Value of Bool (0 or 1), Int and Double entries.
+    double number;
+    // UTF-8 value of Text entries, not terminated; longer values are cut at
+    // a character boundary.
+    char text[kTextSize];
+};
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "the sequence must be lock-free to be shared between processes");
+static_assert(sizeof(SharedSnapshotHeader) <= 64, "the header must fit before kEntriesOffset");
+
+// Keeps the entries on their own cache lines.
+const int kEntriesOffset = 64;
+
+inline int sharedSnapshotSize(int parameter_count) {
+    return kEntriesOffset + parameter_count * static_cast<int>(sizeof(SharedSnapshotEntry));
+}
+
+// Key of the segment published for a config file, the same for every
+// spelling of its path.
+QString sharedSnapshotKey(const QString& config_file);
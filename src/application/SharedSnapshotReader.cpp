@@ -0,0 +1,119 @@
+#include "SharedSnapshotReader.h"
+
+#include <algorithm>
+#include <cstring>
+
+SharedSnapshotReader::SharedSnapshotReader(const QString& key) : memory_(key) {
+}
+
+bool SharedSnapshotReader::Attach(QString* message) {
+    Detach();
+    if (!memory_.attach(QSharedMemory::ReadOnly)) {
+        if (message != nullptr) {
+            *message = memory_.errorString();
+        }
+        return false;
+    }
+
+    auto fail = [&](const QString& reason) {
+        memory_.detach();
+        if (message != nullptr) {
+            *message = reason;
+        }
+        return false;
+    };
+
+    if (memory_.size() < kEntriesOffset) {
+        return fail("The segment is smaller than the header.");
+    }
+    const auto* header = static_cast<const SharedSnapshotHeader*>(memory_.constData());
+    if (header->magic.load(std::memory_order_acquire) != SharedSnapshotHeader::kMagic) {
+        return fail("The snapshot has not been published yet.");
+    }
+    if (header->layout_version != SharedSnapshotHeader::kLayoutVersion ||
+        header->entry_size != sizeof(SharedSnapshotEntry)) {
+        return fail(QString("The snapshot has layout version %1, expected %2.")
+                    .arg(header->layout_version).arg(SharedSnapshotHeader::kLayoutVersion));
+    }
+    const int parameter_count = static_cast<int>(header->parameter_count);
+    if (parameter_count < 0 || memory_.size() < sharedSnapshotSize(parameter_count)) {
+        return fail("The segment is smaller than its entries.");
+    }
+
+    header_ = header;
+    entries_ = reinterpret_cast<const SharedSnapshotEntry*>(
+        static_cast<const char*>(memory_.constData()) + kEntriesOffset);
+    parameter_count_ = parameter_count;
+    return true;
+}
+
+void SharedSnapshotReader::Detach() {
+    header_ = nullptr;
+    entries_ = nullptr;
+    parameter_count_ = 0;
+    if (memory_.isAttached()) {
+        memory_.detach();
+    }
+}
+
+bool SharedSnapshotReader::IsAttached() const {
+    return header_ != nullptr;
+}
+
+int SharedSnapshotReader::GetParameterCount() const {
+    return parameter_count_;
+}
+
+int SharedSnapshotReader::Find(const char* name) const {
+    for (int slot = 0; slot < parameter_count_; ++slot) {
+        if (std::strncmp(entries_[slot].name, name, SharedSnapshotEntry::kNameSize) == 0) {
+            return slot;
+        }
+    }
+    return -1;
+}
+
+int SharedSnapshotReader::Find(const QString& name) const {
+    return Find(name.toUtf8().constData());
+}
+
+const char* SharedSnapshotReader::GetName(int slot) const {
+    return entries_[slot].name;
+}
+
+SharedSnapshotEntry::Type SharedSnapshotReader::GetType(int slot) const {
+    return static_cast<SharedSnapshotEntry::Type>(entries_[slot].type);
+}
+
+bool SharedSnapshotReader::ReadNumber(int slot, double& value, std::uint64_t* generation) const {
+    if (slot < 0 || slot >= parameter_count_ || GetType(slot) == SharedSnapshotEntry::Text) {
+        return false;
+    }
+    return Read([&](const SharedSnapshotEntry* entries, int) {
+        value = entries[slot].number;
+    }, generation);
+}
+
+bool SharedSnapshotReader::ReadText(int slot, std::string& text, std::uint64_t* generation) const {
+    if (slot < 0 || slot >= parameter_count_ || GetType(slot) != SharedSnapshotEntry::Text) {
+        return false;
+    }
+    char buffer[SharedSnapshotEntry::kTextSize];
+    std::uint32_t size = 0;
+    if (!Read([&](const SharedSnapshotEntry* entries, int) {
+        // A torn size must not read past the entry.
+        size = std::min<std::uint32_t>(entries[slot].text_size, SharedSnapshotEntry::kTextSize);
+        std::memcpy(buffer, entries[slot].text, size);
+    }, generation)) {
+        return false;
+    }
+    text.assign(buffer, size);
+    return true;
+}
+
+bool SharedSnapshotReader::ReadAll(std::vector<SharedSnapshotEntry>& entries, std::uint64_t* generation) const {
+    entries.resize(parameter_count_);
+    return Read([&](const SharedSnapshotEntry* source, int count) {
+        std::copy(source, source + count, entries.begin());
+    }, generation);
+}
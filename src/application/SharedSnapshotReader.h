@@ -0,0 +1,91 @@
+#pragma once
+
+#include "SharedSnapshot.h"
+
+#include <QSharedMemory>
+#include <QString>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Read-only view of a snapshot published by SharedSnapshotWriter, for other
+// local processes. Reads go straight to the shared entries without locks
+// or system calls; a read that overlapped an update is retried.
+//
+//     SharedSnapshotReader reader(sharedSnapshotKey("config.json"));
+//     double radius;
+//     if (reader.Attach() && reader.ReadNumber(reader.Find("radius"), radius)) ...
+class SharedSnapshotReader {
+    QSharedMemory memory_;
+    const SharedSnapshotHeader* header_ = nullptr;
+    const SharedSnapshotEntry* entries_ = nullptr;
+    int parameter_count_ = 0;
+
+public:
+    // Retries of one read before it gives up on a writer that keeps the
+    // sequence odd (e.g. a crashed one).
+    static const int kMaxRetries = 1 << 16;
+
+    explicit SharedSnapshotReader(const QString& key);
+
+    // Attaches to the published segment. Fails while nothing is published
+    // under the key or the layout is of another version.
+    bool Attach(QString* message = nullptr);
+
+    void Detach();
+
+    bool IsAttached() const;
+
+    int GetParameterCount() const;
+
+    // Slot of the named parameter or -1. Names do not change while
+    // attached, so the slot can be kept.
+    int Find(const char* name) const;
+
+    int Find(const QString& name) const;
+
+    const char* GetName(int slot) const;
+
+    SharedSnapshotEntry::Type GetType(int slot) const;
+
+    // Calls read(entries, count) until it ran over a consistent state and
+    // returns true, or false after kMaxRetries. read may run several times
+    // and see torn values in the runs that are thrown away, so it must only
+    // copy from the entries (clamping text_size) and decide afterwards.
+    // generation receives the number of updates the state includes.
+    template<typename Function>
+    bool Read(Function&& read, std::uint64_t* generation = nullptr) const {
+        if (header_ == nullptr) {
+            return false;
+        }
+        for (int retry = 0; retry < kMaxRetries; ++retry) {
+            const std::uint64_t before = header_->sequence.load(std::memory_order_acquire);
+            if (before & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+            const std::uint64_t read_generation = header_->generation;
+            read(entries_, parameter_count_);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (header_->sequence.load(std::memory_order_relaxed) == before) {
+                if (generation != nullptr) {
+                    *generation = read_generation;
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Value of a Bool, Int or Double entry.
+    bool ReadNumber(int slot, double& value, std::uint64_t* generation = nullptr) const;
+
+    // UTF-8 value of a Text entry.
+    bool ReadText(int slot, std::string& text, std::uint64_t* generation = nullptr) const;
+
+    // Copies every entry at once, consistent across entries.
+    bool ReadAll(std::vector<SharedSnapshotEntry>& entries, std::uint64_t* generation = nullptr) const;
+};
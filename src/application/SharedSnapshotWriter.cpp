@@ -0,0 +1,172 @@
+#include "SharedSnapshotWriter.h"
+
+#include "Trace.h"
+
+#include <QByteArray>
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+namespace {
+
+// Length of the longest prefix of at most limit bytes that does not end in
+// the middle of a UTF-8 sequence.
+int utf8Prefix(const QByteArray& bytes, int limit) {
+    if (bytes.size() <= limit) {
+        return bytes.size();
+    }
+    int size = limit;
+    while (size > 0 && (static_cast<unsigned char>(bytes[size]) & 0xC0) == 0x80) {
+        --size;
+    }
+    return size;
+}
+
+void setValue(SharedSnapshotEntry& entry, const QString& value) {
+    const QByteArray bytes = value.toUtf8();
+    const int size = utf8Prefix(bytes, SharedSnapshotEntry::kTextSize);
+    std::memcpy(entry.text, bytes.constData(), size);
+    entry.text_size = static_cast<std::uint32_t>(size);
+}
+
+void setValue(SharedSnapshotEntry& entry, bool value) {
+    entry.number = value ? 1.0 : 0.0;
+}
+
+void setValue(SharedSnapshotEntry& entry, int value) {
+    entry.number = value;
+}
+
+void setValue(SharedSnapshotEntry& entry, double value) {
+    entry.number = value;
+}
+
+SharedSnapshotEntry::Type entryType(TYPE_PARAMETER type) {
+    switch (type) {
+        case TYPE_PARAMETER::LineEdit:
+            return SharedSnapshotEntry::Text;
+        case TYPE_PARAMETER::CheckBox:
+            return SharedSnapshotEntry::Bool;
+        case TYPE_PARAMETER::SpinBox:
+            return SharedSnapshotEntry::Int;
+        case TYPE_PARAMETER::DoubleSpinBox:
+            break;
+    }
+    return SharedSnapshotEntry::Double;
+}
+
+void writeValue(SharedSnapshotEntry& entry, const ParameterStore& parameters, int slot) {
+    parameters.Visit(slot, [&](const auto& column, int index) {
+        setValue(entry, column.GetValue(index));
+    });
+}
+
+}  // namespace
+
+SharedSnapshotWriter::SharedSnapshotWriter(const QString& key) : memory_(key) {
+}
+
+QString SharedSnapshotWriter::GetKey() const {
+    return memory_.key();
+}
+
+bool SharedSnapshotWriter::attach(int parameter_count, QString* message) {
+    const int size = sharedSnapshotSize(parameter_count);
+    if (memory_.isAttached()) {
+        memory_.detach();
+    }
+    header_ = nullptr;
+    entries_ = nullptr;
+
+    bool created = memory_.create(size);
+    if (!created && memory_.error() == QSharedMemory::AlreadyExists && memory_.attach() && memory_.size() < size) {
+        memory_.detach();
+        if (message != nullptr) {
+            *message = "Another process holds a smaller segment under the key.";
+        }
+        return false;
+    }
+    if (!memory_.isAttached()) {
+        if (message != nullptr) {
+            *message = memory_.errorString();
+        }
+        return false;
+    }
+
+    header_ = static_cast<SharedSnapshotHeader*>(memory_.data());
+    entries_ = reinterpret_cast<SharedSnapshotEntry*>(static_cast<char*>(memory_.data()) + kEntriesOffset);
+    if (created) {
+        // Readers refuse the segment until magic is set by Publish().
+        std::memset(memory_.data(), 0, size);
+        new (header_) SharedSnapshotHeader;
+        header_->magic.store(0, std::memory_order_relaxed);
+        header_->sequence.store(0, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+std::uint64_t SharedSnapshotWriter::beginWrite() {
+    // A writer that died during an update left the sequence odd.
+    const std::uint64_t sequence = header_->sequence.load(std::memory_order_relaxed) | 1;
+    header_->sequence.store(sequence, std::memory_order_relaxed);
+    // Keeps the entry writes after the odd sequence for a reader that
+    // fences its reads.
+    std::atomic_thread_fence(std::memory_order_release);
+    return sequence;
+}
+
+void SharedSnapshotWriter::endWrite(std::uint64_t sequence) {
+    ++header_->generation;
+    header_->sequence.store(sequence + 1, std::memory_order_release);
+}
+
+bool SharedSnapshotWriter::Publish(const ParameterStore& parameters, QString* message) {
+    TraceSpan span("SharedSnapshotWriter::Publish");
+    const int parameter_count = parameters.size();
+    if (header_ == nullptr || parameter_count != parameter_count_) {
+        if (!attach(parameter_count, message)) {
+            return false;
+        }
+        parameter_count_ = parameter_count;
+    }
+
+    memory_.lock();
+    const std::uint64_t sequence = beginWrite();
+    header_->layout_version = SharedSnapshotHeader::kLayoutVersion;
+    header_->parameter_count = static_cast<std::uint32_t>(parameter_count);
+    header_->entry_size = sizeof(SharedSnapshotEntry);
+    for (int slot = 0; slot < parameter_count; ++slot) {
+        SharedSnapshotEntry& entry = entries_[slot];
+        std::memset(&entry, 0, sizeof(entry));
+        const QByteArray name = parameters.GetName(slot).toUtf8();
+        std::memcpy(entry.name, name.constData(), utf8Prefix(name, SharedSnapshotEntry::kNameSize - 1));
+        entry.type = entryType(parameters.GetType(slot));
+        writeValue(entry, parameters, slot);
+    }
+    endWrite(sequence);
+    header_->magic.store(SharedSnapshotHeader::kMagic, std::memory_order_release);
+    memory_.unlock();
+    return true;
+}
+
+void SharedSnapshotWriter::Update(const ParameterStore& parameters, const std::vector<int>& changed) {
+    if (header_ == nullptr || changed.empty()) {
+        return;
+    }
+    TraceSpan span("SharedSnapshotWriter::Update");
+    Trace::Count("snapshot slots", static_cast<double>(changed.size()));
+
+    memory_.lock();
+    const std::uint64_t sequence = beginWrite();
+    for (int slot : changed) {
+        if (slot >= 0 && slot < parameter_count_) {
+            writeValue(entries_[slot], parameters, slot);
+        }
+    }
+    endWrite(sequence);
+    memory_.unlock();
+}
+
+std::uint64_t SharedSnapshotWriter::GetGeneration() const {
+    return header_ != nullptr ? header_->generation : 0;
+}
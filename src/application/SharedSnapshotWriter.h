@@ -0,0 +1,51 @@
+#pragma once
+
+#include "ParameterStore.h"
+#include "SharedSnapshot.h"
+
+#include <QSharedMemory>
+#include <QString>
+
+#include <cstdint>
+#include <vector>
+
+// Publishes the stored (saved) values of a ParameterStore in shared memory
+// for SharedSnapshotReader: what the config file holds, not unsaved edits or
+// live telemetry. The segment exists while the writer does.
+// Updates rewrite only the given slots; readers never wait for them. Writers
+// of the same key (e.g. two windows on one config) take the segment's lock
+// around each update, so they do not break the sequence.
+class SharedSnapshotWriter {
+    QSharedMemory memory_;
+    SharedSnapshotHeader* header_ = nullptr;
+    SharedSnapshotEntry* entries_ = nullptr;
+    int parameter_count_ = 0;
+
+    // Creates the segment, or takes over a large enough one left by another
+    // writer of the key.
+    bool attach(int parameter_count, QString* message);
+
+    // Makes the sequence odd; the entries may be written until endWrite().
+    std::uint64_t beginWrite();
+
+    void endWrite(std::uint64_t sequence);
+
+public:
+    explicit SharedSnapshotWriter(const QString& key);
+
+    SharedSnapshotWriter(const SharedSnapshotWriter& other) = delete;
+
+    SharedSnapshotWriter& operator=(const SharedSnapshotWriter& other) = delete;
+
+    QString GetKey() const;
+
+    // Writes the names and stored values of every slot, creating the segment
+    // on the first call.
+    bool Publish(const ParameterStore& parameters, QString* message = nullptr);
+
+    // Rewrites the stored values of the changed slots as one update. Does
+    // nothing before Publish() succeeded.
+    void Update(const ParameterStore& parameters, const std::vector<int>& changed);
+
+    std::uint64_t GetGeneration() const;
+};
@@ -0,0 +1,35 @@
+#include "StartupTimer.h"
+
+namespace {
+
+double millisecondsBetween(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+}  // namespace
+
+StartupTimer::StartupTimer() : start_(Clock::now()), last_(start_) {
+}
+
+void StartupTimer::Mark(const QString& phase) {
+    Clock::time_point now = Clock::now();
+    phases_.emplace_back(phase, millisecondsBetween(last_, now));
+    last_ = now;
+}
+
+void StartupTimer::Add(const QString& phase, double ms) {
+    phases_.emplace_back(phase, ms);
+}
+
+double StartupTimer::GetElapsedMs() const {
+    return millisecondsBetween(start_, Clock::now());
+}
+
+QString StartupTimer::ToString() const {
+    QString text;
+    for (const auto& phase : phases_) {
+        text += QString("%1: %2 ms\n").arg(phase.first).arg(phase.second, 0, 'f', 2);
+    }
+    text += QString("total: %1 ms\n").arg(GetElapsedMs(), 0, 'f', 2);
+    return text;
+}
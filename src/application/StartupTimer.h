@@ -0,0 +1,32 @@
+#pragma once
+
+#include <QString>
+#include <chrono>
+#include <utility>
+#include <vector>
+
+// Wall-clock breakdown of the window startup. Sequential phases on the GUI
+// thread are measured between consecutive marks; work measured elsewhere
+// (on another thread, or interleaved with the event loop) is added with its
+// own duration.
+class StartupTimer {
+    typedef std::chrono::steady_clock Clock;
+
+    Clock::time_point start_;
+    Clock::time_point last_;
+
+    std::vector<std::pair<QString, double>> phases_;
+
+public:
+    StartupTimer();
+
+    // Records the time since the previous mark (or construction) as a phase.
+    void Mark(const QString& phase);
+
+    void Add(const QString& phase, double ms);
+
+    double GetElapsedMs() const;
+
+    // One line per phase in the order recorded, then the time since construction.
+    QString ToString() const;
+};
@@ -0,0 +1,16 @@
+#include "StringPool.h"
+
+#include <QSet>
+#include <mutex>
+
+QString StringPool::Intern(const QString& value) {
+    static std::mutex mutex;
+    static QSet<QString> pool;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = pool.constFind(value);
+    if (it == pool.constEnd()) {
+        it = pool.insert(value);
+    }
+    return *it;
+}
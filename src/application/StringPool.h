@@ -0,0 +1,10 @@
+#pragma once
+
+#include <QString>
+
+// Process-wide pool of immutable strings. Interned copies share one buffer,
+// so parameter names and labels cost a pointer per store, not a string.
+class StringPool {
+public:
+    static QString Intern(const QString& value);
+};
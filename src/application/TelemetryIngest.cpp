@@ -0,0 +1,225 @@
+#include "TelemetryIngest.h"
+
+#include "Trace.h"
+
+#include <QByteArray>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+#ifdef Q_OS_UNIX
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const int kReadSize = 64 * 1024;
+// Longer lines are dropped rather than buffered without bound.
+const size_t kMaxLineSize = 64 * 1024;
+
+bool isBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+bool parseBool(const QByteArray& text, double& value) {
+    if (text == "true" || text == "1" || text == "on") {
+        value = 1.0;
+    } else if (text == "false" || text == "0" || text == "off") {
+        value = 0.0;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+TelemetryIngest::TelemetryIngest(QString file_name, const ParameterStore& parameters, TelemetryQueue& queue)
+    : file_name_(std::move(file_name)), parameters_(parameters), queue_(queue) {
+}
+
+TelemetryIngest::~TelemetryIngest() {
+    Stop();
+}
+
+#ifdef Q_OS_UNIX
+
+bool TelemetryIngest::Start(QString* message) {
+    const QByteArray path = file_name_.toLocal8Bit();
+    struct stat status;
+    if (::stat(path.constData(), &status) != 0) {
+        if (message != nullptr) {
+            *message = std::strerror(errno);
+        }
+        return false;
+    }
+    // Holding the write end of a pipe as well keeps it from reporting the
+    // end of the stream between two writers.
+    const int mode = S_ISFIFO(status.st_mode) ? O_RDWR : O_RDONLY;
+    file_ = ::open(path.constData(), mode | O_NONBLOCK);
+    if (file_ < 0) {
+        if (message != nullptr) {
+            *message = std::strerror(errno);
+        }
+        return false;
+    }
+    thread_ = std::thread([this]() {
+        run();
+    });
+    return true;
+}
+
+void TelemetryIngest::Stop() {
+    stop_ = true;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    if (file_ >= 0) {
+        ::close(file_);
+        file_ = -1;
+    }
+}
+
+qint64 TelemetryIngest::readSome(char* data, qint64 size) {
+    pollfd descriptor{file_, POLLIN, 0};
+    if (::poll(&descriptor, 1, kPollMs) <= 0) {
+        return 0;
+    }
+    const ssize_t count = ::read(file_, data, size);
+    if (count == 0) {
+        // End of a regular file.
+        return -1;
+    }
+    if (count < 0) {
+        if (errno == EAGAIN || errno == EINTR) {
+            return 0;
+        }
+        qWarning("Could not read %s: %s", qPrintable(file_name_), std::strerror(errno));
+        return -1;
+    }
+    return count;
+}
+
+#else
+
+bool TelemetryIngest::Start(QString* message) {
+    file_.setFileName(file_name_);
+    if (!file_.open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
+        if (message != nullptr) {
+            *message = file_.errorString();
+        }
+        return false;
+    }
+    thread_ = std::thread([this]() {
+        run();
+    });
+    return true;
+}
+
+void TelemetryIngest::Stop() {
+    stop_ = true;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    file_.close();
+}
+
+qint64 TelemetryIngest::readSome(char* data, qint64 size) {
+    const qint64 count = file_.read(data, size);
+    if (count < 0) {
+        qWarning("Could not read %s: %s", qPrintable(file_name_), qPrintable(file_.errorString()));
+        return -1;
+    }
+    if (count == 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(kPollMs));
+    }
+    return count;
+}
+
+#endif
+
+void TelemetryIngest::run() {
+    Trace::SetThreadName("telemetry ingest");
+    std::vector<char> buffer;
+    buffer.reserve(2 * kReadSize);
+    char chunk[kReadSize];
+
+    while (!stop_.load(std::memory_order_relaxed)) {
+        const qint64 size = readSome(chunk, sizeof(chunk));
+        if (size < 0) {
+            break;
+        }
+        if (size == 0) {
+            continue;
+        }
+
+        buffer.insert(buffer.end(), chunk, chunk + size);
+        const char* begin = buffer.data();
+        const char* end = begin + buffer.size();
+        for (const char* line_end; (line_end = std::find(begin, end, '\n')) != end; begin = line_end + 1) {
+            parseLine(begin, line_end);
+        }
+        buffer.erase(buffer.begin(), buffer.begin() + (begin - buffer.data()));
+        if (buffer.size() > kMaxLineSize) {
+            buffer.clear();
+            rejected_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+void TelemetryIngest::parseLine(const char* begin, const char* end) {
+    while (end > begin && isBlank(end[-1])) {
+        --end;
+    }
+    if (begin == end) {
+        return;
+    }
+    received_.fetch_add(1, std::memory_order_relaxed);
+
+    const char* name_end = std::find_if(begin, end, isBlank);
+    const char* value = std::find_if_not(name_end, end, isBlank);
+    TelemetryUpdate update;
+    update.slot = parameters_.Find(begin, static_cast<int>(name_end - begin));
+    if (update.slot < 0 || value == end) {
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    const QByteArray text = QByteArray::fromRawData(value, static_cast<int>(end - value));
+    bool ok = true;
+    switch (parameters_.GetType(update.slot)) {
+        case TYPE_PARAMETER::LineEdit:
+            update.text = QString::fromUtf8(value, static_cast<int>(end - value));
+            break;
+        case TYPE_PARAMETER::CheckBox:
+            ok = parseBool(text, update.number);
+            break;
+        case TYPE_PARAMETER::SpinBox:
+        case TYPE_PARAMETER::DoubleSpinBox:
+            // Unlike strtod, independent of the locale the GUI sets.
+            update.number = text.toDouble(&ok);
+            break;
+    }
+    if (!ok) {
+        rejected_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    queue_.Push(std::move(update));
+}
+
+const QString& TelemetryIngest::GetFileName() const {
+    return file_name_;
+}
+
+quint64 TelemetryIngest::GetReceived() const {
+    return received_.load(std::memory_order_relaxed);
+}
+
+quint64 TelemetryIngest::GetRejected() const {
+    return rejected_.load(std::memory_order_relaxed);
+}
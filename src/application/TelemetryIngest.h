@@ -0,0 +1,74 @@
+#pragma once
+
+#include "ParameterStore.h"
+#include "TelemetryQueue.h"
+
+#include <QFile>
+#include <QString>
+#include <QtGlobal>
+
+#include <atomic>
+#include <thread>
+
+// Reads live values from a local stream on its own thread and pushes them
+// into a TelemetryQueue. The stream is a file or, on Unix, a named pipe
+// (mkfifo) with one "name value" line per update, as written by
+// QtAppTask-replay; a pipe stays open for the next writer when one goes
+// away. Elsewhere a file is read through QFile and followed as it grows,
+// since there is no pipe to wait on without blocking Stop(). Several
+// ingests may share one queue.
+//
+// Names and types are looked up in the parameters from the ingest thread;
+// they do not change after construction, while values (which it does not
+// read) are changed by the GUI thread.
+class TelemetryIngest {
+    QString file_name_;
+    const ParameterStore& parameters_;
+    TelemetryQueue& queue_;
+
+    std::thread thread_;
+    std::atomic<bool> stop_{false};
+#ifdef Q_OS_UNIX
+    int file_ = -1;
+#else
+    QFile file_;
+#endif
+
+    std::atomic<quint64> received_{0};
+    std::atomic<quint64> rejected_{0};
+
+    // Checks stop_ at least this often while the stream is idle.
+    static const int kPollMs = 100;
+
+    void run();
+
+    // Waits up to kPollMs for data and reads at most size bytes of it.
+    // Returns the bytes read, 0 if there were none yet, or -1 at the end of
+    // the stream or on an error.
+    qint64 readSome(char* data, qint64 size);
+
+    void parseLine(const char* begin, const char* end);
+
+public:
+    TelemetryIngest(QString file_name, const ParameterStore& parameters, TelemetryQueue& queue);
+
+    ~TelemetryIngest();
+
+    TelemetryIngest(const TelemetryIngest& other) = delete;
+
+    TelemetryIngest& operator=(const TelemetryIngest& other) = delete;
+
+    // Opens the stream and starts the thread.
+    bool Start(QString* message = nullptr);
+
+    // Joins the thread, dropping a line it may be in the middle of.
+    void Stop();
+
+    const QString& GetFileName() const;
+
+    // Lines read, including rejected ones.
+    quint64 GetReceived() const;
+
+    // Lines with an unknown name or a value that does not parse.
+    quint64 GetRejected() const;
+};
@@ -0,0 +1,67 @@
+#include "TelemetryQueue.h"
+
+TelemetryQueue::TelemetryQueue(int capacity) {
+    std::size_t size = 2;
+    while (size < static_cast<std::size_t>(capacity)) {
+        size *= 2;
+    }
+    cells_.reset(new Cell[size]);
+    mask_ = size - 1;
+    for (std::size_t i = 0; i < size; ++i) {
+        cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+int TelemetryQueue::GetCapacity() const {
+    return static_cast<int>(mask_ + 1);
+}
+
+bool TelemetryQueue::Push(TelemetryUpdate update) {
+    std::size_t position = head_.load(std::memory_order_relaxed);
+    Cell* cell;
+    for (;;) {
+        cell = &cells_[position & mask_];
+        const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        const std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence - position);
+        if (difference == 0) {
+            if (head_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            // The cell still holds the update of the previous lap.
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            position = head_.load(std::memory_order_relaxed);
+        }
+    }
+    cell->update = std::move(update);
+    cell->sequence.store(position + 1, std::memory_order_release);
+    return true;
+}
+
+bool TelemetryQueue::Pop(TelemetryUpdate& update) {
+    const std::size_t position = tail_.load(std::memory_order_relaxed);
+    Cell& cell = cells_[position & mask_];
+    if (cell.sequence.load(std::memory_order_acquire) != position + 1) {
+        return false;
+    }
+    update = std::move(cell.update);
+    cell.sequence.store(position + mask_ + 1, std::memory_order_release);
+    tail_.store(position + 1, std::memory_order_relaxed);
+    return true;
+}
+
+int TelemetryQueue::GetDepth() const {
+    const std::size_t tail = tail_.load(std::memory_order_relaxed);
+    const std::size_t head = head_.load(std::memory_order_relaxed);
+    return head > tail ? static_cast<int>(head - tail) : 0;
+}
+
+quint64 TelemetryQueue::GetPushed() const {
+    return head_.load(std::memory_order_relaxed);
+}
+
+quint64 TelemetryQueue::GetDropped() const {
+    return dropped_.load(std::memory_order_relaxed);
+}
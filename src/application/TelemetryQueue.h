@@ -0,0 +1,64 @@
+#pragma once
+
+#include <QString>
+#include <QtGlobal>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+// Live value of one parameter, as received.
+struct TelemetryUpdate {
+    int slot = -1;
+    // Value of CheckBox (0 or 1), SpinBox and DoubleSpinBox parameters.
+    double number = 0.0;
+    // Value of LineEdit parameters.
+    QString text;
+};
+
+// Bounded queue of telemetry updates that any number of threads push into
+// and one thread pops from, without locks. Every cell carries a sequence
+// number telling whether it is free for the push of a given position or
+// holds the update for the pop of that position, so producers claim a
+// position with one compare-exchange and never wait for the consumer.
+// A push into a full queue drops the update.
+class TelemetryQueue {
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        TelemetryUpdate update;
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    std::size_t mask_;
+
+    // Producers and the consumer write their positions on separate cache
+    // lines.
+    char padding_head_[64];
+    std::atomic<std::size_t> head_{0};
+    char padding_tail_[64];
+    std::atomic<std::size_t> tail_{0};
+    std::atomic<quint64> dropped_{0};
+
+public:
+    // capacity is rounded up to a power of two.
+    explicit TelemetryQueue(int capacity);
+
+    TelemetryQueue(const TelemetryQueue& other) = delete;
+
+    TelemetryQueue& operator=(const TelemetryQueue& other) = delete;
+
+    int GetCapacity() const;
+
+    // Returns false and counts a drop when the queue is full.
+    bool Push(TelemetryUpdate update);
+
+    // Consumer thread only. Returns false when the queue is empty.
+    bool Pop(TelemetryUpdate& update);
+
+    // Updates pushed and not popped yet; approximate while producers run.
+    int GetDepth() const;
+
+    quint64 GetPushed() const;
+
+    quint64 GetDropped() const;
+};
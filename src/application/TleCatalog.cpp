@@ -0,0 +1,378 @@
+#include "TleCatalog.h"
+#include "OrbitPropagator.h"
+
+#include <QFile>
+#include <QStringList>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+namespace {
+
+const int kLineLength = 69;
+const qint64 kMinChunkSize = 256 * 1024;
+
+const double kPi = 3.14159265358979323846;
+const double kSecondsPerDay = 86400.0;
+
+const double kPowersOfTen[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14,
+                               1e15, 1e16, 1e17, 1e18};
+
+// Errors are kept as static messages while parsing so that worker threads
+// allocate nothing; they become TleErrors once the chunks are merged.
+struct ChunkError {
+    qint64 line;
+    const char* message;
+};
+
+struct Chunk {
+    const char* begin;
+    const char* end;
+    qint64 line_count = 0;
+    std::vector<TleRecord> records;
+    std::vector<ChunkError> errors;
+};
+
+// Parses the fixed-width field [first, last] (1-based columns) of a line as a
+// decimal number. Blank fields and stray characters fail.
+bool parseField(const char* line, int first, int last, double* value) {
+    const char* pos = line + first - 1;
+    const char* end = line + last;
+
+    while (pos != end && *pos == ' ') {
+        ++pos;
+    }
+    while (pos != end && end[-1] == ' ') {
+        --end;
+    }
+
+    bool negative = false;
+    if (pos != end && (*pos == '-' || *pos == '+')) {
+        negative = *pos == '-';
+        ++pos;
+    }
+
+    // The widest TLE field has 11 digits, so the mantissa stays exact.
+    qint64 mantissa = 0;
+    int digits = 0;
+    int decimals = -1;
+    for (; pos != end; ++pos) {
+        if (*pos >= '0' && *pos <= '9') {
+            mantissa = mantissa * 10 + (*pos - '0');
+            ++digits;
+            decimals += decimals >= 0;
+        } else if (*pos == '.' && decimals < 0) {
+            decimals = 0;
+        } else {
+            return false;
+        }
+    }
+    if (digits == 0 || digits > 18) {
+        return false;
+    }
+
+    *value = static_cast<double>(mantissa) / kPowersOfTen[std::max(decimals, 0)];
+    if (negative) {
+        *value = -*value;
+    }
+    return true;
+}
+
+bool parseInt(const char* line, int first, int last, int* value) {
+    double number = 0.0;
+    if (!parseField(line, first, last, &number) || number != std::floor(number)) {
+        return false;
+    }
+    *value = static_cast<int>(number);
+    return true;
+}
+
+// The last column is the sum of the digits of the line modulo 10, where a
+// minus sign counts as 1.
+bool hasValidChecksum(const char* line) {
+    int sum = 0;
+    for (int i = 0; i < kLineLength - 1; ++i) {
+        if (line[i] >= '0' && line[i] <= '9') {
+            sum += line[i] - '0';
+        } else if (line[i] == '-') {
+            ++sum;
+        }
+    }
+    return line[kLineLength - 1] == '0' + sum % 10;
+}
+
+bool isElementLine(const char* line, const char* end, char number) {
+    return end - line >= 2 && line[0] == number && line[1] == ' ';
+}
+
+// Returns nullptr on success, otherwise what is wrong with the record.
+const char* parseRecord(const char* line1, const char* end1, const char* line2, const char* end2,
+                        TleRecord& record) {
+    if (end1 - line1 < kLineLength || end2 - line2 < kLineLength) {
+        return "element line is shorter than 69 characters";
+    }
+    if (!hasValidChecksum(line1) || !hasValidChecksum(line2)) {
+        return "checksum mismatch";
+    }
+
+    int norad_id_2 = 0;
+    if (!parseInt(line1, 3, 7, &record.norad_id) || !parseInt(line2, 3, 7, &norad_id_2)) {
+        return "invalid catalog number";
+    }
+    if (record.norad_id != norad_id_2) {
+        return "catalog numbers of line 1 and line 2 differ";
+    }
+
+    double eccentricity = 0.0;
+    if (!parseField(line2, 9, 16, &record.inclination) || !parseField(line2, 27, 33, &eccentricity) ||
+        !parseField(line2, 35, 42, &record.arg_perigee) || !parseField(line2, 44, 51, &record.mean_anomaly) ||
+        !parseField(line2, 53, 63, &record.mean_motion)) {
+        return "invalid orbital element";
+    }
+    // The eccentricity field has an implied leading decimal point.
+    record.eccentricity = eccentricity * 1e-7;
+
+    if (record.mean_motion <= 0.0) {
+        return "mean motion is not positive";
+    }
+    return nullptr;
+}
+
+void parseChunk(Chunk& chunk) {
+    const char* name = nullptr;
+    const char* name_end = nullptr;
+    const char* line1 = nullptr;
+    const char* line1_end = nullptr;
+    qint64 line1_number = 0;
+
+    qint64 line_number = 0;
+    for (const char* line = chunk.begin; line < chunk.end;) {
+        const char* newline = static_cast<const char*>(std::memchr(line, '\n', chunk.end - line));
+        const char* next = newline ? newline + 1 : chunk.end;
+        const char* end = newline ? newline : chunk.end;
+        ++line_number;
+
+        while (end != line && (end[-1] == '\r' || end[-1] == ' ')) {
+            --end;
+        }
+
+        if (end == line) {
+            // Blank lines are allowed between records.
+        } else if (isElementLine(line, end, '1')) {
+            if (line1) {
+                chunk.errors.push_back({line1_number, "line 1 without line 2"});
+            }
+            line1 = line;
+            line1_end = end;
+            line1_number = line_number;
+        } else if (isElementLine(line, end, '2')) {
+            if (!line1) {
+                chunk.errors.push_back({line_number, "line 2 without line 1"});
+            } else {
+                TleRecord record;
+                record.line = line1_number;
+                if (const char* message = parseRecord(line1, line1_end, line, end, record)) {
+                    chunk.errors.push_back({line1_number, message});
+                } else {
+                    if (name) {
+                        record.name = name;
+                        record.name_size = static_cast<int>(name_end - name);
+                    }
+                    chunk.records.push_back(record);
+                }
+            }
+            line1 = nullptr;
+            name = nullptr;
+        } else {
+            if (line1) {
+                chunk.errors.push_back({line1_number, "line 1 without line 2"});
+                line1 = nullptr;
+            }
+            // Three-line sets may prefix the name with "0 ".
+            name = isElementLine(line, end, '0') ? line + 2 : line;
+            name_end = end;
+        }
+        line = next;
+    }
+
+    if (line1) {
+        chunk.errors.push_back({line1_number, "line 1 without line 2"});
+    }
+    chunk.line_count = line_number;
+}
+
+// Moves a split position forward to just after the next "2 " line, so that no
+// record straddles two chunks.
+const char* recordBoundary(const char* pos, const char* end) {
+    const char* newline = static_cast<const char*>(std::memchr(pos, '\n', end - pos));
+    while (newline) {
+        const char* line = newline + 1;
+        newline = static_cast<const char*>(std::memchr(line, '\n', end - line));
+        if (isElementLine(line, newline ? newline : end, '2')) {
+            return newline ? newline + 1 : end;
+        }
+    }
+    return end;
+}
+
+}  // namespace
+
+QString TleError::toString() const {
+    if (line <= 0) {
+        return message;
+    }
+    return QString("line %1: %2").arg(line).arg(message);
+}
+
+double TleRecord::GetSemiMajorAxis() const {
+    const double n = mean_motion * 2.0 * kPi / kSecondsPerDay;
+    return std::cbrt(OrbitPropagator::kEarthMu / (n * n));
+}
+
+double TleRecord::GetApogee() const {
+    return GetSemiMajorAxis() * (1.0 + eccentricity) - OrbitPropagator::kEarthRadius;
+}
+
+double TleRecord::GetPerigee() const {
+    return GetSemiMajorAxis() * (1.0 - eccentricity) - OrbitPropagator::kEarthRadius;
+}
+
+double TleRecord::GetAltitude() const {
+    return GetSemiMajorAxis() - OrbitPropagator::kEarthRadius;
+}
+
+void parseTleCatalog(const char* data, qint64 size, std::vector<TleRecord>& records, std::vector<TleError>& errors,
+                     int thread_count) {
+    if (thread_count <= 0) {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    const qint64 chunk_count = std::max<qint64>(1, std::min<qint64>(thread_count, size / kMinChunkSize));
+
+    // Chunks end right after a line 2, so every record lies in one chunk.
+    std::vector<Chunk> chunks(chunk_count);
+    const char* begin = data;
+    const char* end = data + size;
+    for (qint64 i = 0; i < chunk_count; ++i) {
+        const char* split = i + 1 < chunk_count ? recordBoundary(data + size * (i + 1) / chunk_count, end) : end;
+        chunks[i].begin = begin;
+        chunks[i].end = std::max(begin, split);
+        begin = chunks[i].end;
+    }
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < chunks.size(); ++i) {
+        threads.emplace_back(parseChunk, std::ref(chunks[i]));
+    }
+    parseChunk(chunks[0]);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    qint64 first_line = 0;
+    for (const Chunk& chunk : chunks) {
+        for (TleRecord record : chunk.records) {
+            record.line += first_line;
+            records.push_back(record);
+        }
+        for (const ChunkError& error : chunk.errors) {
+            errors.push_back({first_line + error.line, QString::fromLatin1(error.message)});
+        }
+        first_line += chunk.line_count;
+    }
+}
+
+bool importTleCatalog(const QString& file_name, Fleet& fleet, std::vector<TleError>* errors, int thread_count) {
+    QFile file(file_name);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (errors) {
+            errors->push_back({0, QString("Could not open %1").arg(file_name)});
+        }
+        return false;
+    }
+
+    const qint64 size = file.size();
+    const uchar* data = size > 0 ? file.map(0, size) : nullptr;
+    if (size > 0 && !data) {
+        if (errors) {
+            errors->push_back({0, QString("Could not map %1").arg(file_name)});
+        }
+        return false;
+    }
+
+    std::vector<TleRecord> records;
+    std::vector<TleError> parse_errors;
+    parseTleCatalog(reinterpret_cast<const char*>(data), size, records, parse_errors, thread_count);
+
+    const ParameterStore& schema = fleet.GetSchema();
+    const int name = schema.Find("satelliteName");
+    const int norad_id = schema.Find("noradId");
+    const int inclination = schema.Find("inclination");
+    const int eccentricity = schema.Find("eccentricity");
+    const int arg_perigee = schema.Find("argPerigee");
+    const int mean_anomaly = schema.Find("meanAnomaly");
+    const int apogee = schema.Find("apogee");
+    const int perigee = schema.Find("perigee");
+    const int altitude = schema.Find("altitude");
+
+    // Values of a record in the order of columns; a column is -1 when the
+    // schema does not have the parameter.
+    const int kColumnCount = 8;
+    const int columns[kColumnCount] = {norad_id, inclination, eccentricity, arg_perigee,
+                                       mean_anomaly, apogee, perigee, altitude};
+    auto valuesOf = [](const TleRecord& record, double* values) {
+        values[0] = record.norad_id;
+        values[1] = record.inclination;
+        values[2] = record.eccentricity;
+        values[3] = record.arg_perigee;
+        values[4] = record.mean_anomaly;
+        values[5] = record.GetApogee();
+        values[6] = record.GetPerigee();
+        values[7] = record.GetAltitude();
+    };
+
+    std::vector<const TleRecord*> accepted;
+    accepted.reserve(records.size());
+    double values[kColumnCount];
+    for (const TleRecord& record : records) {
+        valuesOf(record, values);
+        QStringList outside;
+        for (int column = 0; column < kColumnCount; ++column) {
+            if (columns[column] >= 0 && !schema.IsInRange(columns[column], values[column])) {
+                outside.append(QString("%1 %2").arg(schema.GetName(columns[column])).arg(values[column]));
+            }
+        }
+        if (outside.isEmpty()) {
+            accepted.push_back(&record);
+            continue;
+        }
+        const QString satellite = record.name ? QString::fromUtf8(record.name, record.name_size)
+                                              : QString("NORAD %1").arg(record.norad_id);
+        parse_errors.push_back({record.line, QString("%1 skipped, outside the schema range: %2")
+                                                 .arg(satellite, outside.join(", "))});
+    }
+
+    const int first = fleet.GetSatelliteCount();
+    fleet.Resize(first + static_cast<int>(accepted.size()));
+
+    for (size_t i = 0; i < accepted.size(); ++i) {
+        const TleRecord& record = *accepted[i];
+        const int satellite = first + static_cast<int>(i);
+        if (record.name && name >= 0) {
+            fleet.SetValue(satellite, name, QString::fromUtf8(record.name, record.name_size));
+        }
+        valuesOf(record, values);
+        for (int column = 0; column < kColumnCount; ++column) {
+            if (columns[column] >= 0) {
+                fleet.SetValue(satellite, columns[column], values[column]);
+            }
+        }
+    }
+
+    if (errors) {
+        errors->insert(errors->end(), parse_errors.begin(), parse_errors.end());
+    }
+    return true;
+}
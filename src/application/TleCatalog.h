@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Fleet.h"
+
+#include <QString>
+#include <vector>
+
+struct TleError {
+    // 1-based line of the file, 0 if the file could not be read.
+    qint64 line = 0;
+    QString message;
+
+    QString toString() const;
+};
+
+// One satellite of a two- or three-line element set. The name points into the
+// parsed buffer and is only valid as long as the buffer is.
+struct TleRecord {
+    // 1-based line of the record's line 1 in the catalog.
+    qint64 line = 0;
+    const char* name = nullptr;
+    int name_size = 0;
+    int norad_id = 0;
+    double inclination = 0.0;
+    double eccentricity = 0.0;
+    double arg_perigee = 0.0;
+    double mean_anomaly = 0.0;
+    // Revolutions per day.
+    double mean_motion = 0.0;
+
+    double GetSemiMajorAxis() const;
+
+    double GetApogee() const;
+
+    double GetPerigee() const;
+
+    double GetAltitude() const;
+};
+
+// Parses a TLE catalog held in memory, split into chunks at record boundaries
+// that are parsed in parallel; nothing but the records themselves is
+// allocated. Malformed records are skipped and reported with their line.
+// thread_count 0 means one thread per core.
+void parseTleCatalog(const char* data, qint64 size, std::vector<TleRecord>& records, std::vector<TleError>& errors,
+                     int thread_count = 0);
+
+// Appends every satellite of a TLE catalog file (memory-mapped) to the fleet,
+// filling noradId, inclination, eccentricity, argPerigee and meanAnomaly and
+// deriving apogee, perigee and altitude from the mean motion. A satellite with
+// a value outside its parameter's range in the fleet schema (a NORAD ID below
+// 10000, a perigee below 600 km) is skipped and reported, so the fleet only
+// holds values the schema allows. Returns false only if the file could not be
+// read.
+bool importTleCatalog(const QString& file_name, Fleet& fleet, std::vector<TleError>* errors = nullptr,
+                      int thread_count = 0);
@@ -0,0 +1,189 @@
+#include "Trace.h"
+
+#include <QFile>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+std::atomic<bool> Trace::enabled_{false};
+constexpr const char* Trace::kFileVariable;
+
+namespace {
+
+// Written only by its thread; count is published with release so the
+// exporter sees complete events.
+struct ThreadBuffer {
+    std::vector<Trace::Event> events;
+    std::atomic<std::uint64_t> count{0};
+    int thread_id = 0;
+    std::string thread_name;
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+    int events_per_thread = 0;
+};
+
+// Buffers outlive their threads, so the saver and loader threads are still
+// exported after they have finished.
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+thread_local ThreadBuffer* current_buffer = nullptr;
+
+ThreadBuffer& threadBuffer() {
+    if (!current_buffer) {
+        Registry& instance = registry();
+        std::lock_guard<std::mutex> lock(instance.mutex);
+        std::unique_ptr<ThreadBuffer> buffer(new ThreadBuffer());
+        buffer->events.resize(instance.events_per_thread);
+        buffer->thread_id = static_cast<int>(instance.buffers.size()) + 1;
+        current_buffer = buffer.get();
+        instance.buffers.push_back(std::move(buffer));
+    }
+    return *current_buffer;
+}
+
+void record(const Trace::Event& event) {
+    ThreadBuffer& buffer = threadBuffer();
+    const std::uint64_t count = buffer.count.load(std::memory_order_relaxed);
+    buffer.events[count % buffer.events.size()] = event;
+    buffer.count.store(count + 1, std::memory_order_release);
+}
+
+void appendJsonString(std::string& out, const char* text) {
+    out += '"';
+    for (; *text; ++text) {
+        if (*text == '"' || *text == '\\') {
+            out += '\\';
+        }
+        out += *text;
+    }
+    out += '"';
+}
+
+}  // namespace
+
+void Trace::Enable(int events_per_thread) {
+    {
+        Registry& instance = registry();
+        std::lock_guard<std::mutex> lock(instance.mutex);
+        if (instance.events_per_thread == 0) {
+            instance.events_per_thread = events_per_thread > 0 ? events_per_thread : kDefaultEventsPerThread;
+        }
+    }
+    enabled_.store(true, std::memory_order_relaxed);
+}
+
+void Trace::Disable() {
+    enabled_.store(false, std::memory_order_relaxed);
+}
+
+std::uint64_t Trace::Now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Trace::RecordSpan(const char* name, std::uint64_t start_ns, std::uint64_t finish_ns) {
+    record({name, start_ns, finish_ns - start_ns, 0.0, false});
+}
+
+void Trace::RecordCounter(const char* name, double value) {
+    record({name, Now(), 0, value, true});
+}
+
+void Trace::SetThreadName(const char* name) {
+    if (!IsEnabled()) {
+        return;
+    }
+    ThreadBuffer& buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    buffer.thread_name = name;
+}
+
+bool Trace::WriteChromeJson(const QString& file_name, QString* message) {
+    Registry& instance = registry();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+
+    // Spans are recorded when they end, so the earliest start can be anywhere.
+    std::uint64_t origin_ns = UINT64_MAX;
+    for (const auto& buffer : instance.buffers) {
+        const std::uint64_t count = std::min<std::uint64_t>(buffer->count.load(std::memory_order_acquire),
+                                                            buffer->events.size());
+        for (std::uint64_t i = 0; i < count; ++i) {
+            origin_ns = std::min(origin_ns, buffer->events[i].start_ns);
+        }
+    }
+
+    std::string out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first_event = true;
+    char number[128];
+
+    for (const auto& buffer : instance.buffers) {
+        if (!buffer->thread_name.empty()) {
+            out += first_event ? "" : ",";
+            first_event = false;
+            std::snprintf(number, sizeof(number), "{\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"name\":\"thread_name\","
+                                                  "\"args\":{\"name\":", buffer->thread_id);
+            out += number;
+            appendJsonString(out, buffer->thread_name.c_str());
+            out += "}}";
+        }
+
+        const std::uint64_t count = buffer->count.load(std::memory_order_acquire);
+        const std::uint64_t capacity = buffer->events.size();
+        for (std::uint64_t i = count > capacity ? count - capacity : 0; i < count; ++i) {
+            const Event& event = buffer->events[i % capacity];
+            // Chrome traces count in microseconds.
+            const double ts = (event.start_ns - origin_ns) / 1000.0;
+
+            out += first_event ? "{\"name\":" : ",{\"name\":";
+            first_event = false;
+            appendJsonString(out, event.name);
+            if (event.is_counter) {
+                std::snprintf(number, sizeof(number), ",\"ph\":\"C\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,"
+                                                      "\"args\":{\"value\":%.17g}}",
+                              buffer->thread_id, ts, event.value);
+            } else {
+                std::snprintf(number, sizeof(number), ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                              buffer->thread_id, ts, event.duration_ns / 1000.0);
+            }
+            out += number;
+        }
+    }
+    out += "]}\n";
+
+    QFile file(file_name);
+    if (!file.open(QIODevice::WriteOnly) || file.write(out.data(), static_cast<qint64>(out.size())) !=
+                                            static_cast<qint64>(out.size())) {
+        if (message) {
+            *message = file.errorString();
+        }
+        return false;
+    }
+    return true;
+}
+
+TraceFile::TraceFile(QString file_name) : file_name_(std::move(file_name)) {
+    if (!file_name_.isEmpty()) {
+        Trace::Enable();
+    }
+}
+
+TraceFile::~TraceFile() {
+    if (file_name_.isEmpty()) {
+        return;
+    }
+    Trace::Disable();
+    QString message;
+    if (!Trace::WriteChromeJson(file_name_, &message)) {
+        qWarning("Could not write %s: %s", qPrintable(file_name_), qPrintable(message));
+    }
+}
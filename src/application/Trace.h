@@ -0,0 +1,102 @@
+#pragma once
+
+#include <QString>
+#include <atomic>
+#include <cstdint>
+
+// Spans and counters of the config pipeline, exported as a Chrome/Perfetto
+// trace (chrome://tracing, ui.perfetto.dev). Each thread records into its
+// own fixed-size ring buffer without locks; once a buffer is full the oldest
+// events are overwritten. While tracing is disabled a span or counter costs
+// one relaxed atomic load.
+//
+// Names must be string literals (or otherwise outlive the trace), only the
+// pointer is recorded.
+class Trace {
+public:
+    struct Event {
+        const char* name;
+        std::uint64_t start_ns;
+        // Duration of a span, unused for counters.
+        std::uint64_t duration_ns;
+        // Value of a counter, unused for spans.
+        double value;
+        bool is_counter;
+    };
+
+    static const int kDefaultEventsPerThread = 1 << 16;
+
+    // Environment variable naming the trace file when --trace is not given.
+    static constexpr const char* kFileVariable = "QTAPPTASK_TRACE";
+
+    // Starts recording. The buffer size is fixed by the first call.
+    static void Enable(int events_per_thread = kDefaultEventsPerThread);
+
+    static void Disable();
+
+    static bool IsEnabled() {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    // Monotonic nanoseconds (steady_clock, a vDSO call on Linux).
+    static std::uint64_t Now();
+
+    static void RecordSpan(const char* name, std::uint64_t start_ns, std::uint64_t finish_ns);
+
+    static void RecordCounter(const char* name, double value);
+
+    static void Count(const char* name, double value) {
+        if (IsEnabled()) {
+            RecordCounter(name, value);
+        }
+    }
+
+    // Names the calling thread in the exported trace.
+    static void SetThreadName(const char* name);
+
+    // Writes every buffered event as Chrome trace JSON. Threads should be
+    // done recording (call Disable() first), or their newest events may be
+    // torn.
+    static bool WriteChromeJson(const QString& file_name, QString* message = nullptr);
+
+private:
+    static std::atomic<bool> enabled_;
+};
+
+// Records the time from construction to destruction as a span.
+class TraceSpan {
+    const char* name_;
+    std::uint64_t start_ns_ = 0;
+
+public:
+    explicit TraceSpan(const char* name) : name_(Trace::IsEnabled() ? name : nullptr) {
+        if (name_) {
+            start_ns_ = Trace::Now();
+        }
+    }
+
+    ~TraceSpan() {
+        if (name_) {
+            Trace::RecordSpan(name_, start_ns_, Trace::Now());
+        }
+    }
+
+    TraceSpan(const TraceSpan& other) = delete;
+
+    TraceSpan& operator=(const TraceSpan& other) = delete;
+};
+
+// Records from construction and writes the trace to the file on destruction,
+// whichever way the scope is left. Does nothing for an empty file name.
+class TraceFile {
+    QString file_name_;
+
+public:
+    explicit TraceFile(QString file_name);
+
+    ~TraceFile();
+
+    TraceFile(const TraceFile& other) = delete;
+
+    TraceFile& operator=(const TraceFile& other) = delete;
+};
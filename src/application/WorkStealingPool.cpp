@@ -0,0 +1,117 @@
+#include "WorkStealingPool.h"
+
+#include <algorithm>
+
+namespace {
+
+// Pool and index of the worker running on this thread, if any.
+thread_local const WorkStealingPool* current_pool = nullptr;
+thread_local int current_worker = -1;
+
+}  // namespace
+
+WorkStealingPool::WorkStealingPool(int thread_count) {
+    if (thread_count <= 0) {
+        thread_count = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (int i = 0; i < thread_count; ++i) {
+        queues_.emplace_back(new Queue());
+    }
+    for (int i = 0; i < thread_count; ++i) {
+        threads_.emplace_back(&WorkStealingPool::run, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    Wait();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+int WorkStealingPool::GetThreadCount() const {
+    return static_cast<int>(queues_.size());
+}
+
+void WorkStealingPool::Submit(Task task) {
+    const int count = GetThreadCount();
+    const int worker = current_pool == this ? current_worker
+                                            : static_cast<int>(next_queue_.fetch_add(1) % count);
+
+    pending_.fetch_add(1);
+    {
+        std::lock_guard<std::mutex> lock(queues_[worker]->mutex);
+        queues_[worker]->tasks.push_back(std::move(task));
+    }
+    {
+        // Taking the lock orders the increment with a worker about to sleep.
+        std::lock_guard<std::mutex> lock(mutex_);
+        queued_.fetch_add(1);
+    }
+    wake_.notify_one();
+}
+
+bool WorkStealingPool::take(int worker, Task& task) {
+    {
+        Queue& own = *queues_[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+
+    const int count = GetThreadCount();
+    for (int i = 1; i < count; ++i) {
+        Queue& victim = *queues_[(worker + i) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::run(int worker) {
+    current_pool = this;
+    current_worker = worker;
+
+    Task task;
+    for (;;) {
+        if (take(worker, task)) {
+            queued_.fetch_sub(1);
+            task();
+            task = nullptr;
+
+            if (pending_.fetch_sub(1) == 1) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                idle_.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        wake_.wait(lock, [this]() {
+            return stop_ || queued_.load() > 0;
+        });
+        if (stop_ && queued_.load() == 0) {
+            return;
+        }
+    }
+}
+
+void WorkStealingPool::Wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [this]() {
+        return pending_.load() == 0;
+    });
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads with one task deque each. A worker takes its
+// own tasks from the back (most recently queued, still in cache) and, once
+// it runs dry, steals from the front of the other deques, so uneven tasks
+// (a few large files among many small ones) keep every core busy.
+class WorkStealingPool {
+public:
+    typedef std::function<void()> Task;
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable idle_;
+    bool stop_ = false;
+
+    // Tasks queued and not yet finished.
+    std::atomic<int> pending_{0};
+    // Tasks queued and not yet taken by a worker.
+    std::atomic<int> queued_{0};
+    std::atomic<unsigned> next_queue_{0};
+
+    bool take(int worker, Task& task);
+
+    void run(int worker);
+
+public:
+    // thread_count 0 means one thread per core.
+    explicit WorkStealingPool(int thread_count = 0);
+
+    // Finishes every queued task, then joins the workers.
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool& other) = delete;
+
+    WorkStealingPool& operator=(const WorkStealingPool& other) = delete;
+
+    int GetThreadCount() const;
+
+    // Called from a worker, queues on that worker's deque; otherwise the
+    // deques are filled round-robin.
+    void Submit(Task task);
+
+    // Blocks until every submitted task has finished.
+    void Wait();
+};
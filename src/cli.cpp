@@ -0,0 +1,390 @@
+#include "application/ConfigDiff.h"
+#include "application/ConfigHistory.h"
+#include "application/ConfigPatch.h"
+#include "application/ConfigSerializer.h"
+#include "application/DefaultParameters.h"
+#include "application/Fleet.h"
+#include "application/FleetColumns.h"
+#include "application/Trace.h"
+#include "application/WorkStealingPool.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+const int kMaxReportedViolations = 20;
+
+struct PatchResult {
+    bool ok = false;
+    bool changed = false;
+    QString message;
+};
+
+// Prints what changed from the first file to the second. Returns 0 when
+// nothing did, 1 when something did and 2 when a file could not be loaded.
+int printDiff(const QString& before_file, const QString& after_file, bool fleets, bool json) {
+    std::string out;
+    ConfigDiff diff;
+    ConfigError error;
+    if (fleets) {
+        Fleet before(createDefaultParameters());
+        Fleet after(createDefaultParameters());
+        if (!before.Load(before_file, &error) || !after.Load(after_file, &error)) {
+            qWarning("Could not load the fleets: %s", qPrintable(error.toString()));
+            return 2;
+        }
+        diff = diffFleets(before, after);
+        if (json) {
+            appendDiffJson(diff, before.GetSchema(), out);
+        } else {
+            appendDiffText(diff, before.GetSchema(), out);
+        }
+    } else {
+        // The files as they are: no journal is replayed, so nothing next to
+        // them is touched either.
+        ParameterStore before = createDefaultParameters();
+        ParameterStore after = createDefaultParameters();
+        if (!createSerializer(formatForFile(before_file))->Load(before_file, before, &error) ||
+            !createSerializer(formatForFile(after_file))->Load(after_file, after, &error)) {
+            qWarning("Could not load the configs: %s", qPrintable(error.toString()));
+            return 2;
+        }
+        diff = diffConfigs(before, after);
+        if (json) {
+            appendDiffJson(diff, before, out);
+        } else {
+            appendDiffText(diff, before, out);
+        }
+    }
+
+    std::fwrite(out.data(), 1, out.size(), stdout);
+    return diff.empty() ? 0 : 1;
+}
+
+QString formatTime(qint64 time) {
+    return QDateTime::fromMSecsSinceEpoch(time).toString("yyyy-MM-dd hh:mm:ss.zzz");
+}
+
+// Lists the versions of a config, or the values one parameter took in them.
+int printHistory(const ConfigHistory& history, const QString& config_file, const QString& parameter) {
+    QString message;
+    if (!parameter.isEmpty()) {
+        std::vector<ParameterVersion> values;
+        if (!history.GetParameterHistory(config_file, parameter, values, &message)) {
+            qWarning("%s", qPrintable(message));
+            return 1;
+        }
+        for (const ParameterVersion& value : values) {
+            std::printf("%5d  %s  %s\n", value.number, qPrintable(formatTime(value.time)),
+                        qPrintable(value.value.toString()));
+        }
+        return 0;
+    }
+
+    std::vector<ConfigVersion> versions;
+    if (!history.GetVersions(config_file, versions, &message)) {
+        qWarning("%s", qPrintable(message));
+        return 1;
+    }
+    for (size_t i = 0; i < versions.size(); ++i) {
+        int changed = 0;
+        for (size_t chunk = 0; chunk < versions[i].chunks.size(); ++chunk) {
+            changed += i == 0 || versions[i].schema != versions[i - 1].schema ||
+                       chunk >= versions[i - 1].chunks.size() ||
+                       versions[i].chunks[chunk] != versions[i - 1].chunks[chunk];
+        }
+        std::printf("%5d  %s  %d of %d chunks changed\n", versions[i].number,
+                    qPrintable(formatTime(versions[i].time)), changed, static_cast<int>(versions[i].chunks.size()));
+    }
+    std::printf("%d versions, %lld bytes stored in %s\n", static_cast<int>(versions.size()),
+                static_cast<long long>(history.GetStoredBytes()), qPrintable(history.GetDirectory()));
+    return 0;
+}
+
+// Restores a version given by number or the last one saved at or before an
+// ISO 8601 time.
+int restoreVersion(ConfigHistory& history, const QString& config_file, const QString& target) {
+    QString message;
+    std::vector<ConfigVersion> versions;
+    if (!history.GetVersions(config_file, versions, &message)) {
+        qWarning("%s", qPrintable(message));
+        return 1;
+    }
+
+    bool is_number = false;
+    const int number = target.toInt(&is_number);
+    const ConfigVersion* version = nullptr;
+    if (is_number) {
+        if (number >= 0 && number < static_cast<int>(versions.size())) {
+            version = &versions[number];
+        }
+    } else {
+        const QDateTime time = QDateTime::fromString(target, Qt::ISODate);
+        for (const ConfigVersion& candidate : versions) {
+            if (time.isValid() && candidate.time <= time.toMSecsSinceEpoch()) {
+                version = &candidate;
+            }
+        }
+    }
+    if (!version) {
+        qWarning("No version %s of %s", qPrintable(target), qPrintable(config_file));
+        return 1;
+    }
+
+    if (!restoreConfigVersion(history, config_file, *version, &message)) {
+        qWarning("Could not restore %s: %s", qPrintable(config_file), qPrintable(message));
+        return 1;
+    }
+    std::printf("Restored version %d of %s\n", version->number, qPrintable(formatTime(version->time)));
+    return 0;
+}
+
+// Converts a fleet file to chunked columns or, with to_columns false, back.
+int convertFleetColumns(const QString& source, const QString& target, bool to_columns, int thread_count) {
+    Fleet fleet(createDefaultParameters());
+    QString message;
+    auto start = std::chrono::steady_clock::now();
+    if (to_columns) {
+        ConfigError error;
+        if (!fleet.Load(source, &error)) {
+            qWarning("Could not load %s: %s", qPrintable(source), qPrintable(error.toString()));
+            return 1;
+        }
+        start = std::chrono::steady_clock::now();
+        if (!exportFleetColumns(fleet, target, &message, thread_count)) {
+            qWarning("%s", qPrintable(message));
+            return 1;
+        }
+    } else {
+        if (!importFleetColumns(source, fleet, &message)) {
+            qWarning("%s", qPrintable(message));
+            return 1;
+        }
+        // Derived columns follow their inputs in the JSON whatever the file
+        // held; a fleet still breaking a check is not written.
+        const ParameterRules rules = createDefaultRules(fleet.GetSchema());
+        rules.Derive(fleet);
+        const std::vector<RuleViolation> violations = rules.Validate(fleet, thread_count);
+        if (!violations.empty()) {
+            for (size_t i = 0; i < violations.size() && i < kMaxReportedViolations; ++i) {
+                qWarning("%s: satellite %d: %s", qPrintable(source), violations[i].satellite + 1,
+                         qPrintable(violations[i].message));
+            }
+            if (violations.size() > kMaxReportedViolations) {
+                qWarning("%s: %d more rule violations", qPrintable(source),
+                         static_cast<int>(violations.size()) - kMaxReportedViolations);
+            }
+            return 1;
+        }
+        if (!fleet.Save(target, &message)) {
+            qWarning("Could not write %s: %s", qPrintable(target), qPrintable(message));
+            return 1;
+        }
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const double megabytes = QFileInfo(to_columns ? target : source).size() / 1e6;
+    std::printf("%d satellites, %.1f MB of columns %s in %.3f s (%.0f MB/s)\n", fleet.GetSatelliteCount(), megabytes,
+                to_columns ? "written" : "read", seconds, seconds > 0 ? megabytes / seconds : 0.0);
+    return 0;
+}
+
+// Whether the file starts like a config: a JSON object or a CBOR map, not a
+// fleet (an array) or chunked columns.
+bool startsLikeConfig(const QString& file_name) {
+    QFile file(file_name);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return true;  // Reported by the patch.
+    }
+    const QByteArray head = file.read(256);
+    if (formatForFile(file_name) == CONFIG_FORMAT::Cbor) {
+        const uchar major = head.isEmpty() ? 0 : static_cast<uchar>(head[0]);
+        return major >= 0xA0 && major <= 0xBF;
+    }
+    for (char c : head) {
+        if (c != ' ' && c != '\t' && c != '\r' && c != '\n') {
+            return c == '{';
+        }
+    }
+    return false;
+}
+
+// The configs of a directory: its .json and .cbor files except unsaved side
+// files ("config.unsaved.json"), the excluded files (the patch, the trace)
+// and files that are not configs at all, such as fleets.
+QStringList findConfigs(const QDir& directory, const QStringList& excluded) {
+    QStringList excluded_paths;
+    for (const QString& file_name : excluded) {
+        if (!file_name.isEmpty()) {
+            excluded_paths.append(QFileInfo(file_name).absoluteFilePath());
+        }
+    }
+
+    QStringList files;
+    for (const QFileInfo& info : directory.entryInfoList({"*.json", "*.cbor"}, QDir::Files, QDir::Name)) {
+        if (info.completeBaseName().endsWith(".unsaved") || excluded_paths.contains(info.absoluteFilePath())) {
+            continue;
+        }
+        if (!startsLikeConfig(info.filePath())) {
+            qWarning("%s: not a config, skipped", qPrintable(info.filePath()));
+            continue;
+        }
+        files.append(info.filePath());
+    }
+    return files;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    QCoreApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Applies a patch set to every config of a directory, with --diff prints "
+                                     "what changed between two configs, with --history lists the saved "
+                                     "versions of a config, or converts a fleet to and from chunked columns.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("directory", "Directory holding the .json and .cbor configs, or the "
+                                              "configs themselves (with --diff: the older and the newer file, with --history "
+                                              "or --restore: the config, with --export-columns: the fleet, "
+                                              "with --import-columns: the columns file).");
+    QCommandLineOption patch_option("patch", "JSON object of parameter values to set.", "file");
+    QCommandLineOption set_option("set", "Parameter value to set, may be repeated.", "name=value");
+    QCommandLineOption threads_option("threads", "Worker threads (default: one per core).", "count", "0");
+    QCommandLineOption diff_option("diff", "Print the parameters changed between two files and exit with 1 if "
+                                           "any did.");
+    QCommandLineOption json_option("json", "With --diff, print the changes as JSON.");
+    QCommandLineOption fleet_option("fleet", "With --diff, compare two fleet files.");
+    QCommandLineOption history_option("history", "List the saved versions of a config.");
+    QCommandLineOption parameter_option("parameter", "With --history, list the values of one parameter.", "name");
+    QCommandLineOption restore_option("restore", "Rewrite a config with a saved version, by number or as of an "
+                                                 "ISO 8601 time.", "version");
+    QCommandLineOption history_dir_option("history-dir", "Directory of the saved versions "
+                                                         "(default: .history next to the config).", "directory");
+    QCommandLineOption export_columns_option("export-columns", "Write the fleet as chunked columns to this file.",
+                                             "file");
+    QCommandLineOption import_columns_option("import-columns", "Write the chunked columns as a fleet to this "
+                                                               "file.", "file");
+    QCommandLineOption trace_option("trace", QString("Write a Chrome trace of the run (default: $%1).")
+                                    .arg(Trace::kFileVariable), "file");
+    parser.addOption(patch_option);
+    parser.addOption(set_option);
+    parser.addOption(threads_option);
+    parser.addOption(diff_option);
+    parser.addOption(json_option);
+    parser.addOption(fleet_option);
+    parser.addOption(history_option);
+    parser.addOption(parameter_option);
+    parser.addOption(restore_option);
+    parser.addOption(history_dir_option);
+    parser.addOption(export_columns_option);
+    parser.addOption(import_columns_option);
+    parser.addOption(trace_option);
+    parser.process(a);
+
+    // Written on every return below, whichever mode ran.
+    const QString trace_file_name = parser.isSet(trace_option) ? parser.value(trace_option)
+                                                               : qEnvironmentVariable(Trace::kFileVariable);
+    TraceFile trace_file(trace_file_name);
+
+    if (parser.isSet(diff_option)) {
+        if (parser.positionalArguments().size() != 2) {
+            parser.showHelp(2);
+        }
+        return printDiff(parser.positionalArguments().at(0), parser.positionalArguments().at(1),
+                         parser.isSet(fleet_option), parser.isSet(json_option));
+    }
+
+    const QStringList arguments = parser.positionalArguments();
+    const bool modifies_one_file = parser.isSet(export_columns_option) || parser.isSet(import_columns_option) ||
+                                   parser.isSet(history_option) || parser.isSet(restore_option);
+    if (arguments.isEmpty() || (modifies_one_file && arguments.size() != 1)) {
+        parser.showHelp(1);
+    }
+
+    if (parser.isSet(export_columns_option) || parser.isSet(import_columns_option)) {
+        const bool to_columns = parser.isSet(export_columns_option);
+        return convertFleetColumns(parser.positionalArguments().at(0),
+                                   parser.value(to_columns ? export_columns_option : import_columns_option),
+                                   to_columns, parser.value(threads_option).toInt());
+    }
+
+    if (parser.isSet(history_option) || parser.isSet(restore_option)) {
+        const QString config_file = parser.positionalArguments().at(0);
+        ConfigHistory history(parser.isSet(history_dir_option) ? parser.value(history_dir_option)
+                                                               : ConfigHistory::defaultDirectoryFor(config_file));
+        if (parser.isSet(restore_option)) {
+            return restoreVersion(history, config_file, parser.value(restore_option));
+        }
+        return printHistory(history, config_file, parser.value(parameter_option));
+    }
+
+    ConfigPatch patch;
+    if (parser.isSet(patch_option)) {
+        ConfigError error;
+        if (!loadConfigPatch(parser.value(patch_option), patch, &error)) {
+            qWarning("Could not load %s: %s", qPrintable(parser.value(patch_option)), qPrintable(error.toString()));
+            return 1;
+        }
+    }
+    for (const QString& entry : parser.values(set_option)) {
+        if (!parseConfigPatchEntry(entry, patch)) {
+            qWarning("Expected name=value, got %s", qPrintable(entry));
+            return 1;
+        }
+    }
+
+    // A value no config could take is reported once, before any file is read.
+    QString patch_message;
+    ConfigPatch checked_patch = patch;
+    if (!checkConfigPatch(createDefaultParameters(), checked_patch, &patch_message)) {
+        qWarning("%s", qPrintable(patch_message));
+        return 1;
+    }
+
+    // A directory is searched for configs; files named explicitly are taken
+    // as they are.
+    QStringList files;
+    if (arguments.size() == 1 && QFileInfo(arguments.at(0)).isDir()) {
+        files = findConfigs(QDir(arguments.at(0)), {parser.value(patch_option), trace_file_name});
+    } else {
+        files = arguments;
+    }
+
+    std::vector<PatchResult> results(files.size());
+    auto start = std::chrono::steady_clock::now();
+    {
+        WorkStealingPool pool(parser.value(threads_option).toInt());
+        for (int i = 0; i < files.size(); ++i) {
+            pool.Submit([&, i]() {
+                TraceSpan span("apply patch");
+                PatchResult& result = results[i];
+                result.ok = applyConfigPatch(files[i], patch, &result.changed, &result.message);
+            });
+        }
+        pool.Wait();
+    }
+    auto finish = std::chrono::steady_clock::now();
+
+    int changed = 0;
+    int failed = 0;
+    for (int i = 0; i < files.size(); ++i) {
+        if (!results[i].ok) {
+            qWarning("%s: %s", qPrintable(files[i]), qPrintable(results[i].message));
+            ++failed;
+        }
+        changed += results[i].changed;
+    }
+
+    const double seconds = std::chrono::duration<double>(finish - start).count();
+    std::printf("%d files, %d changed, %d failed in %.3f s (%.0f files/s)\n", files.size(), changed, failed,
+                seconds, seconds > 0 ? files.size() / seconds : 0.0);
+
+    return failed == 0 ? 0 : 1;
+}
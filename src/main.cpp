@@ -1,10 +1,139 @@
 #include "application/Application.h"
+#include "application/ConfigHistory.h"
+#include "application/DefaultParameters.h"
+#include "application/FleetWindow.h"
+#include "application/SharedSnapshot.h"
+#include "application/Trace.h"
+
+#include <QCommandLineParser>
+
+namespace {
+
+// The parameters of the --schema file, or the built-in satellite schema.
+bool loadDefaults(const QString& schema_file, ParameterStore& defaults) {
+    if (schema_file.isEmpty()) {
+        defaults = createDefaultParameters();
+        return true;
+    }
+    ParameterSchema schema;
+    QString message;
+    if (!loadParameterSchema(schema_file, schema, &message)) {
+        qWarning("Could not load the schema %s", qPrintable(message));
+        return false;
+    }
+    defaults = createParameterStore(schema);
+    return true;
+}
+
+}  // namespace
 
 int main(int argc, char *argv[]) {
     QApplication a(argc, argv);
 
-    MainWindow w;
-    w.show();
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption fleet_option("fleet", "Open a fleet file with one row per satellite.", "file");
+    QCommandLineOption tle_option("import-tle", "Import a TLE catalog into the --fleet file (default fleet.json).",
+                                  "file");
+    QCommandLineOption config_option("config", "Config file to edit.", "file", "config.json");
+    QCommandLineOption schema_option("schema", "Parameter schema of the config, e.g. of a user-defined kind of "
+                                     "satellite (default: the built-in satellite schema).", "file");
+    QCommandLineOption format_option("format", "Config format: json or cbor (default: by file extension).", "format");
+    QCommandLineOption convert_option("convert", "Convert a config file to the --output file and exit.", "file");
+    QCommandLineOption output_option("output", "Target file for --convert (required).", "file");
+    QCommandLineOption eager_option("eager-widgets", "Create every input at startup instead of on first show.");
+    QCommandLineOption startup_report_option("startup-report", "Log the duration of each startup phase.");
+    QCommandLineOption snapshot_option("shared-snapshot",
+                                       "Publish the saved values in shared memory for other processes.");
+    QCommandLineOption history_option("history", "Keep every saved version of the config in .history next to it.");
+    QCommandLineOption history_dir_option("history-dir", "Keep every saved version of the config in this "
+                                          "directory.", "directory");
+    QCommandLineOption telemetry_option("telemetry",
+                                        "Show live values from a file or named pipe of \"name value\" lines "
+                                        "(repeatable).", "file");
+    QCommandLineOption trace_option("trace", QString("Write a Chrome trace of the run (default: $%1).")
+                                    .arg(Trace::kFileVariable), "file");
+    parser.addOption(fleet_option);
+    parser.addOption(tle_option);
+    parser.addOption(config_option);
+    parser.addOption(schema_option);
+    parser.addOption(format_option);
+    parser.addOption(convert_option);
+    parser.addOption(output_option);
+    parser.addOption(eager_option);
+    parser.addOption(startup_report_option);
+    parser.addOption(snapshot_option);
+    parser.addOption(history_option);
+    parser.addOption(history_dir_option);
+    parser.addOption(telemetry_option);
+    parser.addOption(trace_option);
+    parser.process(a);
+
+    // Written on every return below. The windows save on destruction, which
+    // is part of the trace, so they must go out of scope first.
+    TraceFile trace_file(parser.isSet(trace_option) ? parser.value(trace_option)
+                                                    : qEnvironmentVariable(Trace::kFileVariable));
+
+    CONFIG_FORMAT format = CONFIG_FORMAT::Auto;
+    if (parser.value(format_option) == "json") {
+        format = CONFIG_FORMAT::Json;
+    } else if (parser.value(format_option) == "cbor") {
+        format = CONFIG_FORMAT::Cbor;
+    }
+
+    if (parser.isSet(convert_option)) {
+        if (!parser.isSet(output_option)) {
+            qWarning("--convert needs an --output file");
+            return 1;
+        }
+        // Values are read and written by the names and types of --schema.
+        ParameterStore defaults;
+        if (!loadDefaults(parser.value(schema_option), defaults)) {
+            return 1;
+        }
+        ConfigError error;
+        if (!convertConfigFile(parser.value(convert_option), parser.value(output_option), std::move(defaults), format,
+                               &error)) {
+            qWarning("%s", qPrintable(error.toString()));
+            return 1;
+        }
+        return 0;
+    }
+
+    int result = 0;
+    if (parser.isSet(fleet_option) || parser.isSet(tle_option)) {
+        FleetWindow w(nullptr, parser.isSet(fleet_option) ? parser.value(fleet_option) : "fleet.json",
+                      parser.value(tle_option));
+        w.show();
+
+        result = QApplication::exec();
+    } else {
+        ParameterStore defaults;
+        if (!loadDefaults(parser.value(schema_option), defaults)) {
+            return 1;
+        }
+        MainWindow w(nullptr, parser.value(config_option), std::move(defaults), format, !parser.isSet(eager_option));
+        w.setStartupReport(parser.isSet(startup_report_option));
+        // Both write outside the config (a directory of versions, a shared
+        // memory segment), so they are opt-in.
+        if (parser.isSet(history_dir_option)) {
+            w.setHistoryDirectory(parser.value(history_dir_option));
+        } else if (parser.isSet(history_option)) {
+            w.setHistoryDirectory(ConfigHistory::defaultDirectoryFor(parser.value(config_option)));
+        }
+        if (parser.isSet(snapshot_option)) {
+            w.publishSnapshot(sharedSnapshotKey(parser.value(config_option)));
+        }
+        for (const QString& source : parser.values(telemetry_option)) {
+            QString message;
+            if (!w.addTelemetrySource(source, &message)) {
+                qWarning("Could not open %s: %s", qPrintable(source), qPrintable(message));
+            }
+        }
+        w.show();
+
+        result = QApplication::exec();
+    }
 
-    return QApplication::exec();
+    return result;
 }
@@ -0,0 +1,187 @@
+// Feeds live values to QtAppTask --telemetry: replays a recording of
+// "seconds name value" lines at its own pace (or faster), or generates
+// values at a fixed rate, writing "name value" lines to a file or named
+// pipe.
+
+#include <QByteArray>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Event {
+    double time;
+    // "name value\n"
+    std::string line;
+};
+
+bool loadRecording(const QString& file_name, std::vector<Event>& events, QString* message) {
+    QFile file(file_name);
+    if (!file.open(QIODevice::ReadOnly)) {
+        *message = file.errorString();
+        return false;
+    }
+    int line_number = 0;
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine().trimmed();
+        ++line_number;
+        if (line.isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+        const int separator = line.indexOf(' ');
+        bool ok = separator > 0;
+        const double time = ok ? line.left(separator).toDouble(&ok) : 0.0;
+        if (!ok) {
+            *message = QString("Line %1 does not start with a time in seconds.").arg(line_number);
+            return false;
+        }
+        events.push_back({time, line.mid(separator + 1).trimmed().toStdString() + "\n"});
+    }
+    std::stable_sort(events.begin(), events.end(), [](const Event& a, const Event& b) {
+        return a.time < b.time;
+    });
+    return true;
+}
+
+// "name=min..max": a sine between min and max with a period of one minute,
+// rounded when both bounds are integers.
+bool generateEvents(const QStringList& generators, double rate, double duration, std::vector<Event>& events,
+                    QString* message) {
+    const double kPi = 3.14159265358979323846;
+    const double kPeriod = 60.0;
+    for (const QString& generator : generators) {
+        const int equals = generator.indexOf('=');
+        const QStringList bounds = generator.mid(equals + 1).split("..");
+        bool min_ok = false;
+        bool max_ok = false;
+        const double min = bounds.size() == 2 ? bounds[0].toDouble(&min_ok) : 0.0;
+        const double max = bounds.size() == 2 ? bounds[1].toDouble(&max_ok) : 0.0;
+        if (equals <= 0 || !min_ok || !max_ok) {
+            *message = QString("Expected name=min..max, got %1.").arg(generator);
+            return false;
+        }
+        const std::string name = generator.left(equals).toStdString();
+        const bool integers = min == std::floor(min) && max == std::floor(max);
+
+        const long long count = static_cast<long long>(duration * rate);
+        for (long long i = 0; i < count; ++i) {
+            const double time = i / rate;
+            double value = min + (max - min) * (0.5 + 0.5 * std::sin(2.0 * kPi * time / kPeriod));
+            char text[32];
+            if (integers) {
+                std::snprintf(text, sizeof(text), "%.0f", std::round(value));
+            } else {
+                std::snprintf(text, sizeof(text), "%.6f", value);
+            }
+            events.push_back({time, name + " " + text + "\n"});
+        }
+    }
+    std::stable_sort(events.begin(), events.end(), [](const Event& a, const Event& b) {
+        return a.time < b.time;
+    });
+    return true;
+}
+
+// Writes every event whose time has come in one go, then sleeps until the
+// next one; speed 0 writes as fast as the reader takes them. Returns the
+// number of lines written.
+long long replay(const std::vector<Event>& events, std::FILE* output, double speed, int repeats) {
+    long long written = 0;
+    for (int repeat = 0; repeat < repeats; ++repeat) {
+        const auto start = std::chrono::steady_clock::now();
+        size_t next = 0;
+        while (next < events.size()) {
+            if (speed > 0.0) {
+                const auto due = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double>(events[next].time / speed));
+                std::this_thread::sleep_until(due);
+            }
+            const double now = speed > 0.0
+                               ? std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * speed
+                               : events.back().time;
+            for (; next < events.size() && events[next].time <= now; ++next) {
+                std::fwrite(events[next].line.data(), 1, events[next].line.size(), output);
+                ++written;
+            }
+            if (std::fflush(output) != 0) {
+                return written;
+            }
+        }
+    }
+    return written;
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    QCoreApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Writes live values for QtAppTask --telemetry from a recording of "
+                                     "\"seconds name value\" lines or from --generate.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("recording", "Recorded values, ordered or not by time.", "[recording]");
+    QCommandLineOption output_option("output", "File or named pipe to write to (default: stdout).", "file");
+    QCommandLineOption speed_option("speed", "Replay speed factor; 0 writes as fast as possible.", "factor", "1");
+    QCommandLineOption repeat_option("repeat", "Number of times to replay.", "count", "1");
+    QCommandLineOption generate_option("generate", "Generate a sine between min and max (repeatable).",
+                                       "name=min..max");
+    QCommandLineOption rate_option("rate", "With --generate, updates per second per parameter.", "hz", "1000");
+    QCommandLineOption duration_option("duration", "With --generate, seconds to generate.", "seconds", "10");
+    parser.addOption(output_option);
+    parser.addOption(speed_option);
+    parser.addOption(repeat_option);
+    parser.addOption(generate_option);
+    parser.addOption(rate_option);
+    parser.addOption(duration_option);
+    parser.process(a);
+
+    std::vector<Event> events;
+    QString message;
+    bool ok = false;
+    if (parser.isSet(generate_option)) {
+        ok = generateEvents(parser.values(generate_option), parser.value(rate_option).toDouble(),
+                            parser.value(duration_option).toDouble(), events, &message);
+    } else if (parser.positionalArguments().size() == 1) {
+        ok = loadRecording(parser.positionalArguments().first(), events, &message);
+    } else {
+        parser.showHelp(1);
+    }
+    if (!ok) {
+        qWarning("%s", qPrintable(message));
+        return 1;
+    }
+
+    // A reader going away ends the replay instead of the process.
+    std::signal(SIGPIPE, SIG_IGN);
+    std::FILE* output = stdout;
+    if (parser.isSet(output_option)) {
+        // Blocks until a reader opens a named pipe.
+        output = std::fopen(QFile::encodeName(parser.value(output_option)).constData(), "w");
+        if (output == nullptr) {
+            qWarning("Could not open %s", qPrintable(parser.value(output_option)));
+            return 1;
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const long long written = replay(events, output, parser.value(speed_option).toDouble(),
+                                     parser.value(repeat_option).toInt());
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::fprintf(stderr, "%lld updates in %.3f s (%.0f per second)\n", written, seconds,
+                 seconds > 0.0 ? written / seconds : 0.0);
+
+    if (output != stdout) {
+        std::fclose(output);
+    }
+    return written == static_cast<long long>(events.size()) * parser.value(repeat_option).toInt() ? 0 : 1;
+}
@@ -0,0 +1,243 @@
+// Compiles a parameter schema (see ParameterSchema.h) into a C++ header and
+// source: constexpr descriptor tables from which createParameterStore()
+// builds the store, and one type per parameter with its column, slot,
+// bounds and default as constants for getParameterValue<Field>(). Run by
+// the build for schemas/satellite.json.
+
+#include "application/ParameterSchema.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+#include <QTextStream>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+
+namespace {
+
+// A C++ string literal; bytes outside printable ASCII as octal escapes.
+QString literal(const QString& text) {
+    QString result = "\"";
+    for (const char c : text.toUtf8()) {
+        const unsigned char byte = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\') {
+            result += '\\';
+            result += c;
+        } else if (byte < 0x20 || byte > 0x7e) {
+            result += QString("\\%1").arg(static_cast<int>(byte), 3, 8, QChar('0'));
+        } else {
+            result += c;
+        }
+    }
+    return result + "\"";
+}
+
+// A double literal that reads back to the same value.
+QString number(double value) {
+    if (value == std::numeric_limits<double>::max()) {
+        return "std::numeric_limits<double>::max()";
+    }
+    if (value == std::numeric_limits<double>::lowest()) {
+        return "std::numeric_limits<double>::lowest()";
+    }
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.17g", value);
+    QString result = text;
+    if (!result.contains('.') && !result.contains('e')) {
+        result += ".0";
+    }
+    return result;
+}
+
+QString integer(double value) {
+    if (value == std::numeric_limits<int>::max()) {
+        return "std::numeric_limits<int>::max()";
+    }
+    if (value == std::numeric_limits<int>::min()) {
+        return "std::numeric_limits<int>::min()";
+    }
+    return QString::number(static_cast<long long>(value));
+}
+
+QString typeName(TYPE_PARAMETER type) {
+    switch (type) {
+        case TYPE_PARAMETER::LineEdit:
+            return "TYPE_PARAMETER::LineEdit";
+        case TYPE_PARAMETER::CheckBox:
+            return "TYPE_PARAMETER::CheckBox";
+        case TYPE_PARAMETER::SpinBox:
+            return "TYPE_PARAMETER::SpinBox";
+        case TYPE_PARAMETER::DoubleSpinBox:
+            break;
+    }
+    return "TYPE_PARAMETER::DoubleSpinBox";
+}
+
+QString columnName(TYPE_PARAMETER type) {
+    switch (type) {
+        case TYPE_PARAMETER::LineEdit:
+            return "LineEditColumn";
+        case TYPE_PARAMETER::CheckBox:
+            return "CheckBoxColumn";
+        case TYPE_PARAMETER::SpinBox:
+            return "IntSpinBoxColumn";
+        case TYPE_PARAMETER::DoubleSpinBox:
+            break;
+    }
+    return "DoubleSpinBoxColumn";
+}
+
+// Name of the type of a parameter: "argPerigee" -> "ArgPerigee".
+QString fieldName(const QString& name) {
+    return name.left(1).toUpper() + name.mid(1);
+}
+
+// The constants of a field, as "type name = value" declarations.
+QStringList fieldConstants(const ParameterDefinition& parameter) {
+    switch (parameter.type) {
+        case TYPE_PARAMETER::LineEdit:
+            return {"const char* kDefault = " + literal(parameter.text)};
+        case TYPE_PARAMETER::CheckBox:
+            return {QString("bool kDefault = ") + (parameter.value != 0.0 ? "true" : "false")};
+        case TYPE_PARAMETER::SpinBox:
+            return {"int kMin = " + integer(parameter.min), "int kMax = " + integer(parameter.max),
+                    "int kStep = " + integer(parameter.step), "int kDefault = " + integer(parameter.value)};
+        case TYPE_PARAMETER::DoubleSpinBox:
+            break;
+    }
+    return {"double kMin = " + number(parameter.min), "double kMax = " + number(parameter.max),
+            "double kStep = " + number(parameter.step), "double kDefault = " + number(parameter.value)};
+}
+
+bool writeFile(const QString& file_name, const QString& text, QString* message) {
+    QFile file(file_name);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(text.toUtf8()) < 0) {
+        *message = QString("%1: %2").arg(file_name, file.errorString());
+        return false;
+    }
+    return true;
+}
+
+bool generate(const ParameterSchema& schema, const QString& schema_file, const QString& header_file,
+              const QString& source_file, QString* message) {
+    const QString type = schema.name + "Schema";
+    const QString banner = QString("// Generated by QtAppTask-schemac from %1; do not edit.\n")
+        .arg(QFileInfo(schema_file).fileName());
+
+    QSet<QString> fields = {"Create", "Matches"};
+    for (const ParameterDefinition& parameter : schema.parameters) {
+        const QString field = fieldName(parameter.name);
+        if (fields.contains(field)) {
+            *message = QString("%1 would define %2::%3 twice.").arg(parameter.name, type, field);
+            return false;
+        }
+        fields.insert(field);
+    }
+
+    QString header;
+    QTextStream out(&header);
+    out << banner << "#pragma once\n\n"
+        << "#include \"ParameterSchema.h\"\n#include \"ParameterStore.h\"\n\n#include <limits>\n\n"
+        << "// The " << schema.name << " parameters as constexpr tables, with one type per parameter\n"
+        << "// for getParameterValue<" << type << "::" << fieldName(schema.parameters.front().name)
+        << ">(parameters) and the like.\n"
+        << "struct " << type << " {\n"
+        << "    static constexpr int kParameterCount = " << schema.parameters.size() << ";\n"
+        << "    static constexpr int kSectionCount = " << schema.sections.size() << ";\n\n"
+        << "    static constexpr ParameterDescriptor kParameters[kParameterCount] = {\n";
+    for (const ParameterDefinition& parameter : schema.parameters) {
+        out << "        {" << literal(parameter.name) << ", " << typeName(parameter.type) << ", "
+            << literal(parameter.label) << ",\n         " << literal(parameter.placeholder) << ", "
+            << literal(parameter.text) << ", " << number(parameter.min) << ", " << number(parameter.max) << ", "
+            << number(parameter.step) << ", " << number(parameter.value) << "},\n";
+    }
+    out << "    };\n\n"
+        << "    static constexpr SectionDescriptor kSections[kSectionCount] = {\n";
+    for (const SectionDefinition& section : schema.sections) {
+        out << "        {" << literal(section.title) << ", " << section.begin << "},\n";
+    }
+    out << "    };\n";
+
+    QString definitions;
+    QTextStream defined(&definitions);
+    int column_sizes[4] = {};
+    for (size_t slot = 0; slot < schema.parameters.size(); ++slot) {
+        const ParameterDefinition& parameter = schema.parameters[slot];
+        const QString field = fieldName(parameter.name);
+        const int index = column_sizes[static_cast<int>(parameter.type)]++;
+        out << "\n    struct " << field << " {\n"
+            << "        typedef " << columnName(parameter.type) << " Column;\n"
+            << "        static constexpr const char* kName = " << literal(parameter.name) << ";\n"
+            << "        static constexpr int kSlot = " << slot << ";\n"
+            << "        static constexpr int kIndex = " << index << ";\n";
+        defined << "constexpr const char* " << type << "::" << field << "::kName;\n"
+                << "constexpr int " << type << "::" << field << "::kSlot;\n"
+                << "constexpr int " << type << "::" << field << "::kIndex;\n";
+        for (const QString& constant : fieldConstants(parameter)) {
+            out << "        static constexpr " << constant << ";\n";
+            const QString declaration = constant.left(constant.indexOf(" = "));
+            const int name = declaration.lastIndexOf(' ') + 1;
+            defined << "constexpr " << declaration.left(name) << type << "::" << field << "::"
+                    << declaration.mid(name) << ";\n";
+        }
+        out << "    };\n";
+    }
+    out << "\n    // A store with the default values.\n"
+        << "    static ParameterStore Create();\n\n"
+        << "    // Whether the store has these names and types in this order, which\n"
+        << "    // makes the fields valid on it, e.g. for a store built at runtime.\n"
+        << "    static bool Matches(const ParameterStore& parameters);\n"
+        << "};\n";
+    out.flush();
+
+    QString source;
+    QTextStream cpp(&source);
+    defined.flush();
+    cpp << banner << "#include \"" << QFileInfo(header_file).fileName() << "\"\n"
+        << "#include \"DefaultParameters.h\"\n\n"
+        << "constexpr int " << type << "::kParameterCount;\n"
+        << "constexpr int " << type << "::kSectionCount;\n"
+        << "constexpr ParameterDescriptor " << type << "::kParameters[];\n"
+        << "constexpr SectionDescriptor " << type << "::kSections[];\n"
+        << definitions << "\n"
+        << "ParameterStore " << type << "::Create() {\n"
+        << "    return createParameterStore(kParameters, kParameterCount, kSections, kSectionCount);\n"
+        << "}\n\n"
+        << "bool " << type << "::Matches(const ParameterStore& parameters) {\n"
+        << "    return matchesParameterDescriptors(parameters, kParameters, kParameterCount);\n"
+        << "}\n";
+    cpp.flush();
+
+    return writeFile(header_file, header, message) && writeFile(source_file, source, message);
+}
+
+}  // namespace
+
+int main(int argc, char *argv[]) {
+    QCoreApplication a(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Generates the constexpr parameter tables of a schema.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("schema", "Schema file (JSON).");
+    parser.addPositionalArgument("header", "Header to write.");
+    parser.addPositionalArgument("source", "Source file to write.");
+    parser.process(a);
+
+    const QStringList arguments = parser.positionalArguments();
+    if (arguments.size() != 3) {
+        parser.showHelp(1);
+    }
+
+    ParameterSchema schema;
+    QString message;
+    if (!loadParameterSchema(arguments[0], schema, &message) ||
+        !generate(schema, arguments[0], arguments[1], arguments[2], &message)) {
+        qWarning("%s", qPrintable(message));
+        return 1;
+    }
+    return 0;
+}
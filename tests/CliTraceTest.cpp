@@ -0,0 +1,49 @@
+// The command line tool writes --trace on every mode, not only when it
+// applies a patch set: modes that return early still leave a trace.
+
+#include "ConfigSerializer.h"
+#include "DefaultParameters.h"
+
+#include <QFile>
+#include <QProcess>
+#include <QTemporaryDir>
+#include <QtTest>
+#include <algorithm>
+
+class CliTraceTest : public QObject {
+    Q_OBJECT
+
+private slots:
+    void diffWritesTrace() {
+        QTemporaryDir directory;
+        QVERIFY(directory.isValid());
+
+        ConfigSnapshot snapshot = takeSnapshot(createDefaultParameters());
+        const QString before_file = directory.filePath("before.cbor");
+        const QString after_file = directory.filePath("after.cbor");
+        QString message;
+        QVERIFY2(writeConfigFile(before_file, CONFIG_FORMAT::Cbor, snapshot, &message), qPrintable(message));
+        auto flag = std::find_if(snapshot.begin(), snapshot.end(), [](const ConfigValue& value) {
+            return value.type == TYPE_PARAMETER::CheckBox;
+        });
+        QVERIFY(flag != snapshot.end());
+        flag->value = !flag->value.toBool();
+        QVERIFY2(writeConfigFile(after_file, CONFIG_FORMAT::Cbor, snapshot, &message), qPrintable(message));
+
+        const QString trace_file = directory.filePath("trace.json");
+        QProcess cli;
+        cli.start(QTAPPTASK_CLI, {"--diff", before_file, after_file, "--trace", trace_file});
+        QVERIFY(cli.waitForFinished());
+        QCOMPARE(cli.exitCode(), 1);
+
+        QFile trace(trace_file);
+        QVERIFY(trace.open(QIODevice::ReadOnly));
+        const QByteArray json = trace.readAll();
+        QVERIFY(json.contains("\"traceEvents\""));
+        QVERIFY(json.contains("parse CBOR config"));
+    }
+};
+
+QTEST_GUILESS_MAIN(CliTraceTest)
+
+#include "CliTraceTest.moc"
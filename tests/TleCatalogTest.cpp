@@ -0,0 +1,82 @@
+// TLE import against the bounds of the satellite schema: records a real
+// catalog holds but the schema does not allow are skipped and reported, and
+// what is imported survives a round trip through chunked columns.
+
+#include "DefaultParameters.h"
+#include "FleetColumns.h"
+#include "TleCatalog.h"
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtTest>
+
+namespace {
+
+// The ISS (perigee about 350 km), Vanguard 1 (NORAD ID 5) and a sun-synchronous
+// orbit inside every bound.
+const char kCatalog[] =
+    "ISS (ZARYA)\n"
+    "1 25544U 98067A   08264.51782528 -.00002182  00000-0 -11606-4 0  2927\n"
+    "2 25544  51.6416 247.4627 0006703 130.5360 325.0288 15.72125391563537\n"
+    "1 00005U 58002B   00179.78495062  .00000023  00000-0  28098-4 0  4753\n"
+    "2 00005  34.2682 348.7242 1859667 331.7664  19.3264 10.82419157413667\n"
+    "SSO 1\n"
+    "1 43013U 17073A   24001.50000000  .00000000  00000-0  00000-0 0  9991\n"
+    "2 43013  97.7000  10.0000 0250000  90.0000 270.0000 13.98000000 10004\n";
+
+}  // namespace
+
+class TleCatalogTest : public QObject {
+    Q_OBJECT
+
+    QTemporaryDir directory_;
+
+    QString catalogFile() {
+        const QString file_name = directory_.filePath("catalog.tle");
+        QFile file(file_name);
+        if (file.open(QIODevice::WriteOnly)) {
+            file.write(kCatalog);
+        }
+        return file_name;
+    }
+
+private slots:
+    void skipsValuesOutsideTheSchema() {
+        Fleet fleet(createDefaultParameters());
+        std::vector<TleError> errors;
+        QVERIFY(importTleCatalog(catalogFile(), fleet, &errors));
+
+        QCOMPARE(fleet.GetSatelliteCount(), 1);
+        const ParameterStore& schema = fleet.GetSchema();
+        QCOMPARE(fleet.GetValue(0, schema.Find("satelliteName")).toString(), QString("SSO 1"));
+        QCOMPARE(fleet.GetValue(0, schema.Find("noradId")).toInt(), 43013);
+
+        QCOMPARE(static_cast<int>(errors.size()), 2);
+        QCOMPARE(errors[0].line, qint64(2));
+        QVERIFY(errors[0].message.startsWith("ISS (ZARYA) skipped"));
+        QVERIFY(errors[0].message.contains("perigee"));
+        QCOMPARE(errors[1].line, qint64(4));
+        QVERIFY(errors[1].message.startsWith("NORAD 5 skipped"));
+        QVERIFY(errors[1].message.contains("noradId 5"));
+    }
+
+    void importedFleetRoundTripsThroughColumns() {
+        Fleet fleet(createDefaultParameters());
+        QVERIFY(importTleCatalog(catalogFile(), fleet));
+
+        const QString columns_file = directory_.filePath("catalog.columns");
+        QString message;
+        QVERIFY2(exportFleetColumns(fleet, columns_file, &message), qPrintable(message));
+        Fleet imported(createDefaultParameters());
+        QVERIFY2(importFleetColumns(columns_file, imported, &message), qPrintable(message));
+
+        QCOMPARE(imported.GetSatelliteCount(), fleet.GetSatelliteCount());
+        for (int column = 0; column < fleet.GetParameterCount(); ++column) {
+            QCOMPARE(imported.GetValue(0, column), fleet.GetValue(0, column));
+        }
+    }
+};
+
+QTEST_GUILESS_MAIN(TleCatalogTest)
+
+#include "TleCatalogTest.moc"